@@ -0,0 +1,497 @@
+/************************** BEGIN dsp-combiner-graph.h **************************/
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __dsp_combiner_graph__
+#define __dsp_combiner_graph__
+
+#include <string.h>
+#include <assert.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "faust/dsp/dsp.h"
+#include "faust/dsp/dsp-combiner.h"
+#include "faust/dsp/dsp-workers.h"
+
+/**
+ * Executes a tree of combiners (see dsp-combiner.h) as a graph of its leaf DSPs,
+ * so that independent branches are computed in parallel by a pool of worker threads.
+ *
+ * - the combiners tree is flattened once at creation time: each leaf DSP becomes a node
+ *   and each combiner only describes how nodes are connected (merger sums are done by
+ *   the reading node, in the same order as dsp_merger, so that results are bit-exact)
+ * - the intermediate buffers are taken from a pool and reused by nodes of later levels;
+ *   the nodes writing in a reused buffer wait for the nodes reading its previous content
+ * - dsp_recursiver and any other DSP are considered as leaves
+ *
+ * Worker threads are optional (none by default), and use real-time scheduling when possible.
+ * A semaphore holds one token for each node ready to be computed: the workers sleep on it,
+ * and the thread completing the last predecessor of a node posts its token. The audio thread
+ * runs the ready nodes while there are tokens left, then sleeps until the last node is done:
+ * compute does not allocate, lock, poll or spin.
+ */
+class dsp_graph_executor : public decorator_dsp {
+
+    private:
+
+        // A signal is an input of the graph, or an output of a node
+        struct graph_signal {
+            int fInput;                 // Graph input channel, or -1
+            int fNode;                  // Producing node, or -1
+            int fBuffer;                // Pool buffer, or -1
+            int fOutput;                // Graph output channel directly written by fNode, or -1
+            int fLastLevel;             // Last level where the signal is read
+            std::vector<int> fReaders;
+            graph_signal(int input, int node):fInput(input), fNode(node), fBuffer(-1), fOutput(-1), fLastLevel(-1) {}
+        };
+
+        // An input channel of a node is the sum of a list of signals (more than one after a dsp_merger)
+        typedef std::vector<int> signal_sum;
+
+        struct graph_node {
+            dsp* fDSP;
+            int fLevel;
+            std::vector<signal_sum> fInputs;
+            std::vector<int> fOutputs;
+            std::vector<FAUSTFLOAT*> fInputsPtr;
+            std::vector<FAUSTFLOAT*> fOutputsPtr;
+            std::vector<std::vector<FAUSTFLOAT*> > fMixPtr;  // Summed buffers for each input, or empty
+            std::set<int> fPredecessors;
+            std::vector<int> fSuccessors;
+            graph_node(dsp* dsp):fDSP(dsp), fLevel(0) {}
+        };
+
+        // Pointers to be set on the graph inputs/outputs at each compute
+        struct graph_slot {
+            FAUSTFLOAT** fPtr;
+            int fChan;
+            bool fOutput;
+        };
+
+        struct graph_buffer {
+            FAUSTFLOAT* fBuffer;
+            int fSignal;                // Current signal, or -1
+            int fMixNode;               // Or node which sums its inputs in the buffer
+            int fFreeLevel;             // Can be reused by a node of a greater level
+        };
+
+        int fThreads;
+        int fBufferSize;
+
+        std::vector<graph_signal> fSignals;
+        std::vector<graph_node> fNodes;
+        std::vector<int> fOrder;        // Nodes in topological order
+        std::vector<graph_buffer> fBuffers;
+        std::vector<graph_slot> fSlots;
+        std::vector<std::pair<int, int> > fCopies;  // (signal, graph output) not written by a node
+        FAUSTFLOAT* fZeros;
+        int fNumLevels;
+        std::vector<FAUSTFLOAT*> fInputsSlice;
+        std::vector<FAUSTFLOAT*> fOutputsSlice;
+
+        // Execution state
+        std::unique_ptr<std::atomic<int>[]> fPending;
+        std::unique_ptr<std::atomic<bool>[]> fClaimed;
+        std::vector<int> fRoots;        // Nodes without predecessors
+        std::atomic<int> fDone;
+        std::atomic<bool> fStop;
+        int fCount;
+        std::vector<std::thread> fWorkerThreads;
+        dsp_worker_semaphore fReady;    // One token by ready node
+        dsp_worker_semaphore fFinished; // Posted when the last node of the cycle is done
+
+        int addSignal(int input, int node)
+        {
+            fSignals.push_back(graph_signal(input, node));
+            return int(fSignals.size()) - 1;
+        }
+
+        // Flatten the combiners tree, returns the output signals of 'dsp'
+        void build(dsp* dsp, const std::vector<signal_sum>& inputs, std::vector<int>& outputs)
+        {
+            if (dsp_sequencer* seq = dynamic_cast<dsp_sequencer*>(dsp)) {
+                std::vector<int> outputs1;
+                build(seq->getDSP1(), inputs, outputs1);
+                std::vector<signal_sum> inputs2;
+                for (size_t chan = 0; chan < outputs1.size(); chan++) {
+                    inputs2.push_back(signal_sum(1, outputs1[chan]));
+                }
+                build(seq->getDSP2(), inputs2, outputs);
+            } else if (dsp_parallelizer* par = dynamic_cast<dsp_parallelizer*>(dsp)) {
+                int inputs1 = par->getDSP1()->getNumInputs();
+                std::vector<int> outputs2;
+                build(par->getDSP1(), std::vector<signal_sum>(inputs.begin(), inputs.begin() + inputs1), outputs);
+                build(par->getDSP2(), std::vector<signal_sum>(inputs.begin() + inputs1, inputs.end()), outputs2);
+                outputs.insert(outputs.end(), outputs2.begin(), outputs2.end());
+            } else if (dsp_splitter* split = dynamic_cast<dsp_splitter*>(dsp)) {
+                std::vector<int> outputs1;
+                build(split->getDSP1(), inputs, outputs1);
+                std::vector<signal_sum> inputs2;
+                for (int chan = 0; chan < split->getDSP2()->getNumInputs(); chan++) {
+                    inputs2.push_back(signal_sum(1, outputs1[chan % outputs1.size()]));
+                }
+                build(split->getDSP2(), inputs2, outputs);
+            } else if (dsp_merger* merge = dynamic_cast<dsp_merger*>(dsp)) {
+                // As in dsp_merger, the first DSP inputs are silent
+                std::vector<int> outputs1;
+                build(merge->getDSP1(), std::vector<signal_sum>(merge->getDSP1()->getNumInputs()), outputs1);
+                std::vector<signal_sum> inputs2(merge->getDSP2()->getNumInputs());
+                for (size_t chan = 0; chan < outputs1.size(); chan++) {
+                    inputs2[chan % inputs2.size()].push_back(outputs1[chan]);
+                }
+                build(merge->getDSP2(), inputs2, outputs);
+            } else {
+                // Leaf DSP: nodes are created in topological order
+                int node = int(fNodes.size());
+                fNodes.push_back(graph_node(dsp));
+                graph_node& cur_node = fNodes.back();
+                cur_node.fInputs = inputs;
+                for (int chan = 0; chan < dsp->getNumOutputs(); chan++) {
+                    cur_node.fOutputs.push_back(addSignal(-1, node));
+                }
+                outputs = cur_node.fOutputs;
+            }
+        }
+
+        void addEdge(int from, int to)
+        {
+            if (from != to && fNodes[to].fPredecessors.insert(from).second) {
+                fNodes[from].fSuccessors.push_back(to);
+            }
+        }
+
+        // Take a buffer free at 'node' level, the node has to wait for the previous users of the buffer
+        int allocateBuffer(int node, int signal, int last_level)
+        {
+            int level = fNodes[node].fLevel;
+            size_t buffer = 0;
+            while (buffer < fBuffers.size() && fBuffers[buffer].fFreeLevel >= level) buffer++;
+            if (buffer == fBuffers.size()) {
+                graph_buffer new_buffer;
+                new_buffer.fBuffer = new FAUSTFLOAT[fBufferSize];
+                memset(new_buffer.fBuffer, 0, sizeof(FAUSTFLOAT) * fBufferSize);
+                fBuffers.push_back(new_buffer);
+            } else if (fBuffers[buffer].fSignal >= 0) {
+                const graph_signal& previous = fSignals[fBuffers[buffer].fSignal];
+                addEdge(previous.fNode, node);
+                for (size_t reader = 0; reader < previous.fReaders.size(); reader++) {
+                    addEdge(previous.fReaders[reader], node);
+                }
+            } else {
+                addEdge(fBuffers[buffer].fMixNode, node);
+            }
+            fBuffers[buffer].fSignal = signal;
+            fBuffers[buffer].fMixNode = (signal < 0) ? node : -1;
+            fBuffers[buffer].fFreeLevel = last_level;
+            return int(buffer);
+        }
+
+        void schedule(const std::vector<int>& outputs)
+        {
+            // Levels and data dependencies
+            fNumLevels = 0;
+            for (size_t node = 0; node < fNodes.size(); node++) {
+                graph_node& cur_node = fNodes[node];
+                for (size_t chan = 0; chan < cur_node.fInputs.size(); chan++) {
+                    for (size_t term = 0; term < cur_node.fInputs[chan].size(); term++) {
+                        int producer = fSignals[cur_node.fInputs[chan][term]].fNode;
+                        if (producer >= 0) {
+                            cur_node.fLevel = std::max<int>(cur_node.fLevel, fNodes[producer].fLevel + 1);
+                            addEdge(producer, int(node));
+                        }
+                    }
+                }
+                for (size_t chan = 0; chan < cur_node.fInputs.size(); chan++) {
+                    for (size_t term = 0; term < cur_node.fInputs[chan].size(); term++) {
+                        graph_signal& signal = fSignals[cur_node.fInputs[chan][term]];
+                        signal.fReaders.push_back(int(node));
+                        signal.fLastLevel = std::max<int>(signal.fLastLevel, cur_node.fLevel);
+                    }
+                }
+                fNumLevels = std::max<int>(fNumLevels, cur_node.fLevel + 1);
+            }
+
+            // Graph outputs written by the nodes themselves
+            for (size_t chan = 0; chan < outputs.size(); chan++) {
+                graph_signal& signal = fSignals[outputs[chan]];
+                if (signal.fNode >= 0 && signal.fOutput < 0 && signal.fReaders.size() == 0) {
+                    signal.fOutput = int(chan);
+                } else {
+                    // Copied at the end of the cycle, so its buffer is never reused
+                    signal.fLastLevel = fNumLevels;
+                    fCopies.push_back(std::make_pair(outputs[chan], int(chan)));
+                }
+            }
+
+            // Nodes by level
+            for (size_t node = 0; node < fNodes.size(); node++) fOrder.push_back(int(node));
+            std::stable_sort(fOrder.begin(), fOrder.end(), [this](int a, int b) { return fNodes[a].fLevel < fNodes[b].fLevel; });
+
+            // Buffers
+            for (size_t i = 0; i < fOrder.size(); i++) {
+                int node = fOrder[i];
+                graph_node& cur_node = fNodes[node];
+                cur_node.fMixPtr.resize(cur_node.fInputs.size());
+                for (size_t chan = 0; chan < cur_node.fInputs.size(); chan++) {
+                    if (cur_node.fInputs[chan].size() > 1) {
+                        int buffer = allocateBuffer(node, -1, cur_node.fLevel);
+                        cur_node.fInputsPtr.push_back(fBuffers[buffer].fBuffer);
+                    } else {
+                        cur_node.fInputsPtr.push_back(fZeros);
+                    }
+                }
+                for (size_t chan = 0; chan < cur_node.fOutputs.size(); chan++) {
+                    graph_signal& signal = fSignals[cur_node.fOutputs[chan]];
+                    if (signal.fOutput < 0) {
+                        signal.fBuffer = allocateBuffer(node, cur_node.fOutputs[chan], std::max<int>(signal.fLastLevel, cur_node.fLevel));
+                        cur_node.fOutputsPtr.push_back(fBuffers[signal.fBuffer].fBuffer);
+                    } else {
+                        cur_node.fOutputsPtr.push_back(nullptr);
+                    }
+                }
+            }
+
+            // Inputs pointers, once all signals have a buffer
+            for (size_t node = 0; node < fNodes.size(); node++) {
+                graph_node& cur_node = fNodes[node];
+                for (size_t chan = 0; chan < cur_node.fInputs.size(); chan++) {
+                    const signal_sum& sum = cur_node.fInputs[chan];
+                    if (sum.size() == 1) {
+                        addSignalSlot(&cur_node.fInputsPtr[chan], sum[0]);
+                    } else if (sum.size() > 1) {
+                        cur_node.fMixPtr[chan].resize(sum.size());
+                        for (size_t term = 0; term < sum.size(); term++) {
+                            addSignalSlot(&cur_node.fMixPtr[chan][term], sum[term]);
+                        }
+                    }
+                }
+                for (size_t chan = 0; chan < cur_node.fOutputs.size(); chan++) {
+                    int output = fSignals[cur_node.fOutputs[chan]].fOutput;
+                    if (output >= 0) fSlots.push_back({ &cur_node.fOutputsPtr[chan], output, true });
+                }
+            }
+        }
+
+        void addSignalSlot(FAUSTFLOAT** ptr, int signal)
+        {
+            const graph_signal& cur_signal = fSignals[signal];
+            if (cur_signal.fInput >= 0) {
+                fSlots.push_back({ ptr, cur_signal.fInput, false });
+            } else {
+                // Signals read by a node are always in a buffer
+                assert(cur_signal.fBuffer >= 0);
+                *ptr = fBuffers[cur_signal.fBuffer].fBuffer;
+            }
+        }
+
+        FAUSTFLOAT* getSignal(int signal, FAUSTFLOAT** inputs)
+        {
+            const graph_signal& cur_signal = fSignals[signal];
+            if (cur_signal.fInput >= 0) {
+                return inputs[cur_signal.fInput];
+            } else if (cur_signal.fBuffer >= 0) {
+                return fBuffers[cur_signal.fBuffer].fBuffer;
+            } else {
+                return fZeros;
+            }
+        }
+
+        void runNode(int node)
+        {
+            graph_node& cur_node = fNodes[node];
+            // Sum inputs in the dsp_merger order
+            for (size_t chan = 0; chan < cur_node.fMixPtr.size(); chan++) {
+                const std::vector<FAUSTFLOAT*>& terms = cur_node.fMixPtr[chan];
+                if (terms.size() > 0) {
+                    FAUSTFLOAT* mix = cur_node.fInputsPtr[chan];
+                    memcpy(mix, terms[0], sizeof(FAUSTFLOAT) * fCount);
+                    for (size_t term = 1; term < terms.size(); term++) {
+                        for (int frame = 0; frame < fCount; frame++) {
+                            mix[frame] += terms[term][frame];
+                        }
+                    }
+                }
+            }
+            cur_node.fDSP->compute(fCount, cur_node.fInputsPtr.data(), cur_node.fOutputsPtr.data());
+        }
+
+        // Take a ready node, to be called with a token of fReady: there is at least one
+        int claimNode()
+        {
+            while (true) {
+                // Another thread can claim the node we are looking at, but then a new node is ready before it
+                for (size_t i = 0; i < fOrder.size(); i++) {
+                    int node = fOrder[i];
+                    if (fPending[node].load(std::memory_order_acquire) == 0
+                        && !fClaimed[node].load(std::memory_order_relaxed)
+                        && !fClaimed[node].exchange(true, std::memory_order_acq_rel)) {
+                        return node;
+                    }
+                }
+            }
+        }
+
+        void runReadyNode()
+        {
+            int node = claimNode();
+            runNode(node);
+            const std::vector<int>& successors = fNodes[node].fSuccessors;
+            for (size_t i = 0; i < successors.size(); i++) {
+                if (fPending[successors[i]].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    fReady.post();
+                }
+            }
+            if (fDone.fetch_add(1, std::memory_order_acq_rel) + 1 == int(fOrder.size())) {
+                fFinished.post();
+            }
+        }
+
+        void runWorker()
+        {
+            while (true) {
+                fReady.wait();
+                if (fStop.load(std::memory_order_acquire)) return;
+                runReadyNode();
+            }
+        }
+
+        void computeSlice(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fCount = count;
+            for (size_t i = 0; i < fSlots.size(); i++) {
+                *fSlots[i].fPtr = (fSlots[i].fOutput) ? outputs[fSlots[i].fChan] : inputs[fSlots[i].fChan];
+            }
+
+            if (fWorkerThreads.size() == 0) {
+                for (size_t i = 0; i < fOrder.size(); i++) {
+                    runNode(fOrder[i]);
+                }
+            } else {
+                for (size_t node = 0; node < fNodes.size(); node++) {
+                    fPending[node].store(int(fNodes[node].fPredecessors.size()), std::memory_order_relaxed);
+                    fClaimed[node].store(false, std::memory_order_relaxed);
+                }
+                fDone.store(0, std::memory_order_relaxed);
+                // Publish the new cycle with the tokens of the roots, then help the workers
+                for (size_t i = 0; i < fRoots.size(); i++) {
+                    fReady.post();
+                }
+                while (fReady.try_wait()) {
+                    runReadyNode();
+                }
+                fFinished.wait();
+            }
+
+            for (size_t i = 0; i < fCopies.size(); i++) {
+                memcpy(outputs[fCopies[i].second], getSignal(fCopies[i].first, inputs), sizeof(FAUSTFLOAT) * count);
+            }
+        }
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param dsp - the combiners tree (or any DSP). Beware: dsp_graph_executor will use and finally delete the pointer.
+         * @param threads - the number of worker threads (in addition to the audio thread), 0 (the default) to compute the graph sequentially
+         * @param buffer_size - the size of the intermediate buffers, larger blocks are computed in several slices
+         */
+        dsp_graph_executor(dsp* dsp, int threads = 0, int buffer_size = 4096)
+        :decorator_dsp(dsp), fThreads(threads), fBufferSize(buffer_size), fNumLevels(0),
+        fDone(0), fStop(false), fCount(0)
+        {
+            fZeros = new FAUSTFLOAT[fBufferSize];
+            memset(fZeros, 0, sizeof(FAUSTFLOAT) * fBufferSize);
+
+            std::vector<signal_sum> inputs;
+            for (int chan = 0; chan < fDSP->getNumInputs(); chan++) {
+                inputs.push_back(signal_sum(1, addSignal(chan, -1)));
+            }
+            std::vector<int> outputs;
+            build(fDSP, inputs, outputs);
+            schedule(outputs);
+            fInputsSlice.resize(fDSP->getNumInputs());
+            fOutputsSlice.resize(fDSP->getNumOutputs());
+
+            fPending.reset(new std::atomic<int>[fNodes.size()]);
+            fClaimed.reset(new std::atomic<bool>[fNodes.size()]);
+            for (size_t node = 0; node < fNodes.size(); node++) {
+                if (fNodes[node].fPredecessors.size() == 0) fRoots.push_back(int(node));
+            }
+            // A single node does not need workers
+            for (int i = 0; fNodes.size() > 1 && i < fThreads; i++) {
+                fWorkerThreads.push_back(std::thread(&dsp_graph_executor::runWorker, this));
+                setWorkerRealtimePriority(fWorkerThreads.back());
+            }
+        }
+
+        virtual ~dsp_graph_executor()
+        {
+            fStop.store(true, std::memory_order_release);
+            for (size_t i = 0; i < fWorkerThreads.size(); i++) {
+                fReady.post();
+            }
+            for (size_t i = 0; i < fWorkerThreads.size(); i++) {
+                fWorkerThreads[i].join();
+            }
+            for (size_t buffer = 0; buffer < fBuffers.size(); buffer++) {
+                delete [] fBuffers[buffer].fBuffer;
+            }
+            delete [] fZeros;
+        }
+
+        virtual dsp_graph_executor* clone()
+        {
+            return new dsp_graph_executor(fDSP->clone(), fThreads, fBufferSize);
+        }
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            if (count <= fBufferSize) {
+                computeSlice(count, inputs, outputs);
+                return;
+            }
+            for (int offset = 0; offset < count; offset += fBufferSize) {
+                for (size_t chan = 0; chan < fInputsSlice.size(); chan++) fInputsSlice[chan] = inputs[chan] + offset;
+                for (size_t chan = 0; chan < fOutputsSlice.size(); chan++) fOutputsSlice[chan] = outputs[chan] + offset;
+                computeSlice(std::min<int>(fBufferSize, count - offset), fInputsSlice.data(), fOutputsSlice.data());
+            }
+        }
+
+        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) { compute(count, inputs, outputs); }
+
+        // Graph statistics
+        int getNumNodes() { return int(fNodes.size()); }
+        int getNumLevels() { return fNumLevels; }
+        int getNumBuffers() { return int(fBuffers.size()); }
+        int getNumThreads() { return int(fWorkerThreads.size()); }
+
+};
+
+#endif
+/**************************  END  dsp-combiner-graph.h **************************/
@@ -29,6 +29,7 @@
 #include <string>
 #include <assert.h>
 #include <sstream>
+#include <algorithm>
 
 #include "faust/dsp/dsp.h"
 #include "faust/gui/UI.h"
@@ -142,6 +143,10 @@ class dsp_binary_combiner : public dsp {
             fDSP1->metadata(m);
             fDSP2->metadata(m);
         }
+    
+        // To walk the combiners tree (see dsp-combiner-graph.h)
+        dsp* getDSP1() { return fDSP1; }
+        dsp* getDSP2() { return fDSP2; }
 
 };
 
@@ -374,13 +379,23 @@ class dsp_merger : public dsp_binary_combiner {
 
 // Combine two 'compatible' DSP in a recursive way
 
+/*
+ The fDSP2 outputs are fed back to the fDSP1 inputs with a one sample delay, plus 'latency' samples.
+ Since the fDSP1 inputs of a given sample only depend on the fDSP2 outputs computed 'latency + 1' samples before,
+ both DSP are computed by sub-blocks of 'latency + 1' samples, with the exact same result as a sample by sample computation.
+ So a feedback DSP with a known latency (like 'A ~ (@(L) : B)' in Faust) is better written with its
+ delay-free part as fDSP2 and L as 'latency', to avoid the per-sample compute calls.
+ */
+
 class dsp_recursiver : public dsp_binary_combiner {
 
     private:
 
+        int fLatency;
+        int fFeedbackPos;           // Read/write position in fFeedback
+        FAUSTFLOAT** fFeedback;     // Ring buffers of 'latency + 1' fDSP2 outputs
         FAUSTFLOAT** fDSP1Inputs;
         FAUSTFLOAT** fDSP1Outputs;
-
         FAUSTFLOAT** fDSP2Inputs;
         FAUSTFLOAT** fDSP2Outputs;
 
@@ -388,20 +403,30 @@ class dsp_recursiver : public dsp_binary_combiner {
 
         dsp_recursiver(dsp* dsp1, dsp* dsp2,
                        Layout layout = Layout::kTabGroup,
-                       const std::string& label = "Recursiver")
-        :dsp_binary_combiner(dsp1, dsp2, 1, layout, label)
+                       const std::string& label = "Recursiver",
+                       int latency = 0)
+        :dsp_binary_combiner(dsp1, dsp2, latency + 1, layout, label), fLatency(latency), fFeedbackPos(0)
         {
-            fDSP1Inputs = allocateChannels(fDSP1->getNumInputs());
-            fDSP1Outputs = allocateChannels(fDSP1->getNumOutputs());
-            fDSP2Inputs = allocateChannels(fDSP2->getNumInputs());
+            fFeedback = allocateChannels(fDSP2->getNumOutputs());
+            fDSP1Inputs = new FAUSTFLOAT*[fDSP1->getNumInputs()];
+            fDSP1Outputs = new FAUSTFLOAT*[fDSP1->getNumOutputs()];
+            fDSP2Inputs = new FAUSTFLOAT*[fDSP2->getNumInputs()];
             fDSP2Outputs = allocateChannels(fDSP2->getNumOutputs());
+            // Feedback inputs of fDSP1
+            for (int chan = 0; chan < fDSP2->getNumOutputs(); chan++) {
+                fDSP1Inputs[chan] = new FAUSTFLOAT[fBufferSize];
+            }
         }
 
         virtual ~dsp_recursiver()
         {
-            deleteChannels(fDSP1Inputs, fDSP1->getNumInputs());
-            deleteChannels(fDSP1Outputs, fDSP1->getNumOutputs());
-            deleteChannels(fDSP2Inputs, fDSP2->getNumInputs());
+            for (int chan = 0; chan < fDSP2->getNumOutputs(); chan++) {
+                delete [] fDSP1Inputs[chan];
+            }
+            deleteChannels(fFeedback, fDSP2->getNumOutputs());
+            delete [] fDSP1Inputs;
+            delete [] fDSP1Outputs;
+            delete [] fDSP2Inputs;
             deleteChannels(fDSP2Outputs, fDSP2->getNumOutputs());
         }
 
@@ -415,32 +440,68 @@ class dsp_recursiver : public dsp_binary_combiner {
 
         virtual dsp* clone()
         {
-            return new dsp_recursiver(fDSP1->clone(), fDSP2->clone(), fLayout, fLabel);
+            return new dsp_recursiver(fDSP1->clone(), fDSP2->clone(), fLayout, fLabel, fLatency);
+        }
+
+        virtual void instanceClear()
+        {
+            dsp_binary_combiner::instanceClear();
+            for (int chan = 0; chan < fDSP2->getNumOutputs(); chan++) {
+                memset(fFeedback[chan], 0, sizeof(FAUSTFLOAT) * fBufferSize);
+            }
+            fFeedbackPos = 0;
+        }
+
+        virtual void init(int sample_rate)
+        {
+            dsp_binary_combiner::init(sample_rate);
+            instanceClear();
+        }
+
+        virtual void instanceInit(int sample_rate)
+        {
+            dsp_binary_combiner::instanceInit(sample_rate);
+            instanceClear();
         }
 
+        int getLatency() { return fLatency; }
+
         virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
         {
-            for (int frame = 0; (frame < count); frame++) {
+            for (int frame = 0; frame < count; frame += fBufferSize) {
+
+                int block = std::min<int>(fBufferSize, count - frame);
 
+                // Feedback part of fDSP1 inputs, from the ring buffers
                 for (int chan = 0; chan < fDSP2->getNumOutputs(); chan++) {
-                    fDSP1Inputs[chan][0] = fDSP2Outputs[chan][0];
+                    for (int i = 0, pos = fFeedbackPos; i < block; i++, pos = (pos + 1 == fBufferSize) ? 0 : pos + 1) {
+                        fDSP1Inputs[chan][i] = fFeedback[chan][pos];
+                    }
                 }
 
                 for (int chan = 0; chan < fDSP1->getNumInputs() - fDSP2->getNumOutputs(); chan++) {
-                    fDSP1Inputs[chan + fDSP2->getNumOutputs()][0] = inputs[chan][frame];
+                    fDSP1Inputs[chan + fDSP2->getNumOutputs()] = inputs[chan] + frame;
                 }
 
-                fDSP1->compute(1, fDSP1Inputs, fDSP1Outputs);
-
                 for (int chan = 0; chan < fDSP1->getNumOutputs(); chan++) {
-                    outputs[chan][frame] = fDSP1Outputs[chan][0];
+                    fDSP1Outputs[chan] = outputs[chan] + frame;
                 }
 
+                fDSP1->compute(block, fDSP1Inputs, fDSP1Outputs);
+
                 for (int chan = 0; chan < fDSP2->getNumInputs(); chan++) {
-                    fDSP2Inputs[chan][0] = fDSP1Outputs[chan][0];
+                    fDSP2Inputs[chan] = fDSP1Outputs[chan];
                 }
 
-                fDSP2->compute(1, fDSP2Inputs, fDSP2Outputs);
+                fDSP2->compute(block, fDSP2Inputs, fDSP2Outputs);
+
+                // The read part of the ring buffers is replaced by the new fDSP2 outputs
+                for (int chan = 0; chan < fDSP2->getNumOutputs(); chan++) {
+                    for (int i = 0, pos = fFeedbackPos; i < block; i++, pos = (pos + 1 == fBufferSize) ? 0 : pos + 1) {
+                        fFeedback[chan][pos] = fDSP2Outputs[chan][i];
+                    }
+                }
+                fFeedbackPos = (fFeedbackPos + block) % fBufferSize;
             }
         }
 
@@ -530,12 +591,17 @@ static dsp* createDSPMerger(dsp* dsp1, dsp* dsp2,
     }
 }
 
+// 'latency' is the number of samples the feedback is delayed, in addition to the one sample delay (see dsp_recursiver)
 static dsp* createDSPRecursiver(dsp* dsp1, dsp* dsp2,
                                 std::string& error,
                                 Layout layout = Layout::kTabGroup,
-                                const std::string& label = "Recursiver")
+                                const std::string& label = "Recursiver",
+                                int latency = 0)
 {
-    if ((dsp2->getNumInputs() > dsp1->getNumOutputs()) || (dsp2->getNumOutputs() > dsp1->getNumInputs())) {
+    if (latency < 0) {
+        error = "Connection error in dsp_recursiver : the latency should be positive or null\n";
+        return nullptr;
+    } else if ((dsp2->getNumInputs() > dsp1->getNumOutputs()) || (dsp2->getNumOutputs() > dsp1->getNumInputs())) {
         std::stringstream error_aux;
         error_aux << "Connection error in : dsp_recursiver" << std::endl;
         if (dsp2->getNumInputs() > dsp1->getNumOutputs()) {
@@ -553,7 +619,7 @@ static dsp* createDSPRecursiver(dsp* dsp1, dsp* dsp2,
         error = error_aux.str();
         return nullptr;
     } else {
-        return new dsp_recursiver(dsp1, dsp2, layout, label);
+        return new dsp_recursiver(dsp1, dsp2, layout, label, latency);
     }
 }
 #endif
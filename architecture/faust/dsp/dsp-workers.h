@@ -0,0 +1,109 @@
+/************************** BEGIN dsp-workers.h **************************/
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __dsp_workers__
+#define __dsp_workers__
+
+#include <thread>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#include <pthread.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#endif
+
+/**
+ * Tools for the helper threads of the audio thread (see poly-dsp.h and dsp-combiner-graph.h).
+ */
+
+/**
+ * Unnamed counting semaphore: the audio thread wakes up a parked worker with 'post',
+ * which does not take any lock and does not allocate ('try_wait' does not block).
+ */
+class dsp_worker_semaphore {
+
+    private:
+
+    #if defined(__APPLE__)
+        semaphore_t fSemaphore;
+    #elif defined(_WIN32)
+        HANDLE fSemaphore;
+    #else
+        sem_t fSemaphore;
+    #endif
+
+        dsp_worker_semaphore(const dsp_worker_semaphore&) = delete;
+        dsp_worker_semaphore& operator=(const dsp_worker_semaphore&) = delete;
+
+    public:
+
+    #if defined(__APPLE__)
+        dsp_worker_semaphore() { semaphore_create(mach_task_self(), &fSemaphore, SYNC_POLICY_FIFO, 0); }
+        ~dsp_worker_semaphore() { semaphore_destroy(mach_task_self(), fSemaphore); }
+        void post() { semaphore_signal(fSemaphore); }
+        void wait() { while (semaphore_wait(fSemaphore) != KERN_SUCCESS) {} }
+        bool try_wait() { mach_timespec_t zero = { 0, 0 }; return semaphore_timedwait(fSemaphore, zero) == KERN_SUCCESS; }
+    #elif defined(_WIN32)
+        dsp_worker_semaphore() { fSemaphore = CreateSemaphore(NULL, 0, LONG_MAX, NULL); }
+        ~dsp_worker_semaphore() { CloseHandle(fSemaphore); }
+        void post() { ReleaseSemaphore(fSemaphore, 1, NULL); }
+        void wait() { WaitForSingleObject(fSemaphore, INFINITE); }
+        bool try_wait() { return WaitForSingleObject(fSemaphore, 0) == WAIT_OBJECT_0; }
+    #else
+        dsp_worker_semaphore() { sem_init(&fSemaphore, 0, 0); }
+        ~dsp_worker_semaphore() { sem_destroy(&fSemaphore); }
+        void post() { sem_post(&fSemaphore); }
+        void wait() { while (sem_wait(&fSemaphore) != 0 && errno == EINTR) {} }
+        bool try_wait() { return sem_trywait(&fSemaphore) == 0; }
+    #endif
+
+};
+
+/**
+ * Gives a worker thread the real-time scheduling of an audio thread (SCHED_FIFO).
+ * Without the rights to do so, the thread keeps its normal priority.
+ *
+ * @param thread - the worker thread
+ * @param priority - the SCHED_FIFO priority
+ *
+ * @return true if the priority has been set.
+ */
+inline bool setWorkerRealtimePriority(std::thread& thread, int priority = 70)
+{
+#if defined(_WIN32)
+    return SetThreadPriority(thread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+    struct sched_param param;
+    param.sched_priority = priority;
+    return pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param) == 0;
+#endif
+}
+
+#endif
+/**************************  END  dsp-workers.h **************************/
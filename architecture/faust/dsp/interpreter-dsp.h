@@ -126,6 +126,27 @@ class interpreter_dsp_factory : public dsp_factory {
         
         /* Return the currently set custom memory manager */
         dsp_memory_manager* getMemoryManager();
+    
+        /* Specialize the instances on the current values of the controls declared with [specialize:1] metadata
+         * (and on the sample rate), the controls being checked every 'period' ms by a thread shared by all instances,
+         * 0 (default) deactivates the specialization. To be called before creating any instance. */
+        void setSpecialization(int period);
+
+        /*
+         * Tiered execution (interpreter-machine library with a FBC compiler): the 'compute' method is interpreted 
+         * until compiled by a background thread, then each instance switches to the compiled code.
+         */
+    
+        /* Enable (default) or disable the tiered execution: when disabled, the 'compute' method
+         * is compiled when the first instance is created. To be called before creating any instance. */
+        void setTieredExecution(bool tiered);
+    
+        /* Return the number of 'compute' calls interpreted while the compiled code was not ready
+         * (counted by each instance, and added when it switches to the compiled code or is deleted) */
+        int getInterpretedComputeCount();
+    
+        /* Return the number of instances switched to the compiled code */
+        int getCompiledSwapCount();
 
 };
 
@@ -212,6 +233,8 @@ std::vector<std::string> getAllInterpreterDSPFactories();
 
 /**
  * Start multi-thread access mode (since by default the library is not 'multi-thread' safe).
+ * In this mode, factories can be created concurrently from several threads: each compilation
+ * uses its own state, only the parsing step and the factory cache accesses are serialized.
  *
  * @return true if 'multi-thread' safe access is started.
  */
@@ -127,6 +127,22 @@ class interpreter_dsp_factory : public dsp_factory {
         /* Return the currently set custom memory manager */
         dsp_memory_manager* getMemoryManager();
 
+        /*
+         * Tiered execution (interpreter-machine library with a FBC compiler): the 'compute' method is interpreted 
+         * until compiled by a background thread, then each instance switches to the compiled code.
+         */
+    
+        /* Enable (default) or disable the tiered execution: when disabled, the 'compute' method
+         * is compiled when the first instance is created. To be called before creating any instance. */
+        void setTieredExecution(bool tiered);
+    
+        /* Return the number of 'compute' calls interpreted while the compiled code was not ready
+         * (counted by each instance, and added when it switches to the compiled code or is deleted) */
+        int getInterpretedComputeCount();
+    
+        /* Return the number of instances switched to the compiled code */
+        int getCompiledSwapCount();
+
 };
 
 /**
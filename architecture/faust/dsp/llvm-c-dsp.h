@@ -98,6 +98,16 @@ extern "C"
                                                 char* error_msg,
                                                 int opt_level);
     
+    /**
+     * Set the directory of the on-disk machine code cache. When set, the machine code of the factories compiled 
+     * with createCDSPFactoryFromFile/createCDSPFactoryFromString is stored in this directory (keyed by the expanded DSP code, 
+     * which contains the used libraries and the compilation options, the target and optimization level), and mapped back 
+     * instead of being recompiled by the next processes.
+     *
+     * @param cache_dir - the cache directory (created if needed), an empty string or NULL deactivates the cache
+     */
+    void setCDSPFactoryCacheDirectory(const char* cache_dir);
+    
     /**
      * Create a Faust DSP factory from a DSP source code as a string. Note that the library keeps an internal cache of all 
      * allocated factories so that the compilation of the same DSP code (that is same source code and 
@@ -174,6 +174,23 @@ llvm_dsp_factory* createDSPFactoryFromFile(const std::string& filename,
                                            std::string& error_msg,
                                            int opt_level = -1);
 
+/**
+ * Set the directory of the on-disk machine code cache. When set, the machine code of the factories compiled 
+ * with createDSPFactoryFromFile/createDSPFactoryFromString is stored in this directory (keyed by the expanded DSP code, 
+ * which contains the used libraries and the compilation options, the target and optimization level), and mapped back 
+ * instead of being recompiled by the next processes.
+ *
+ * @param cache_dir - the cache directory (created if needed), an empty string deactivates the cache
+ */
+void setDSPFactoryCacheDirectory(const std::string& cache_dir);
+
+/**
+ * Get the directory of the on-disk machine code cache.
+ *
+ * @return the cache directory, or an empty string if the cache is not used.
+ */
+std::string getDSPFactoryCacheDirectory();
+
 /**
  * Create a Faust DSP factory from a DSP source code as a string. Note that the library keeps an internal cache of all 
  * allocated factories so that the compilation of the same DSP code (that is same source code and 
@@ -237,6 +254,8 @@ std::vector<std::string> getAllDSPFactories();
 
 /**
  * Start multi-thread access mode (since by default the library is not 'multi-thread' safe).
+ * In this mode, factories can be created concurrently from several threads: each compilation
+ * uses its own state, only the parsing step and the factory cache accesses are serialized.
  * 
  * @return true if 'multi-thread' safe access is started.
  */ 
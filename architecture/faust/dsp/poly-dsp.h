@@ -26,6 +26,7 @@
 #define __poly_dsp__
 
 #include <stdio.h>
+#include <string.h>
 #include <string>
 #include <cmath>
 #include <algorithm>
@@ -36,10 +37,19 @@
 #include <limits.h>
 #include <float.h>
 #include <assert.h>
+#include <atomic>
+#ifdef POLY_THREADS
+#include <memory>
+#include <thread>
+#endif
 
 #include "faust/midi/midi.h"
 #include "faust/dsp/dsp-combiner.h"
 #include "faust/dsp/proxy-dsp.h"
+#include "faust/dsp/poly-mix.h"
+#ifdef POLY_THREADS
+#include "faust/dsp/dsp-workers.h"
+#endif
 
 #include "faust/gui/DecoratorUI.h"
 #include "faust/gui/GUI.h"
@@ -451,6 +461,183 @@ class dsp_poly : public decorator_dsp, public midi, public JSONControl {
     
 };
 
+/**
+ * Voice allocation structures, so that allocating, stealing or finding a voice does not scan the voices table:
+ * - the set of free voices (a bitset, to keep on choosing the free voice with the lowest index)
+ * - the playing and release voices, in lists ordered by date
+ * - the playing voices of each MIDI pitch, in lists ordered by date
+ *
+ * Voices are allocated with increasing dates, so insertion in the lists is usually done at the tail.
+ * The voices freed by the audio thread are given back with a lock-free queue, and moved
+ * in the free set by the next event, so that only the events thread modifies the structures.
+ */
+struct dsp_voice_index {
+
+    struct voice_list {
+        int fHead = kNoVoice;
+        int fTail = kNoVoice;
+    };
+
+    struct voice_links {
+        int fState = kFreeVoice;    // kFreeVoice, kActiveVoice or kReleaseVoice
+        int fPrev = kNoVoice;       // In the playing or release list
+        int fNext = kNoVoice;
+        int fPitch = kNoVoice;      // Indexed pitch of a playing voice
+        int fPitchPrev = kNoVoice;
+        int fPitchNext = kNoVoice;
+    };
+
+    std::vector<dsp_voice*>& fVoiceTable;
+    std::vector<voice_links> fLinks;
+    std::vector<uint64_t> fFreeSet;
+    voice_list fPlaying;
+    voice_list fRelease;
+    voice_list fPitchTable[128];
+
+    // Voices freed by the audio thread: a voice can be freed again before its first entry is read
+    std::vector<int> fFreedVoices;
+    std::atomic<int> fFreedRead;
+    std::atomic<int> fFreedWrite;
+
+    dsp_voice_index(std::vector<dsp_voice*>& voices):fVoiceTable(voices), fFreedRead(0), fFreedWrite(0)
+    {}
+
+    // To be called when all voices have been added
+    void init()
+    {
+        fLinks.assign(fVoiceTable.size(), voice_links());
+        fFreeSet.assign((fVoiceTable.size() + 63) / 64, 0);
+        fFreedVoices.assign(2 * fVoiceTable.size() + 1, kNoVoice);
+        for (size_t voice = 0; voice < fVoiceTable.size(); voice++) {
+            fLinks[voice].fState = kNoVoice;
+            update(int(voice));
+        }
+    }
+
+    static int getState(int note)
+    {
+        return (note == kFreeVoice || note == kReleaseVoice) ? note : kActiveVoice;
+    }
+
+    // Insert by date, starting from the tail
+    template <int voice_links::*PREV, int voice_links::*NEXT>
+    void insert(voice_list& list, int voice)
+    {
+        int date = fVoiceTable[voice]->fDate;
+        int next = kNoVoice;
+        int prev = list.fTail;
+        while (prev != kNoVoice && fVoiceTable[prev]->fDate > date) {
+            next = prev;
+            prev = fLinks[prev].*PREV;
+        }
+        fLinks[voice].*PREV = prev;
+        fLinks[voice].*NEXT = next;
+        if (prev == kNoVoice) list.fHead = voice; else fLinks[prev].*NEXT = voice;
+        if (next == kNoVoice) list.fTail = voice; else fLinks[next].*PREV = voice;
+    }
+
+    template <int voice_links::*PREV, int voice_links::*NEXT>
+    void remove(voice_list& list, int voice)
+    {
+        int prev = fLinks[voice].*PREV;
+        int next = fLinks[voice].*NEXT;
+        if (prev == kNoVoice) list.fHead = next; else fLinks[prev].*NEXT = next;
+        if (next == kNoVoice) list.fTail = prev; else fLinks[next].*PREV = prev;
+        fLinks[voice].*PREV = fLinks[voice].*NEXT = kNoVoice;
+    }
+
+    void setFree(int voice, bool free)
+    {
+        uint64_t mask = uint64_t(1) << (voice % 64);
+        if (free) fFreeSet[voice / 64] |= mask; else fFreeSet[voice / 64] &= ~mask;
+    }
+
+    static int lowestBit(uint64_t word)
+    {
+    #if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(word);
+    #else
+        int bit = 0;
+        while (!(word & 1)) { word >>= 1; bit++; }
+        return bit;
+    #endif
+    }
+
+    // Move the voice in the structures corresponding to its current note and date
+    void update(int voice)
+    {
+        voice_links& links = fLinks[voice];
+        // Remove from the previous structures
+        if (links.fState == kFreeVoice) {
+            setFree(voice, false);
+        } else if (links.fState == kActiveVoice) {
+            remove<&voice_links::fPrev, &voice_links::fNext>(fPlaying, voice);
+        } else if (links.fState == kReleaseVoice) {
+            remove<&voice_links::fPrev, &voice_links::fNext>(fRelease, voice);
+        }
+        if (links.fPitch != kNoVoice) {
+            remove<&voice_links::fPitchPrev, &voice_links::fPitchNext>(fPitchTable[links.fPitch], voice);
+            links.fPitch = kNoVoice;
+        }
+        // Insert in the new ones
+        int note = fVoiceTable[voice]->fNote;
+        links.fState = getState(note);
+        if (links.fState == kFreeVoice) {
+            setFree(voice, true);
+        } else if (links.fState == kActiveVoice) {
+            insert<&voice_links::fPrev, &voice_links::fNext>(fPlaying, voice);
+            if (note >= 0 && note < 128) {
+                links.fPitch = note;
+                insert<&voice_links::fPitchPrev, &voice_links::fPitchNext>(fPitchTable[note], voice);
+            }
+        } else {
+            insert<&voice_links::fPrev, &voice_links::fNext>(fRelease, voice);
+        }
+    }
+
+    // Called by the audio thread
+    void pushFreed(int voice)
+    {
+        int write = fFreedWrite.load(std::memory_order_relaxed);
+        fFreedVoices[write] = voice;
+        fFreedWrite.store((write + 1) % int(fFreedVoices.size()), std::memory_order_release);
+    }
+
+    // Called by the events thread before using the structures
+    void popFreed()
+    {
+        int read = fFreedRead.load(std::memory_order_relaxed);
+        while (read != fFreedWrite.load(std::memory_order_acquire)) {
+            update(fFreedVoices[read]);
+            read = (read + 1) % int(fFreedVoices.size());
+        }
+        fFreedRead.store(read, std::memory_order_release);
+    }
+
+    int getFirstFree()
+    {
+        for (size_t word = 0; word < fFreeSet.size(); word++) {
+            if (fFreeSet[word]) return int(word * 64) + lowestBit(fFreeSet[word]);
+        }
+        return kNoVoice;
+    }
+
+    int getOldestRelease() { return fRelease.fHead; }
+
+    int getOldestPlaying() { return fPlaying.fHead; }
+
+    int getOldestPlaying(int pitch)
+    {
+        if (pitch >= 0 && pitch < 128) return fPitchTable[pitch].fHead;
+        // Not indexed pitch
+        for (int voice = fPlaying.fHead; voice != kNoVoice; voice = fLinks[voice].fNext) {
+            if (fVoiceTable[voice]->fNote == pitch) return voice;
+        }
+        return kNoVoice;
+    }
+
+};
+
 /**
  * Polyphonic DSP: groups a set of DSP to be played together or triggered by MIDI.
  *
@@ -465,17 +652,38 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
         FAUSTFLOAT** fOutBuffer;
         midi_interface* fMidiHandler; // The midi_interface the DSP is connected to
         int fDate;
+        dsp_voice_index fVoiceIndex;
+    
+    #ifdef POLY_THREADS
+        /*
+         Optional voice threads (see setVoiceThreads), compiled when POLY_THREADS is defined: the audio thread and the helper threads each render
+         a fixed subset of the playing voices in their own buffers, which are then summed in a fixed order.
+         Voice release is decided on the audio thread after all voices have been rendered, so that the
+         result only depends on the received events, and not on threads scheduling.
+         The audio thread never takes a lock: it posts the start semaphore of each helper thread
+         (real-time threads when possible), and waits for their done semaphore.
+         */
+        struct voice_worker {
+            FAUSTFLOAT** fMixBuffer;
+            FAUSTFLOAT** fOutBuffer;
+            std::unique_ptr<dsp_worker_semaphore> fStart;
+        };
+    
+        std::vector<voice_worker> fWorkers;     // Worker 0 is the audio thread
+        std::vector<std::thread> fWorkerThreads;
+        std::vector<int> fPlayingVoices;        // Voices rendered in the current cycle
+        dsp_worker_semaphore fWorkerDone;
+        std::atomic<bool> fWorkerStop;
+        int fWorkerCount;
+        FAUSTFLOAT** fWorkerInputs;
+    #endif
   
+        // Vectorized kernels, see poly-mix.h
         FAUSTFLOAT mixCheckVoice(int count, FAUSTFLOAT** mixBuffer, FAUSTFLOAT** outBuffer)
         {
             FAUSTFLOAT level = 0;
             for (int chan = 0; chan < getNumOutputs(); chan++) {
-                FAUSTFLOAT* mixChannel = mixBuffer[chan];
-                FAUSTFLOAT* outChannel = outBuffer[chan];
-                for (int frame = 0; frame < count; frame++) {
-                    level = std::max<FAUSTFLOAT>(level, (FAUSTFLOAT)fabs(mixChannel[frame]));
-                    outChannel[frame] += mixChannel[frame];
-                }
+                level = poly_mix::mixCheck(count, mixBuffer[chan], outBuffer[chan], level);
             }
             return level;
         }
@@ -483,11 +691,7 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
         void mixVoice(int count, FAUSTFLOAT** mixBuffer, FAUSTFLOAT** outBuffer)
         {
             for (int chan = 0; chan < getNumOutputs(); chan++) {
-                FAUSTFLOAT* mixChannel = mixBuffer[chan];
-                FAUSTFLOAT* outChannel = outBuffer[chan];
-                for (int frame = 0; frame < count; frame++) {
-                    outChannel[frame] += mixChannel[frame];
-                }
+                poly_mix::mix(count, mixBuffer[chan], outBuffer[chan]);
             }
         }
     
@@ -505,86 +709,143 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
             }
         }
     
-        int getPlayingVoice(int pitch)
+    #ifdef POLY_THREADS
+        // Render the voices of the given worker in its own buffers
+        void renderVoices(int worker)
         {
-            int voice_playing = kNoVoice;
-            int oldest_date_playing = INT_MAX;
-            
+            voice_worker& cur_worker = fWorkers[worker];
+            clear(fWorkerCount, cur_worker.fOutBuffer);
+            for (size_t i = worker; i < fPlayingVoices.size(); i += fWorkers.size()) {
+                dsp_voice* voice = fVoiceTable[fPlayingVoices[i]];
+                voice->compute(fWorkerCount, fWorkerInputs, cur_worker.fMixBuffer);
+                if (fVoiceControl) {
+                    voice->fLevel = mixCheckVoice(fWorkerCount, cur_worker.fMixBuffer, cur_worker.fOutBuffer);
+                } else {
+                    mixVoice(fWorkerCount, cur_worker.fMixBuffer, cur_worker.fOutBuffer);
+                }
+            }
+        }
+    
+        void runWorker(int worker)
+        {
+            while (true) {
+                fWorkers[worker].fStart->wait();
+                if (fWorkerStop.load(std::memory_order_acquire)) return;
+                renderVoices(worker);
+                fWorkerDone.post();
+            }
+        }
+    
+        void computeThreaded(int count, FAUSTFLOAT** inputs)
+        {
+            fPlayingVoices.clear();
             for (size_t i = 0; i < fVoiceTable.size(); i++) {
-                if (fVoiceTable[i]->fNote == pitch) {
-                    // Keeps oldest playing voice
-                    if (fVoiceTable[i]->fDate < oldest_date_playing) {
-                        oldest_date_playing = fVoiceTable[i]->fDate;
-                        voice_playing = int(i);
-                    }
+                if (!fVoiceControl || fVoiceTable[i]->fNote != kFreeVoice) {
+                    fPlayingVoices.push_back(int(i));
                 }
             }
-            
-            return voice_playing;
+            fWorkerCount = count;
+            fWorkerInputs = inputs;
+        
+            // Wake up the helper threads (the semaphores publish the cycle), and render the audio thread part
+            for (size_t worker = 1; worker < fWorkers.size(); worker++) {
+                fWorkers[worker].fStart->post();
+            }
+            renderVoices(0);
+            for (size_t worker = 1; worker < fWorkers.size(); worker++) {
+                fWorkerDone.wait();
+            }
+        
+            // Sum the worker buffers in a fixed order (worker 0 renders in fOutBuffer)
+            for (size_t worker = 1; worker < fWorkers.size(); worker++) {
+                mixVoice(count, fWorkers[worker].fOutBuffer, fOutBuffer);
+            }
+        
+            // Check the level to possibly set the voices in kFreeVoice again
+            if (fVoiceControl) {
+                for (size_t i = 0; i < fPlayingVoices.size(); i++) {
+                    releaseVoice(fPlayingVoices[i], count);
+                }
+            }
+        }
+    #endif
+    
+        // Called by the audio thread, the freed voice is given back to fVoiceIndex by the next event
+        void releaseVoice(int index, int count)
+        {
+            dsp_voice* voice = fVoiceTable[index];
+            voice->fRelease -= count;
+            if ((voice->fNote == kReleaseVoice)
+                && (voice->fRelease < 0)
+                && (voice->fLevel < VOICE_STOP_LEVEL)) {
+                voice->fNote = kFreeVoice;
+                fVoiceIndex.pushFreed(index);
+            }
+        }
+    
+    #ifdef POLY_THREADS
+        void stopVoiceThreads()
+        {
+            fWorkerStop.store(true, std::memory_order_release);
+            for (size_t i = 0; i < fWorkerThreads.size(); i++) {
+                fWorkers[i + 1].fStart->post();
+                fWorkerThreads[i].join();
+            }
+            fWorkerThreads.clear();
+            // Worker 0 uses the main buffers
+            for (size_t worker = 1; worker < fWorkers.size(); worker++) {
+                for (int chan = 0; chan < getNumOutputs(); chan++) {
+                    delete[] fWorkers[worker].fMixBuffer[chan];
+                    delete[] fWorkers[worker].fOutBuffer[chan];
+                }
+                delete[] fWorkers[worker].fMixBuffer;
+                delete[] fWorkers[worker].fOutBuffer;
+            }
+            fWorkers.clear();
+            fWorkerStop = false;
+        }
+    #endif
+    
+        int getPlayingVoice(int pitch)
+        {
+            fVoiceIndex.popFreed();
+            // Oldest playing voice
+            return fVoiceIndex.getOldestPlaying(pitch);
         }
     
         // Always returns a voice
         int getFreeVoice()
         {
-            int voice = kNoVoice;
+            fVoiceIndex.popFreed();
             
             // Looks for the first available voice
-            for (size_t i = 0; i < fVoiceTable.size(); i++) {
-                if (fVoiceTable[i]->fNote == kFreeVoice) {
-                    voice = int(i);
-                    goto result;
-                }
-            }
-
-            {
-                // Otherwise steal one
-                int voice_release = kNoVoice;
-                int voice_playing = kNoVoice;
-                
-                int oldest_date_release = INT_MAX;
-                int oldest_date_playing = INT_MAX;
-
-                // Scan all voices
-                for (size_t i = 0; i < fVoiceTable.size(); i++) {
-                    if (fVoiceTable[i]->fNote == kReleaseVoice) {
-                        // Keeps oldest release voice
-                        if (fVoiceTable[i]->fDate < oldest_date_release) {
-                            oldest_date_release = fVoiceTable[i]->fDate;
-                            voice_release = int(i);
-                        }
-                    } else {
-                        // Otherwise keeps oldest playing voice
-                        if (fVoiceTable[i]->fDate < oldest_date_playing) {
-                            oldest_date_playing = fVoiceTable[i]->fDate;
-                            voice_playing = int(i);
-                        }
-                    }
-                }
+            int voice = fVoiceIndex.getFirstFree();
             
-                // Then decide which one to steal
-                if (oldest_date_release != INT_MAX) {
+            // Otherwise steal one: oldest release voice, or oldest playing voice
+            if (voice == kNoVoice) {
+                int voice_release = fVoiceIndex.getOldestRelease();
+                int voice_playing = fVoiceIndex.getOldestPlaying();
+                if (voice_release != kNoVoice) {
                     fprintf(stderr, "Steal release voice : voice_date = %d cur_date = %d voice = %d \n",
                             fVoiceTable[voice_release]->fDate,
                             fDate,
                             voice_release);
                     voice = voice_release;
-                    goto result;
-                } else if (oldest_date_playing != INT_MAX) {
+                } else if (voice_playing != kNoVoice) {
                     fprintf(stderr, "Steal playing voice : voice_date = %d cur_date = %d voice = %d \n",
                             fVoiceTable[voice_playing]->fDate,
                             fDate,
-                            voice_release);
+                            voice_playing);
                     voice = voice_playing;
-                    goto result;
                 } else {
                     assert(false);
                     return kNoVoice;
                 }
             }
             
-        result:
             fVoiceTable[voice]->fDate = fDate++;
             fVoiceTable[voice]->fNote = kActiveVoice;
+            fVoiceIndex.update(voice);
             return voice;
         }
 
@@ -623,16 +884,22 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
                    int nvoices,
                    bool control = false,
                    bool group = true)
-        : dsp_voice_group(panic, this, control, group), dsp_poly(dsp) // dsp parameter is deallocated by ~dsp_poly
+        : dsp_voice_group(panic, this, control, group), dsp_poly(dsp), fVoiceIndex(fVoiceTable) // dsp parameter is deallocated by ~dsp_poly
         {
             fDate = 0;
             fMidiHandler = nullptr;
+        #ifdef POLY_THREADS
+            fWorkerStop = false;
+            fWorkerCount = 0;
+            fWorkerInputs = nullptr;
+        #endif
 
             // Create voices
             assert(nvoices > 0);
             for (int i = 0; i < nvoices; i++) {
                 addVoice(new dsp_voice(dsp->clone()));
             }
+            fVoiceIndex.init();
 
             // Init audio output buffers
             fMixBuffer = new FAUSTFLOAT*[getNumOutputs()];
@@ -649,6 +916,9 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
         {
             // Remove from fMidiHandler
             if (fMidiHandler) fMidiHandler->removeMidiIn(this);
+        #ifdef POLY_THREADS
+            stopVoiceThreads();
+        #endif
             for (int chan = 0; chan < getNumOutputs(); chan++) {
                 delete[] fMixBuffer[chan];
                 delete[] fOutBuffer[chan];
@@ -722,8 +992,48 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
 
         virtual mydsp_poly* clone()
         {
-            return new mydsp_poly(fDSP->clone(), int(fVoiceTable.size()), fVoiceControl, fGroupControl);
+            mydsp_poly* poly = new mydsp_poly(fDSP->clone(), int(fVoiceTable.size()), fVoiceControl, fGroupControl);
+        #ifdef POLY_THREADS
+            poly->setVoiceThreads(getVoiceThreads());
+        #endif
+            return poly;
         }
+    
+    #ifdef POLY_THREADS
+        /**
+         * Render the voices with several threads (only available when POLY_THREADS is defined).
+         *
+         * @param threads - the number of threads including the audio thread, 1 (the default) meaning serial rendering.
+         *
+         * Has to be called when the DSP is not running, typically before starting the audio driver.
+         */
+        void setVoiceThreads(int threads)
+        {
+            stopVoiceThreads();
+            if (threads <= 1) return;
+        
+            // Worker 0 is the audio thread and renders in the main buffers
+            fWorkers.resize(threads);
+            fWorkers[0].fMixBuffer = fMixBuffer;
+            fWorkers[0].fOutBuffer = fOutBuffer;
+            for (int worker = 1; worker < threads; worker++) {
+                fWorkers[worker].fMixBuffer = new FAUSTFLOAT*[getNumOutputs()];
+                fWorkers[worker].fOutBuffer = new FAUSTFLOAT*[getNumOutputs()];
+                for (int chan = 0; chan < getNumOutputs(); chan++) {
+                    fWorkers[worker].fMixBuffer[chan] = new FAUSTFLOAT[MIX_BUFFER_SIZE];
+                    fWorkers[worker].fOutBuffer[chan] = new FAUSTFLOAT[MIX_BUFFER_SIZE];
+                }
+                fWorkers[worker].fStart.reset(new dsp_worker_semaphore());
+            }
+            fPlayingVoices.reserve(fVoiceTable.size());
+            for (int worker = 1; worker < threads; worker++) {
+                fWorkerThreads.push_back(std::thread(&mydsp_poly::runWorker, this, worker));
+                setWorkerRealtimePriority(fWorkerThreads.back());
+            }
+        }
+    
+        int getVoiceThreads() { return std::max<int>(1, int(fWorkers.size())); }
+    #endif
 
         void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
         {
@@ -732,6 +1042,13 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
             // First clear the intermediate fOutBuffer
             clear(count, fOutBuffer);
 
+        #ifdef POLY_THREADS
+            if (fWorkers.size() > 0) {
+                computeThreaded(count, inputs);
+                copy(count, fOutBuffer, outputs);
+                return;
+            }
+        #endif
             if (fVoiceControl) {
                 // Mix all playing voices
                 for (size_t i = 0; i < fVoiceTable.size(); i++) {
@@ -741,12 +1058,7 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
                         // Mix it in result
                         voice->fLevel = mixCheckVoice(count, fMixBuffer, fOutBuffer);
                         // Check the level to possibly set the voice in kFreeVoice again
-                        voice->fRelease -= count;
-                        if ((voice->fNote == kReleaseVoice)
-                            && (voice->fRelease < 0)
-                            && (voice->fLevel < VOICE_STOP_LEVEL)) {
-                            voice->fNote = kFreeVoice;
-                        }
+                        releaseVoice(int(i), count);
                     }
                 }
             } else {
@@ -769,8 +1081,10 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
         // Terminate all active voices, gently or immediately (depending of 'hard' value)
         void allNotesOff(bool hard = false)
         {
+            fVoiceIndex.popFreed();
             for (size_t i = 0; i < fVoiceTable.size(); i++) {
                 fVoiceTable[i]->keyOff(hard);
+                fVoiceIndex.update(int(i));
             }
         }
 
@@ -787,7 +1101,9 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
         {
             std::vector<dsp_voice*>::iterator it = find(fVoiceTable.begin(), fVoiceTable.end(), reinterpret_cast<dsp_voice*>(voice));
             if (it != fVoiceTable.end()) {
+                fVoiceIndex.popFreed();
                 (*it)->keyOff();
+                fVoiceIndex.update(int(it - fVoiceTable.begin()));
             } else {
                 fprintf(stderr, "Voice not found\n");
             }
@@ -799,6 +1115,7 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
             if (checkPolyphony()) {
                 int voice = getFreeVoice();
                 fVoiceTable[voice]->keyOn(pitch, velocity);
+                fVoiceIndex.update(voice);
                 return fVoiceTable[voice];
             } else {
                 return 0;
@@ -811,6 +1128,7 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
                 int voice = getPlayingVoice(pitch);
                 if (voice != kNoVoice) {
                     fVoiceTable[voice]->keyOff();
+                    fVoiceIndex.update(voice);
                 } else {
                     fprintf(stderr, "Playing pitch = %d not found\n", pitch);
                 }
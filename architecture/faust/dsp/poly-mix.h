@@ -0,0 +1,298 @@
+/************************** BEGIN poly-mix.h **************************/
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __poly_mix__
+#define __poly_mix__
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#ifndef FAUSTFLOAT
+#define FAUSTFLOAT float
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define POLY_MIX_SSE2
+    // AVX2 version compiled with a 'target' attribute and selected at runtime
+    #if (defined(__GNUC__) || defined(__clang__)) && !defined(__EMSCRIPTEN__)
+        #include <immintrin.h>
+        #define POLY_MIX_AVX2
+    #endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define POLY_MIX_NEON
+#endif
+
+/**
+ * Mixing kernels used by mydsp_poly to add a voice in the output buffer ('mix')
+ * and also compute its peak level ('mixCheck').
+ *
+ * The vectorized versions give the exact same result as the scalar ones:
+ * each output sample is a single addition, and the peak level is a maximum
+ * (with the same NaN handling: a NaN sample does not change the level).
+ * The best available version is chosen at first use.
+ */
+struct poly_mix {
+
+    typedef FAUSTFLOAT (*mix_check_fun)(int count, const FAUSTFLOAT* mix, FAUSTFLOAT* out, FAUSTFLOAT level);
+    typedef void (*mix_fun)(int count, const FAUSTFLOAT* mix, FAUSTFLOAT* out);
+
+    struct kernels {
+        mix_check_fun fMixCheck;
+        mix_fun fMix;
+        const char* fName;
+    };
+
+    // Scalar versions
+    template <typename REAL>
+    static REAL mixCheckScalar(int count, const REAL* mix, REAL* out, REAL level)
+    {
+        for (int frame = 0; frame < count; frame++) {
+            level = std::max<REAL>(level, (REAL)std::fabs(mix[frame]));
+            out[frame] += mix[frame];
+        }
+        return level;
+    }
+
+    template <typename REAL>
+    static void mixScalar(int count, const REAL* mix, REAL* out)
+    {
+        for (int frame = 0; frame < count; frame++) {
+            out[frame] += mix[frame];
+        }
+    }
+
+    // Reduce the lanes of a vector level (none of them can be NaN)
+    template <typename REAL>
+    static REAL maxLanes(const REAL* lanes, int size, REAL level)
+    {
+        for (int i = 0; i < size; i++) {
+            level = std::max<REAL>(level, lanes[i]);
+        }
+        return level;
+    }
+
+#ifdef POLY_MIX_SSE2
+    // _mm_max_xx(a, b) returns b when a is NaN, so 'abs' is the first parameter
+    static float mixCheckSSE2(int count, const float* mix, float* out, float level)
+    {
+        const __m128 sign = _mm_set1_ps(-0.f);
+        __m128 vlevel = _mm_set1_ps(level);
+        int frame = 0;
+        for (; frame + 4 <= count; frame += 4) {
+            __m128 m = _mm_loadu_ps(mix + frame);
+            vlevel = _mm_max_ps(_mm_andnot_ps(sign, m), vlevel);
+            _mm_storeu_ps(out + frame, _mm_add_ps(_mm_loadu_ps(out + frame), m));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, vlevel);
+        return mixCheckScalar<float>(count - frame, mix + frame, out + frame, maxLanes<float>(lanes, 4, level));
+    }
+
+    static double mixCheckSSE2(int count, const double* mix, double* out, double level)
+    {
+        const __m128d sign = _mm_set1_pd(-0.);
+        __m128d vlevel = _mm_set1_pd(level);
+        int frame = 0;
+        for (; frame + 2 <= count; frame += 2) {
+            __m128d m = _mm_loadu_pd(mix + frame);
+            vlevel = _mm_max_pd(_mm_andnot_pd(sign, m), vlevel);
+            _mm_storeu_pd(out + frame, _mm_add_pd(_mm_loadu_pd(out + frame), m));
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, vlevel);
+        return mixCheckScalar<double>(count - frame, mix + frame, out + frame, maxLanes<double>(lanes, 2, level));
+    }
+
+    static void mixSSE2(int count, const float* mix, float* out)
+    {
+        int frame = 0;
+        for (; frame + 4 <= count; frame += 4) {
+            _mm_storeu_ps(out + frame, _mm_add_ps(_mm_loadu_ps(out + frame), _mm_loadu_ps(mix + frame)));
+        }
+        mixScalar<float>(count - frame, mix + frame, out + frame);
+    }
+
+    static void mixSSE2(int count, const double* mix, double* out)
+    {
+        int frame = 0;
+        for (; frame + 2 <= count; frame += 2) {
+            _mm_storeu_pd(out + frame, _mm_add_pd(_mm_loadu_pd(out + frame), _mm_loadu_pd(mix + frame)));
+        }
+        mixScalar<double>(count - frame, mix + frame, out + frame);
+    }
+#endif
+
+#ifdef POLY_MIX_AVX2
+    __attribute__((target("avx2")))
+    static float mixCheckAVX2(int count, const float* mix, float* out, float level)
+    {
+        const __m256 sign = _mm256_set1_ps(-0.f);
+        __m256 vlevel = _mm256_set1_ps(level);
+        int frame = 0;
+        for (; frame + 8 <= count; frame += 8) {
+            __m256 m = _mm256_loadu_ps(mix + frame);
+            vlevel = _mm256_max_ps(_mm256_andnot_ps(sign, m), vlevel);
+            _mm256_storeu_ps(out + frame, _mm256_add_ps(_mm256_loadu_ps(out + frame), m));
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, vlevel);
+        return mixCheckScalar<float>(count - frame, mix + frame, out + frame, maxLanes<float>(lanes, 8, level));
+    }
+
+    __attribute__((target("avx2")))
+    static double mixCheckAVX2(int count, const double* mix, double* out, double level)
+    {
+        const __m256d sign = _mm256_set1_pd(-0.);
+        __m256d vlevel = _mm256_set1_pd(level);
+        int frame = 0;
+        for (; frame + 4 <= count; frame += 4) {
+            __m256d m = _mm256_loadu_pd(mix + frame);
+            vlevel = _mm256_max_pd(_mm256_andnot_pd(sign, m), vlevel);
+            _mm256_storeu_pd(out + frame, _mm256_add_pd(_mm256_loadu_pd(out + frame), m));
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, vlevel);
+        return mixCheckScalar<double>(count - frame, mix + frame, out + frame, maxLanes<double>(lanes, 4, level));
+    }
+
+    __attribute__((target("avx2")))
+    static void mixAVX2(int count, const float* mix, float* out)
+    {
+        int frame = 0;
+        for (; frame + 8 <= count; frame += 8) {
+            _mm256_storeu_ps(out + frame, _mm256_add_ps(_mm256_loadu_ps(out + frame), _mm256_loadu_ps(mix + frame)));
+        }
+        mixScalar<float>(count - frame, mix + frame, out + frame);
+    }
+
+    __attribute__((target("avx2")))
+    static void mixAVX2(int count, const double* mix, double* out)
+    {
+        int frame = 0;
+        for (; frame + 4 <= count; frame += 4) {
+            _mm256_storeu_pd(out + frame, _mm256_add_pd(_mm256_loadu_pd(out + frame), _mm256_loadu_pd(mix + frame)));
+        }
+        mixScalar<double>(count - frame, mix + frame, out + frame);
+    }
+
+    static bool hasAVX2()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+
+#ifdef POLY_MIX_NEON
+    // vmaxnmq_xx returns the non-NaN operand, as the scalar version
+    static float mixCheckNEON(int count, const float* mix, float* out, float level)
+    {
+        float32x4_t vlevel = vdupq_n_f32(level);
+        int frame = 0;
+        for (; frame + 4 <= count; frame += 4) {
+            float32x4_t m = vld1q_f32(mix + frame);
+            vlevel = vmaxnmq_f32(vabsq_f32(m), vlevel);
+            vst1q_f32(out + frame, vaddq_f32(vld1q_f32(out + frame), m));
+        }
+        float lanes[4];
+        vst1q_f32(lanes, vlevel);
+        return mixCheckScalar<float>(count - frame, mix + frame, out + frame, maxLanes<float>(lanes, 4, level));
+    }
+
+    static double mixCheckNEON(int count, const double* mix, double* out, double level)
+    {
+        float64x2_t vlevel = vdupq_n_f64(level);
+        int frame = 0;
+        for (; frame + 2 <= count; frame += 2) {
+            float64x2_t m = vld1q_f64(mix + frame);
+            vlevel = vmaxnmq_f64(vabsq_f64(m), vlevel);
+            vst1q_f64(out + frame, vaddq_f64(vld1q_f64(out + frame), m));
+        }
+        double lanes[2];
+        vst1q_f64(lanes, vlevel);
+        return mixCheckScalar<double>(count - frame, mix + frame, out + frame, maxLanes<double>(lanes, 2, level));
+    }
+
+    static void mixNEON(int count, const float* mix, float* out)
+    {
+        int frame = 0;
+        for (; frame + 4 <= count; frame += 4) {
+            vst1q_f32(out + frame, vaddq_f32(vld1q_f32(out + frame), vld1q_f32(mix + frame)));
+        }
+        mixScalar<float>(count - frame, mix + frame, out + frame);
+    }
+
+    static void mixNEON(int count, const double* mix, double* out)
+    {
+        int frame = 0;
+        for (; frame + 2 <= count; frame += 2) {
+            vst1q_f64(out + frame, vaddq_f64(vld1q_f64(out + frame), vld1q_f64(mix + frame)));
+        }
+        mixScalar<double>(count - frame, mix + frame, out + frame);
+    }
+#endif
+
+    // All kernels available on the running machine, the best one last
+    static std::vector<kernels> getAllKernels()
+    {
+        std::vector<kernels> all;
+        all.push_back({ &mixCheckScalar<FAUSTFLOAT>, &mixScalar<FAUSTFLOAT>, "scalar" });
+    #ifdef POLY_MIX_SSE2
+        all.push_back({ static_cast<mix_check_fun>(&mixCheckSSE2), static_cast<mix_fun>(&mixSSE2), "SSE2" });
+    #endif
+    #ifdef POLY_MIX_AVX2
+        if (hasAVX2()) {
+            all.push_back({ static_cast<mix_check_fun>(&mixCheckAVX2), static_cast<mix_fun>(&mixAVX2), "AVX2" });
+        }
+    #endif
+    #ifdef POLY_MIX_NEON
+        all.push_back({ static_cast<mix_check_fun>(&mixCheckNEON), static_cast<mix_fun>(&mixNEON), "NEON" });
+    #endif
+        return all;
+    }
+
+    static const kernels& getKernels()
+    {
+        static kernels best = getAllKernels().back();
+        return best;
+    }
+
+    // Add 'mix' in 'out' and return the peak level of 'mix' (starting from 'level')
+    static FAUSTFLOAT mixCheck(int count, const FAUSTFLOAT* mix, FAUSTFLOAT* out, FAUSTFLOAT level)
+    {
+        return getKernels().fMixCheck(count, mix, out, level);
+    }
+
+    // Add 'mix' in 'out'
+    static void mix(int count, const FAUSTFLOAT* mix, FAUSTFLOAT* out)
+    {
+        getKernels().fMix(count, mix, out);
+    }
+
+};
+
+#endif
+/**************************  END  poly-mix.h **************************/
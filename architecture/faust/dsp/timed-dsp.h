@@ -26,13 +26,16 @@
 #define __timed_dsp__
 
 #include <set>
+#include <vector>
+#include <atomic>
+#include <algorithm>
 #include <float.h>
 #include <assert.h>
 
 #include "faust/dsp/dsp.h" 
 #include "faust/gui/GUI.h" 
 #include "faust/gui/DecoratorUI.h"
-#include "faust/gui/ring-buffer.h"
+#include "faust/gui/spsc-queue.h"
 
 namespace {
     
@@ -128,20 +131,58 @@ struct ZoneUI : public GenericUI
  * Timed signal processor that allows to handle the decorated DSP by 'slices'
  * that is, calling the 'compute' method several times and changing control
  * parameters between slices.
+ *
+ * Control threads signal the updated zones in the 'fPending' bit set, and the dated
+ * controls of the updated zones are merged in date order with a heap holding
+ * the first control of each zone, so that the cost depends on the number of
+ * controls to apply and not of the number of zones.
  */
 
 class timed_dsp : public decorator_dsp {
 
     protected:
+    
+        // First control of a zone in the merge heap
+        struct ZoneControl {
+            double fDate;
+            FAUSTFLOAT* fZone;
+            TimedZone* fTimedZone;
+            
+            ZoneControl(double date, FAUSTFLOAT* zone, TimedZone* timed_zone)
+            :fDate(date), fZone(zone), fTimedZone(timed_zone)
+            {}
+            
+            // Ordering for a min-heap on dates, zones with the same date are taken in address order
+            bool operator<(const ZoneControl& control) const
+            {
+                return (fDate > control.fDate) || ((fDate == control.fDate) && (fZone > control.fZone));
+            }
+        };
         
         double fDateUsec;       // Compute call date in usec
         double fOffsetUsec;     // Compute call offset in usec
         bool fFirstCallback;
         ZoneUI fZoneUI;
     
+        std::vector<FAUSTFLOAT*> fZones;        // Handled zones, indexed by their bit in 'fPending'
+        std::atomic<uint64_t>* fPending;        // Bit set of the updated zones
+        int fPendingWords;
+        std::vector<ZoneControl> fHeap;
+    
         FAUSTFLOAT** fInputsSlice;
         FAUSTFLOAT** fOutputsSlice;
     
+        static int lowestBit(uint64_t word)
+        {
+        #if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(word);
+        #else
+            int bit = 0;
+            while (!(word & 1)) { word >>= 1; bit++; }
+            return bit;
+        #endif
+        }
+    
         void computeSlice(int offset, int slice, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) 
         {
             if (slice > 0) {
@@ -159,39 +200,73 @@ class timed_dsp : public decorator_dsp {
         {
             return std::max<double>(0., (double(getSampleRate()) * (usec - fDateUsec)) / 1000000.);
         }
-        
-        ztimedmap::iterator getNextControl(DatedControl& res)
+    
+        // Stop signaling the zones (that are still in GUI::gTimedZoneMap), the pending words can then be deleted
+        void unbindZones()
         {
-            DatedControl date1(DBL_MAX, 0);
-            ztimedmap::iterator it1, it2 = GUI::gTimedZoneMap.end();
-            std::set<FAUSTFLOAT*>::iterator it3;
-              
-            // Find date of next audio slice to compute
-            for (it3 = fZoneUI.fZoneSet.begin(); it3 != fZoneUI.fZoneSet.end(); it3++) {
-                // If value list is not empty, get the date and keep the minimal one
-                it1 = GUI::gTimedZoneMap.find(*it3);
-                if (it1 != GUI::gTimedZoneMap.end()) { // Check if zone still in global GUI::gTimedZoneMap (since MidiUI may have been desallocated)
-                    DatedControl date2;
-                    if (ringbuffer_peek((*it1).second, (char*)&date2, sizeof(DatedControl)) == sizeof(DatedControl) 
-                        && date2.fDate < date1.fDate) {
-                        it2 = it1;
-                        date1 = date2;
+            for (auto& it : fZones) {
+                ztimedmap::iterator it1 = GUI::gTimedZoneMap.find(it);
+                if (it1 != GUI::gTimedZoneMap.end()) (*it1).second->setPending(nullptr, 0);
+            }
+            fZones.clear();
+            delete [] fPending;
+            fPending = nullptr;
+            fPendingWords = 0;
+        }
+    
+        // Give each zone its bit in 'fPending', all zones are initially pending to get the already received controls
+        void bindZones()
+        {
+            unbindZones();
+            fZones.assign(fZoneUI.fZoneSet.begin(), fZoneUI.fZoneSet.end());
+            fPendingWords = int((fZones.size() + 63) / 64);
+            fPending = new std::atomic<uint64_t>[fPendingWords];
+            for (int word = 0; word < fPendingWords; word++) {
+                fPending[word] = 0;
+            }
+            for (size_t zone = 0; zone < fZones.size(); zone++) {
+                std::atomic<uint64_t>* pending = &fPending[zone / 64];
+                uint64_t bit = uint64_t(1) << (zone % 64);
+                *pending |= bit;
+                GUI::gTimedZoneMap[fZones[zone]]->setPending(pending, bit);
+            }
+            fHeap.reserve(fZones.size());
+        }
+    
+        // Add the first control of the updated zones in the (empty) heap
+        void collectControls()
+        {
+            for (int word = 0; word < fPendingWords; word++) {
+                uint64_t bits = fPending[word].exchange(0, std::memory_order_acquire);
+                while (bits) {
+                    FAUSTFLOAT* zone = fZones[word * 64 + lowestBit(bits)];
+                    bits &= bits - 1;
+                    // Check if zone still in global GUI::gTimedZoneMap (since MidiUI may have been desallocated)
+                    ztimedmap::iterator it = GUI::gTimedZoneMap.find(zone);
+                    if (it == GUI::gTimedZoneMap.end()) continue;
+                    TimedZone* timed_zone = (*it).second;
+                    DatedControl* control = timed_zone->fControls.front();
+                    if (control) {
+                        fHeap.push_back(ZoneControl(control->fDate, zone, timed_zone));
+                        std::push_heap(fHeap.begin(), fHeap.end());
                     }
                 }
             }
-            
-            res = date1;
-            return it2;
         }
         
         virtual void computeAux(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs, bool convert_ts)
         {
             int slice, offset = 0;
-            ztimedmap::iterator it;
-            DatedControl next_control;
+            
+            collectControls();
              
             // Do audio computation "slice" by "slice"
-            while ((it = getNextControl(next_control)) != GUI::gTimedZoneMap.end()) {
+            while (fHeap.size() > 0) {
+                
+                std::pop_heap(fHeap.begin(), fHeap.end());
+                ZoneControl& first = fHeap.back();
+                TimedZone* timed_zone = first.fTimedZone;
+                DatedControl next_control = *timed_zone->fControls.front();
                 
                 // If needed, convert next_control in samples from begining of the buffer, possible moving to 0 (if negative)
                 if (convert_ts) {
@@ -204,11 +279,17 @@ class timed_dsp : public decorator_dsp {
                 offset += slice;
                
                 // Update control
-                ringbuffer_t* control_values = (*it).second;
-                *((*it).first) = next_control.fValue;
+                *(first.fZone) = next_control.fValue;
                 
-                // Move ringbuffer pointer
-                ringbuffer_read_advance(control_values, sizeof(DatedControl));
+                // Remove it from the queue, and put the zone back in the heap with its next control
+                timed_zone->fControls.pop();
+                DatedControl* control = timed_zone->fControls.front();
+                if (control) {
+                    first.fDate = control->fDate;
+                    std::push_heap(fHeap.begin(), fHeap.end());
+                } else {
+                    fHeap.pop_back();
+                }
             } 
             
             // Compute last audio slice
@@ -218,13 +299,14 @@ class timed_dsp : public decorator_dsp {
 
     public:
 
-        timed_dsp(dsp* dsp):decorator_dsp(dsp), fDateUsec(0), fOffsetUsec(0), fFirstCallback(true)
+        timed_dsp(dsp* dsp):decorator_dsp(dsp), fDateUsec(0), fOffsetUsec(0), fFirstCallback(true), fPending(nullptr), fPendingWords(0)
         {
             fInputsSlice = new FAUSTFLOAT*[dsp->getNumInputs()];
             fOutputsSlice = new FAUSTFLOAT*[dsp->getNumOutputs()];
         }
         virtual ~timed_dsp() 
         {
+            unbindZones();
             delete [] fInputsSlice;
             delete [] fOutputsSlice;
         }
@@ -239,6 +321,7 @@ class timed_dsp : public decorator_dsp {
             fDSP->buildUserInterface(ui_interface); 
             // Only keep zones that are in GUI::gTimedZoneMap
             fDSP->buildUserInterface(&fZoneUI);
+            bindZones();
         }
     
         virtual timed_dsp* clone()
@@ -34,6 +34,7 @@
 #include "faust/gui/meta.h"
 #include "faust/gui/UI.h"
 #include "faust/gui/PathBuilder.h"
+#include "faust/gui/ParamIndex.h"
 #include "faust/gui/ValueConverter.h"
 
 class APIUI : public PathBuilder, public Meta, public UI
@@ -51,6 +52,8 @@ class APIUI : public PathBuilder, public Meta, public UI
         std::vector<std::string> fLabels;
         std::map<std::string, int> fPathMap;
         std::map<std::string, int> fLabelMap;
+        ParamIndex fPathIndex;      // Same content as fPathMap, to find indexes without allocation
+        ParamIndex fLabelIndex;     // Same content as fLabelMap
         std::vector<ValueConverter*> fConversion;
         std::vector<FAUSTFLOAT*> fZone;
         std::vector<FAUSTFLOAT> fInit;
@@ -88,6 +91,8 @@ class APIUI : public PathBuilder, public Meta, public UI
                                   ItemType type)
         {
             std::string path = buildPath(label);
+            fPathIndex.add(path, fNumParameters);
+            fLabelIndex.add(label, fNumParameters);
             fPathMap[path] = fLabelMap[label] = fNumParameters++;
             fPaths.push_back(path);
             fLabels.push_back(label);
@@ -347,13 +352,8 @@ class APIUI : public PathBuilder, public Meta, public UI
         
         int getParamIndex(const char* path)
         {
-            if (fPathMap.find(path) != fPathMap.end()) {
-                return fPathMap[path];
-            } else if (fLabelMap.find(path) != fLabelMap.end()) {
-                return fLabelMap[path];
-            } else {
-                return -1;
-            }
+            int index = fPathIndex.find(path);
+            return (index >= 0) ? index : fLabelIndex.find(path);
         }
         const char* getParamAddress(int p) { return fPaths[p].c_str(); }
         const char* getParamLabel(int p) { return fLabels[p].c_str(); }
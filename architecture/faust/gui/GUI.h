@@ -28,7 +28,10 @@
 #include <list>
 #include <map>
 #include <vector>
+#include <atomic>
+#include <thread>
 #include <assert.h>
+#include <stdint.h>
 
 #ifdef _WIN32
 # pragma warning (disable: 4100)
@@ -39,7 +42,7 @@
 #include "faust/gui/UI.h"
 #include "faust/gui/ValueConverter.h"
 #include "faust/gui/MetaDataUI.h"
-#include "faust/gui/ring-buffer.h"
+#include "faust/gui/spsc-queue.h"
 
 /*******************************************************************************
  * GUI : Abstract Graphic User Interface
@@ -109,7 +112,7 @@ static void deleteClist(clist* cl);
 /**
  * A list containing all groupe uiItemBase objects.
  */
-struct clist : public std::list<uiItemBase*>
+struct clist : public std::vector<uiItemBase*>
 {
     
     virtual ~clist()
@@ -123,7 +126,60 @@ static void createUiCallbackItem(GUI* ui, FAUSTFLOAT* zone, uiCallback foo, void
 
 typedef std::map<FAUSTFLOAT*, clist*> zmap;
 
-typedef std::map<FAUSTFLOAT*, ringbuffer_t*> ztimedmap;
+/**
+ *  For timestamped control.
+ */
+struct DatedControl {
+    
+    double fDate;
+    FAUSTFLOAT fValue;
+    
+    DatedControl(double d = 0., FAUSTFLOAT v = FAUSTFLOAT(0)):fDate(d), fValue(v) {}
+    
+};
+
+/**
+ * Dated controls of a zone, written by a single control thread.
+ * The consumer (timed_dsp) is signaled by setting the zone bit in one of its 'pending' words,
+ * so that it only has to look at the updated zones.
+ */
+struct TimedZone {
+    
+    spsc_queue<DatedControl> fControls;
+    std::atomic<std::atomic<uint64_t>*> fPending;    // Word of the consumer pending set, or nullptr
+    std::atomic<uint64_t> fBit;                      // Bit of the zone in this word
+    std::atomic<bool> fSignaling;                    // Set while the producer may access the pending word
+    
+    TimedZone():fControls(512), fPending(nullptr), fBit(0), fSignaling(false) {}
+    
+    bool push(const DatedControl& control)
+    {
+        if (!fControls.push(control)) return false;
+        fSignaling.store(true);
+        std::atomic<uint64_t>* pending = fPending.load();
+        if (pending) pending->fetch_or(fBit.load(std::memory_order_relaxed), std::memory_order_release);
+        fSignaling.store(false, std::memory_order_release);
+        return true;
+    }
+    
+    /*
+     Called by the consumer when it starts or stops handling the zone. The bit is written before the word
+     is published, and when the previous word is replaced, waits until the producer cannot access it anymore,
+     so that the consumer can then delete it.
+    */
+    void setPending(std::atomic<uint64_t>* pending, uint64_t bit)
+    {
+        fPending.store(nullptr);
+        while (fSignaling.load()) std::this_thread::yield();
+        if (pending) {
+            fBit.store(bit, std::memory_order_relaxed);
+            fPending.store(pending, std::memory_order_release);
+        }
+    }
+    
+};
+
+typedef std::map<FAUSTFLOAT*, TimedZone*> ztimedmap;
 
 class GUI : public UI
 {
@@ -131,9 +187,29 @@ class GUI : public UI
     private:
      
         static std::list<GUI*> fGuiList;
-        zmap fZoneMap;
         bool fStopped;
     
+        /*
+         Zones are kept in contiguous arrays, in registration order, with the last reflected value
+         of each zone. A refresh only looks at the items of zones whose value has changed
+         (by a uiItem, another GUI, the DSP for bargraphs, or any code writing the zone),
+         or which have new items to reflect ('fDirty').
+         */
+        std::map<FAUSTFLOAT*, int> fZoneIndex;
+        std::vector<FAUSTFLOAT*> fZones;
+        std::vector<FAUSTFLOAT> fValues;
+        std::vector<char> fDirty;
+        std::vector<clist*> fItems;
+    
+        void updateZone(int index, FAUSTFLOAT v)
+        {
+            fValues[index] = v;
+            fDirty[index] = false;
+            for (auto& c : *fItems[index]) {
+                if (c->cache() != v) c->reflectZone();
+            }
+        }
+    
      public:
             
         GUI():fStopped(false)
@@ -144,8 +220,8 @@ class GUI : public UI
         virtual ~GUI() 
         {   
             // delete all items
-            for (auto& it : fZoneMap) {
-                delete it.second;
+            for (auto& it : fItems) {
+                delete it;
             }
             // suppress 'this' in static fGuiList
             fGuiList.remove(this);
@@ -155,23 +231,32 @@ class GUI : public UI
         
         void registerZone(FAUSTFLOAT* z, uiItemBase* c)
         {
-            if (fZoneMap.find(z) == fZoneMap.end()) fZoneMap[z] = new clist();
-            fZoneMap[z]->push_back(c);
+            std::map<FAUSTFLOAT*, int>::iterator it = fZoneIndex.find(z);
+            int index;
+            if (it == fZoneIndex.end()) {
+                index = fZoneIndex[z] = int(fZones.size());
+                fZones.push_back(z);
+                fValues.push_back(*z);
+                fDirty.push_back(true);
+                fItems.push_back(new clist());
+            } else {
+                index = (*it).second;
+                fDirty[index] = true;
+            }
+            fItems[index]->push_back(c);
         }
     
         void updateZone(FAUSTFLOAT* z)
         {
-            FAUSTFLOAT v = *z;
-            clist* cl = fZoneMap[z];
-            for (auto& c : *cl) {
-                if (c->cache() != v) c->reflectZone();
-            }
+            std::map<FAUSTFLOAT*, int>::iterator it = fZoneIndex.find(z);
+            if (it != fZoneIndex.end()) updateZone((*it).second, *z);
         }
     
         void updateAllZones()
         {
-            for (auto& m : fZoneMap) {
-                updateZone(m.first);
+            for (size_t index = 0; index < fZones.size(); index++) {
+                FAUSTFLOAT v = *fZones[index];
+                if (v != fValues[index] || fDirty[index]) updateZone(int(index), v);
             }
         }
     
@@ -351,18 +436,6 @@ class uiCallbackItem : public uiItem {
         }
 };
 
-/**
- *  For timestamped control.
- */
-struct DatedControl {
-    
-    double fDate;
-    FAUSTFLOAT fValue;
-    
-    DatedControl(double d = 0., FAUSTFLOAT v = FAUSTFLOAT(0)):fDate(d), fValue(v) {}
-    
-};
-
 /**
  * Base class for timed items.
  */
@@ -372,6 +445,7 @@ class uiTimedItem : public uiItem
     protected:
         
         bool fDelete;
+        TimedZone* fTimedZone;
         
     public:
     
@@ -379,10 +453,12 @@ class uiTimedItem : public uiItem
         
         uiTimedItem(GUI* ui, FAUSTFLOAT* zone):uiItem(ui, zone)
         {
-            if (GUI::gTimedZoneMap.find(fZone) == GUI::gTimedZoneMap.end()) {
-                GUI::gTimedZoneMap[fZone] = ringbuffer_create(8192);
+            ztimedmap::iterator it = GUI::gTimedZoneMap.find(fZone);
+            if (it == GUI::gTimedZoneMap.end()) {
+                fTimedZone = GUI::gTimedZoneMap[fZone] = new TimedZone();
                 fDelete = true;
             } else {
+                fTimedZone = (*it).second;
                 fDelete = false;
             }
         }
@@ -391,17 +467,18 @@ class uiTimedItem : public uiItem
         {
             ztimedmap::iterator it;
             if (fDelete && ((it = GUI::gTimedZoneMap.find(fZone)) != GUI::gTimedZoneMap.end())) {
-                ringbuffer_free((*it).second);
+                // Stop signaling a consumer before deleting the zone
+                (*it).second->setPending(nullptr, 0);
+                delete (*it).second;
                 GUI::gTimedZoneMap.erase(it);
             }
+            fTimedZone = nullptr;
         }
         
         virtual void modifyZone(double date, FAUSTFLOAT v)
         {
-            size_t res;
-            DatedControl dated_val(date, v);
-            if ((res = ringbuffer_write(GUI::gTimedZoneMap[fZone], (const char*)&dated_val, sizeof(DatedControl))) != sizeof(DatedControl)) {
-                fprintf(stderr, "ringbuffer_write error DatedControl\n");
+            if (fTimedZone && !fTimedZone->push(DatedControl(date, v))) {
+                fprintf(stderr, "spsc_queue::push error DatedControl\n");
             }
         }
     
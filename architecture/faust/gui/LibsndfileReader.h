@@ -134,6 +134,58 @@ struct VFLibsndfile {
  
 };
 
+// Incremental decoding of a file, used to stream soundfiles
+struct LibsndfileDecoder : public SoundfileDecoder {
+
+    typedef sf_count_t (* sample_read)(SNDFILE* sndfile, FAUSTFLOAT* ptr, sf_count_t frames);
+
+    SNDFILE* fFile;
+    sample_read fReader;
+    FAUSTFLOAT* fBuffer;
+
+    LibsndfileDecoder(SNDFILE* snd_file, const SF_INFO& snd_info):fFile(snd_file)
+    {
+        fChannels = int(snd_info.channels);
+        fLength = int(snd_info.frames);
+        fSR = snd_info.samplerate;
+        if (sizeof(FAUSTFLOAT) == 4) {
+            fReader = reinterpret_cast<sample_read>(sf_readf_float);
+        } else {
+            fReader = reinterpret_cast<sample_read>(sf_readf_double);
+        }
+        fBuffer = new FAUSTFLOAT[BUFFER_SIZE * fChannels];
+    }
+
+    virtual ~LibsndfileDecoder()
+    {
+        sf_close(fFile);
+        delete [] fBuffer;
+    }
+
+    int decode(FAUSTFLOAT** buffers, int frames, int max_chan)
+    {
+        int channels = std::min<int>(max_chan, fChannels);
+        int decoded = 0;
+        while (decoded < frames) {
+            sf_count_t nbf = fReader(fFile, fBuffer, std::min<int>(BUFFER_SIZE, frames - decoded));
+            for (int sample = 0; sample < nbf; sample++) {
+                for (int chan = 0; chan < channels; chan++) {
+                    buffers[chan][decoded + sample] = fBuffer[sample * fChannels + chan];
+                }
+            }
+            decoded += int(nbf);
+            if (nbf == 0) break;
+        }
+        return decoded;
+    }
+
+    bool seek(int frame)
+    {
+        return sf_seek(fFile, frame, SEEK_SET) >= 0;
+    }
+
+};
+
 struct LibsndfileReader : public SoundfileReader {
 	
     LibsndfileReader() {}
@@ -169,6 +221,20 @@ struct LibsndfileReader : public SoundfileReader {
         }
     }
 
+    // Open the file to decode it incrementally (resampled files cannot be streamed)
+    SoundfileDecoder* createDecoder(const std::string& path_name)
+    {
+        SF_INFO snd_info;
+        snd_info.format = 0;
+        SNDFILE* snd_file = sf_open(path_name.c_str(), SFM_READ, &snd_info);
+        if (!snd_file) return nullptr;
+        if (isResampling(snd_info.samplerate)) {
+            sf_close(snd_file);
+            return nullptr;
+        }
+        return new LibsndfileDecoder(snd_file, snd_info);
+    }
+
     // Open the file and returns its length and channels
     void getParamsFile(const std::string& path_name, int& channels, int& length)
     {
@@ -31,10 +31,13 @@
 
 #include "faust/gui/UI.h"
 #include "faust/gui/PathBuilder.h"
+#include "faust/gui/ParamIndex.h"
 
 /*******************************************************************************
  * MapUI : Faust User Interface
  * This class creates a map of complete hierarchical path and zones for each UI items.
+ * Parameters can also be accessed with their index (in path order), found once with
+ * getParamIndex, the index tables being built when the UI description is complete.
  ******************************************************************************/
 
 class MapUI : public UI, public PathBuilder
@@ -50,6 +53,37 @@ class MapUI : public UI, public PathBuilder
     
         std::string fNullStr = "";
     
+        // Index tables, in fPathZoneMap order
+        std::vector<FAUSTFLOAT*> fZones;
+        std::vector<const std::string*> fPaths;
+        ParamIndex fPathIndex;
+        ParamIndex fLabelIndex;
+    
+        void buildIndex()
+        {
+            fZones.clear();
+            fPaths.clear();
+            fPathIndex.clear();
+            fLabelIndex.clear();
+            std::map<FAUSTFLOAT*, int> zone_index;
+            for (auto& it : fPathZoneMap) {
+                zone_index[it.second] = int(fZones.size());
+                fPathIndex.add(it.first, int(fZones.size()));
+                fZones.push_back(it.second);
+                fPaths.push_back(&it.first);
+            }
+            for (auto& it : fLabelZoneMap) {
+                auto it1 = zone_index.find(it.second);
+                if (it1 != zone_index.end()) fLabelIndex.add(it.first, it1->second);
+            }
+        }
+    
+        // Rebuild the index tables if parameters have been added since the last build
+        void checkIndex()
+        {
+            if (fZones.size() != fPathZoneMap.size()) buildIndex();
+        }
+    
     public:
         
         MapUI() {}
@@ -71,6 +105,7 @@ class MapUI : public UI, public PathBuilder
         void closeBox()
         {
             popLabel();
+            if (fControlsLevel.size() == 0) buildIndex();
         }
         
         // -- active widgets
@@ -122,22 +157,27 @@ class MapUI : public UI, public PathBuilder
         // set/get
         void setParamValue(const std::string& path, FAUSTFLOAT value)
         {
-            if (fPathZoneMap.find(path) != fPathZoneMap.end()) {
-                *fPathZoneMap[path] = value;
-            } else if (fLabelZoneMap.find(path) != fLabelZoneMap.end()) {
-                *fLabelZoneMap[path] = value;
-            }
+            int index = getParamIndex(path);
+            if (index >= 0) *fZones[index] = value;
         }
         
         FAUSTFLOAT getParamValue(const std::string& path)
         {
-            if (fPathZoneMap.find(path) != fPathZoneMap.end()) {
-                return *fPathZoneMap[path];
-            } else if (fLabelZoneMap.find(path) != fLabelZoneMap.end()) {
-                return *fLabelZoneMap[path];
-            } else {
-                return FAUSTFLOAT(0);
-            }
+            int index = getParamIndex(path);
+            return (index >= 0) ? *fZones[index] : FAUSTFLOAT(0);
+        }
+    
+        // Index based set/get, 'index' being a valid index returned by getParamIndex
+        void setParamValue(int index, FAUSTFLOAT value) { *fZones[index] = value; }
+    
+        FAUSTFLOAT getParamValue(int index) { return *fZones[index]; }
+    
+        // Returns the index of a path or label, or -1
+        int getParamIndex(const std::string& path)
+        {
+            checkIndex();
+            int index = fPathIndex.find(path);
+            return (index >= 0) ? index : fLabelIndex.find(path);
         }
     
         // map access 
@@ -147,13 +187,8 @@ class MapUI : public UI, public PathBuilder
         
         const std::string& getParamAddress(int index)
         {
-            if (index < 0 || index > int(fPathZoneMap.size())) {
-                return fNullStr;
-            } else {
-                auto it = fPathZoneMap.begin();
-                while (index-- > 0 && it++ != fPathZoneMap.end()) {}
-                return it->first;
-            }
+            checkIndex();
+            return (index < 0 || index >= int(fPaths.size())) ? fNullStr : *fPaths[index];
         }
     
         const std::string& getParamAddress(FAUSTFLOAT* zone)
@@ -166,24 +201,14 @@ class MapUI : public UI, public PathBuilder
     
         FAUSTFLOAT* getParamZone(const std::string& str)
         {
-            if (fPathZoneMap.find(str) != fPathZoneMap.end()) {
-                return fPathZoneMap[str];
-            }
-            if (fLabelZoneMap.find(str) != fLabelZoneMap.end()) {
-                return fLabelZoneMap[str];
-            }
-            return nullptr;
+            int index = getParamIndex(str);
+            return (index >= 0) ? fZones[index] : nullptr;
         }
     
         FAUSTFLOAT* getParamZone(int index)
         {
-            if (index < 0 || index > int(fPathZoneMap.size())) {
-                return nullptr;
-            } else {
-                auto it = fPathZoneMap.begin();
-                while (index-- > 0 && it++ != fPathZoneMap.end()) {}
-                return it->second;
-            }
+            checkIndex();
+            return (index < 0 || index >= int(fZones.size())) ? nullptr : fZones[index];
         }
     
         static bool endsWith(const std::string& str, const std::string& end)
@@ -29,6 +29,7 @@
 #include <string>
 #include <utility>
 #include <cstdlib>
+#include <string.h>
 #include <cmath>
 
 #include "faust/dsp/dsp.h"
@@ -636,13 +637,58 @@ class uiMidiKeyPress : public uiMidiTimedItem, public uiConverter {
     
 };
 
+/**
+ * Items of a MIDI message type, indexed by message number (like the ctrl number) and channel
+ * (in [0..15]), so that an incoming message directly finds the matching items.
+ * Items receiving all channels (channel 0 in the item) are in the lists of the 16 channels.
+ */
+template <typename ITEM, int NUM = 128>
+class MidiTable {
+    
+    private:
+    
+        std::vector<std::vector<ITEM*> > fItems;
+        unsigned short fIndex[NUM][16];   // Index + 1 of the items list in fItems, 0 if no item
+    
+    public:
+    
+        MidiTable()
+        {
+            memset(fIndex, 0, sizeof(fIndex));
+        }
+    
+        // 'chan' in [1..16], or 0 for all channels
+        void add(int num, int chan, ITEM* item)
+        {
+            // Items with an out of range number or channel never receive messages
+            if (num < 0 || num >= NUM || chan < 0 || chan > 16) return;
+            for (int channel = 0; channel < 16; channel++) {
+                if (chan == 0 || channel == chan - 1) {
+                    if (fIndex[num][channel] == 0) {
+                        fItems.push_back(std::vector<ITEM*>());
+                        fIndex[num][channel] = (unsigned short)fItems.size();
+                    }
+                    fItems[fIndex[num][channel] - 1].push_back(item);
+                }
+            }
+        }
+    
+        // Items for a message number on a channel, or nullptr
+        const std::vector<ITEM*>* get(int num, int channel) const
+        {
+            if (num < 0 || num >= NUM || channel < 0 || channel >= 16 || fIndex[num][channel] == 0) return nullptr;
+            return &fItems[fIndex[num][channel] - 1];
+        }
+    
+};
+
 /******************************************************************************************
  * MidiUI : Faust User Interface
  * This class decodes MIDI metadata and maps incoming MIDI messages to them.
  * Currently ctrlChange, keyOn/keyOff, keyPress, progChange, chanPress, pitchWheel/pitchBend
  * start/stop/clock meta data are handled.
  *
- * Maps associating MIDI event ID (like each ctrl number) with all MIDI aware UI items
+ * Tables associating MIDI event ID (like each ctrl number) and channel with all MIDI aware UI items
  * are defined and progressively filled when decoding MIDI related metadata.
  * MIDI aware UI items are used in both directions:
  *  - modifying their internal state when receving MIDI input events
@@ -652,13 +698,13 @@ class uiMidiKeyPress : public uiMidiTimedItem, public uiConverter {
 class MidiUI : public GUI, public midi, public midi_interface, public MetaDataUI {
 
     // Add uiItem subclasses objects are deallocated by the inherited GUI class
-    typedef std::map <int, std::vector<uiMidiCtrlChange*> > TCtrlChangeTable;
-    typedef std::vector<uiMidiProgChange*>                  TProgChangeTable;
-    typedef std::vector<uiMidiChanPress*>                   TChanPressTable;
-    typedef std::map <int, std::vector<uiMidiKeyOn*> >      TKeyOnTable;
-    typedef std::map <int, std::vector<uiMidiKeyOff*> >     TKeyOffTable;
-    typedef std::map <int, std::vector<uiMidiKeyPress*> >   TKeyPressTable;
-    typedef std::vector<uiMidiPitchWheel*>                  TPitchWheelTable;
+    typedef MidiTable<uiMidiCtrlChange>    TCtrlChangeTable;
+    typedef MidiTable<uiMidiProgChange, 1> TProgChangeTable;
+    typedef MidiTable<uiMidiChanPress, 1>  TChanPressTable;
+    typedef MidiTable<uiMidiKeyOn>         TKeyOnTable;
+    typedef MidiTable<uiMidiKeyOff>        TKeyOffTable;
+    typedef MidiTable<uiMidiKeyPress>      TKeyPressTable;
+    typedef MidiTable<uiMidiPitchWheel, 1> TPitchWheelTable;
     
     protected:
     
@@ -689,37 +735,37 @@ class MidiUI : public GUI, public midi, public midi_interface, public MetaDataUI
                     unsigned chan;
                     if (fMetaAux[i].first == "midi") {
                         if (gsscanf(fMetaAux[i].second.c_str(), "ctrl %u %u", &num, &chan) == 2) {
-                            fCtrlChangeTable[num].push_back(new uiMidiCtrlChange(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
+                            fCtrlChangeTable.add(num, chan, new uiMidiCtrlChange(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "ctrl %u", &num) == 1) {
-                            fCtrlChangeTable[num].push_back(new uiMidiCtrlChange(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
+                            fCtrlChangeTable.add(num, 0, new uiMidiCtrlChange(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "keyon %u %u", &num, &chan) == 2) {
-                            fKeyOnTable[num].push_back(new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
+                            fKeyOnTable.add(num, chan, new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "keyon %u", &num) == 1) {
-                            fKeyOnTable[num].push_back(new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
+                            fKeyOnTable.add(num, 0, new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "keyoff %u %u", &num, &chan) == 2) {
-                            fKeyOffTable[num].push_back(new uiMidiKeyOff(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
+                            fKeyOffTable.add(num, chan, new uiMidiKeyOff(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "keyoff %u", &num) == 1) {
-                            fKeyOffTable[num].push_back(new uiMidiKeyOff(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
+                            fKeyOffTable.add(num, 0, new uiMidiKeyOff(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "key %u %u", &num, &chan) == 2) {
-                            fKeyTable[num].push_back(new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
+                            fKeyTable.add(num, chan, new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "key %u", &num) == 1) {
-                            fKeyTable[num].push_back(new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
+                            fKeyTable.add(num, 0, new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "keypress %u %u", &num, &chan) == 2) {
-                            fKeyPressTable[num].push_back(new uiMidiKeyPress(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
+                            fKeyPressTable.add(num, chan, new uiMidiKeyPress(fMidiHandler, num, this, zone, min, max, input, getScale(zone), chan));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "keypress %u", &num) == 1) {
-                            fKeyPressTable[num].push_back(new uiMidiKeyPress(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
+                            fKeyPressTable.add(num, 0, new uiMidiKeyPress(fMidiHandler, num, this, zone, min, max, input, getScale(zone)));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "pgm %u", &chan) == 1) {
-                            fProgChangeTable.push_back(new uiMidiProgChange(fMidiHandler, this, zone, min, max, input, chan));
+                            fProgChangeTable.add(0, chan, new uiMidiProgChange(fMidiHandler, this, zone, min, max, input, chan));
                         } else if (strcmp(fMetaAux[i].second.c_str(), "pgm") == 0) {
-                            fProgChangeTable.push_back(new uiMidiProgChange(fMidiHandler, this, zone, min, max, input));
+                            fProgChangeTable.add(0, 0, new uiMidiProgChange(fMidiHandler, this, zone, min, max, input));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "chanpress %u", &chan) == 1) {
-                            fChanPressTable.push_back(new uiMidiChanPress(fMidiHandler, this, zone, min, max, input, getScale(zone), chan));
+                            fChanPressTable.add(0, chan, new uiMidiChanPress(fMidiHandler, this, zone, min, max, input, getScale(zone), chan));
                         } else if ((fMetaAux[i].second == "chanpress")) {
-                            fChanPressTable.push_back(new uiMidiChanPress(fMidiHandler, this, zone, min, max, input, getScale(zone)));
+                            fChanPressTable.add(0, 0, new uiMidiChanPress(fMidiHandler, this, zone, min, max, input, getScale(zone)));
                         } else if ((gsscanf(fMetaAux[i].second.c_str(), "pitchwheel %u", &chan) == 1) || (gsscanf(fMetaAux[i].second.c_str(), "pitchbend %u", &chan) == 1)) {
-                            fPitchWheelTable.push_back(new uiMidiPitchWheel(fMidiHandler, this, zone, min, max, input, chan));
+                            fPitchWheelTable.add(0, chan, new uiMidiPitchWheel(fMidiHandler, this, zone, min, max, input, chan));
                         } else if ((fMetaAux[i].second == "pitchwheel") || (fMetaAux[i].second == "pitchbend")) {
-                            fPitchWheelTable.push_back(new uiMidiPitchWheel(fMidiHandler, this, zone, min, max, input));
+                            fPitchWheelTable.add(0, 0, new uiMidiPitchWheel(fMidiHandler, this, zone, min, max, input));
                         // MIDI sync
                         } else if (fMetaAux[i].second == "start") {
                             fStartTable.push_back(new uiMidiStart(fMidiHandler, this, zone, input));
@@ -740,32 +786,19 @@ class MidiUI : public GUI, public midi, public midi_interface, public MetaDataUI
         template <typename TABLE>
         void updateTable1(TABLE& table, double date, int channel, int val1)
         {
-            for (size_t i = 0; i < table.size(); i++) {
-                int channel_aux = table[i]->fChan;
-                // channel_aux == 0 means "all channels"
-                if (channel_aux == 0 || channel == channel_aux - 1) {
-                    if (fTimeStamp) {
-                        table[i]->modifyZone(date, FAUSTFLOAT(val1));
-                    } else {
-                        table[i]->modifyZone(FAUSTFLOAT(val1));
-                    }
-                }
-            }
+            updateTable2<TABLE>(table, date, channel, 0, val1);
         }
         
         template <typename TABLE>
         void updateTable2(TABLE& table, double date, int channel, int val1, int val2)
         {
-            if (table.find(val1) != table.end()) {
-                for (size_t i = 0; i < table[val1].size(); i++) {
-                    int channel_aux = table[val1][i]->fChan;
-                    // channel_aux == 0 means "all channels"
-                    if (channel_aux == 0 || channel == channel_aux - 1) {
-                        if (fTimeStamp) {
-                            table[val1][i]->modifyZone(date, FAUSTFLOAT(val2));
-                        } else {
-                            table[val1][i]->modifyZone(FAUSTFLOAT(val2));
-                        }
+            auto items = table.get(val1, channel);
+            if (items) {
+                for (auto& it : *items) {
+                    if (fTimeStamp) {
+                        it->modifyZone(date, FAUSTFLOAT(val2));
+                    } else {
+                        it->modifyZone(FAUSTFLOAT(val2));
                     }
                 }
             }
@@ -868,11 +901,10 @@ class MidiUI : public GUI, public midi, public midi_interface, public MetaDataUI
         void rpn(double date, int channel, int ctrl, int value)
         {
             if (ctrl == midi::PITCH_BEND_RANGE) {
-                for (size_t i = 0; i < fPitchWheelTable.size(); i++) {
-                    // channel_aux == 0 means "all channels"
-                    int channel_aux = fPitchWheelTable[i]->fChan;
-                    if (channel_aux == 0 || channel == channel_aux - 1) {
-                        fPitchWheelTable[i]->setRange(value);
+                auto items = fPitchWheelTable.get(0, channel);
+                if (items) {
+                    for (auto& it : *items) {
+                        it->setRange(value);
                     }
                 }
             }
@@ -0,0 +1,141 @@
+/************************** BEGIN ParallelReader.h **************************/
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __ParallelReader__
+#define __ParallelReader__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "faust/gui/Soundfile.h"
+
+/*
+ Statistics of the last soundfile loaded by a ParallelReader.
+*/
+
+struct SoundfileLoadStats {
+
+    int fParts;         // number of read parts
+    int fThreads;       // number of threads used to read them
+    long fFrames;       // number of read frames (resampled if needed)
+    double fTime;       // duration of the load, in seconds
+    double fPartsTime;  // sum of the read duration of each part, in seconds
+    double fMaxPartTime;// read duration of the longest part, in seconds
+
+    SoundfileLoadStats():fParts(0), fThreads(0), fFrames(0), fTime(0), fPartsTime(0), fMaxPartTime(0) {}
+
+    void print(std::ostream& out) const
+    {
+        out << "Soundfile : " << fParts << " parts, " << fFrames << " frames read in " << (fTime * 1e3) << " ms with "
+            << fThreads << " threads (parts " << (fPartsTime * 1e3) << " ms, longest part " << (fMaxPartTime * 1e3) << " ms)" << std::endl;
+    }
+
+};
+
+/*
+ A soundfile reader which reads (and possibly resamples) the parts of a soundfile concurrently,
+ using the 'READER' reader, which has to be able to read several files at the same time (like LibsndfileReader).
+
+ Each part is directly written at its offset in the soundfile buffers, computed before reading from the lengths
+ given by the reader. Worker threads take the next part to read until all parts are read.
+
+ SoundUI uses a ParallelReader<LibsndfileReader> as its default reader when PARALLEL_READER is defined,
+ otherwise a ParallelReader can be given to its constructor.
+*/
+
+template <typename READER>
+struct ParallelReader : public READER {
+
+    int fThreads;
+    SoundfileLoadStats fLoadStats;
+
+    /**
+     * Create the reader.
+     *
+     * @param threads - the maximum number of threads, 0 (the default) to use the hardware concurrency, 1 to read sequentially
+     */
+    ParallelReader(int threads = 0):fThreads(threads) {}
+
+    void setThreads(int threads) { fThreads = threads; }
+
+    // Statistics of the last loaded soundfile
+    const SoundfileLoadStats& getLoadStats() { return fLoadStats; }
+
+    void readFiles(Soundfile* soundfile, const std::vector<std::string>& path_name_list, const std::vector<int>& offsets, int max_chan)
+    {
+        typedef std::chrono::steady_clock clock;
+        int parts = int(path_name_list.size());
+        int threads = (fThreads > 0) ? fThreads : int(std::max<unsigned>(1, std::thread::hardware_concurrency()));
+        threads = std::max<int>(1, std::min<int>(threads, parts));
+
+        std::vector<int> frames(parts, 0);
+        std::vector<double> times(parts, 0.);
+        std::atomic<int> next_part(0);
+        std::atomic<bool> failure(false);
+        clock::time_point start = clock::now();
+
+        auto worker = [&]() {
+            for (int part = next_part++; part < parts && !failure; part = next_part++) {
+                clock::time_point part_start = clock::now();
+                try {
+                    frames[part] = this->readPart(soundfile, path_name_list, offsets, part, max_chan);
+                } catch (...) {
+                    failure = true;
+                }
+                times[part] = std::chrono::duration<double>(clock::now() - part_start).count();
+            }
+        };
+
+        // The calling thread is one of the workers
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; i++) {
+            workers.push_back(std::thread(worker));
+        }
+        worker();
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].join();
+        }
+
+        fLoadStats = SoundfileLoadStats();
+        fLoadStats.fParts = parts;
+        fLoadStats.fThreads = threads;
+        fLoadStats.fTime = std::chrono::duration<double>(clock::now() - start).count();
+        for (int part = 0; part < parts; part++) {
+            fLoadStats.fFrames += frames[part];
+            fLoadStats.fPartsTime += times[part];
+            fLoadStats.fMaxPartTime = std::max<double>(fLoadStats.fMaxPartTime, times[part]);
+        }
+
+        // Reported as in READER::readFile
+        if (failure) throw -1;
+    }
+
+};
+
+#endif
+/**************************  END  ParallelReader.h **************************/
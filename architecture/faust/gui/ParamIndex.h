@@ -0,0 +1,145 @@
+/************************** BEGIN ParamIndex.h **************************/
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef FAUST_PARAMINDEX_H
+#define FAUST_PARAMINDEX_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * ParamIndex : Faust User Interface
+ * Flat hash table from parameter paths (or labels) to parameter indexes,
+ * filled when the UI is built, then used to find parameters without memory
+ * allocation: open addressing with linear probing, load factor below 1/2.
+ ******************************************************************************/
+
+class ParamIndex
+{
+
+    private:
+
+        struct Entry {
+            std::string fKey;
+            uint32_t fHash;
+            int fIndex;
+
+            Entry(const std::string& key, uint32_t hash, int index):fKey(key), fHash(hash), fIndex(index) {}
+        };
+
+        std::vector<Entry> fEntries;
+        std::vector<int> fSlots;    // Entry number or -1
+        uint32_t fMask;
+
+        // FNV-1a
+        static uint32_t hash(const char* key, size_t size)
+        {
+            uint32_t res = 2166136261u;
+            for (size_t i = 0; i < size; i++) {
+                res = (res ^ uint8_t(key[i])) * 16777619u;
+            }
+            return res;
+        }
+
+        int findEntry(const char* key, size_t size, uint32_t hash) const
+        {
+            if (fSlots.size() == 0) return -1;
+            for (uint32_t slot = hash & fMask; fSlots[slot] >= 0; slot = (slot + 1) & fMask) {
+                const Entry& entry = fEntries[fSlots[slot]];
+                if (entry.fHash == hash
+                    && entry.fKey.size() == size
+                    && memcmp(entry.fKey.data(), key, size) == 0) {
+                    return fSlots[slot];
+                }
+            }
+            return -1;
+        }
+
+        void insertSlot(int entry)
+        {
+            uint32_t slot = fEntries[entry].fHash & fMask;
+            while (fSlots[slot] >= 0) slot = (slot + 1) & fMask;
+            fSlots[slot] = entry;
+        }
+
+        void grow()
+        {
+            fSlots.assign(std::max<size_t>(16, fSlots.size() * 2), -1);
+            fMask = uint32_t(fSlots.size() - 1);
+            for (size_t entry = 0; entry < fEntries.size(); entry++) {
+                insertSlot(int(entry));
+            }
+        }
+
+    public:
+
+        ParamIndex():fMask(0) {}
+
+        // Associate 'key' to 'index', replacing the previous index of 'key' if any
+        void add(const std::string& key, int index)
+        {
+            uint32_t key_hash = hash(key.data(), key.size());
+            int entry = findEntry(key.data(), key.size(), key_hash);
+            if (entry >= 0) {
+                fEntries[entry].fIndex = index;
+                return;
+            }
+            fEntries.push_back(Entry(key, key_hash, index));
+            if (fEntries.size() * 2 > fSlots.size()) {
+                grow();
+            } else {
+                insertSlot(int(fEntries.size() - 1));
+            }
+        }
+
+        // Returns the index associated to 'key', or -1
+        int find(const char* key) const
+        {
+            size_t size = strlen(key);
+            int entry = findEntry(key, size, hash(key, size));
+            return (entry >= 0) ? fEntries[entry].fIndex : -1;
+        }
+
+        int find(const std::string& key) const
+        {
+            int entry = findEntry(key.data(), key.size(), hash(key.data(), key.size()));
+            return (entry >= 0) ? fEntries[entry].fIndex : -1;
+        }
+
+        size_t size() const { return fEntries.size(); }
+
+        void clear()
+        {
+            fEntries.clear();
+            fSlots.clear();
+            fMask = 0;
+        }
+
+};
+
+#endif  // FAUST_PARAMINDEX_H
+/**************************  END  ParamIndex.h **************************/
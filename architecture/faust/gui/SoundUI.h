@@ -39,6 +39,7 @@
 
 // Always included otherwise -i mode later on will not always include it (with the conditional includes)
 #include "faust/gui/Soundfile.h"
+#include "faust/gui/SoundfileStore.h"
 
 #if defined(JUCE_32BIT) || defined(JUCE_64BIT)
 #include "faust/gui/JuceReader.h"
@@ -54,8 +55,14 @@ static WaveReader gReader;
 static MemoryReader gReader;
 #else
 #include "faust/gui/LibsndfileReader.h"
+#ifdef PARALLEL_READER
+#include "faust/gui/ParallelReader.h"
+// Parts are read and resampled concurrently
+static ParallelReader<LibsndfileReader> gReader;
+#else
 static LibsndfileReader gReader;
 #endif
+#endif
 
 // To be used by DSP code if no SoundUI is used
 static std::vector<std::string> path_name_list;
@@ -67,7 +74,7 @@ class SoundUI : public SoundUIInterface
     protected:
     
         std::vector<std::string> fSoundfileDir;             // The soundfile directories
-        std::map<std::string, Soundfile*> fSoundfileMap;    // Map to share loaded soundfiles
+        std::map<std::string, Soundfile*> fSoundfileMap;    // Map to share loaded soundfiles (acquired in the SoundfileStore)
         SoundfileReader* fSoundReader;
 
      public:
@@ -106,14 +113,14 @@ class SoundUI : public SoundUIInterface
     
         virtual ~SoundUI()
         {   
-            // Delete all soundfiles
+            // Release all soundfiles, deleted by the store when not used by another SoundUI
             for (auto& it : fSoundfileMap) {
-                delete it.second;
+                SoundfileStore::getStore().release(it.second);
             }
         }
 
-        // -- soundfiles
-        virtual void addSoundfile(const char* label, const char* url, Soundfile** sf_zone)
+        // Parse the possible list of files of 'url', check them and return their complete path
+        std::vector<std::string> getPathNameList(const char* url)
         {
             const char* saved_url = url; // 'url' is consumed by parseMenuList2
             std::vector<std::string> file_name_list;
@@ -122,12 +129,19 @@ class SoundUI : public SoundUIInterface
             // If not a list, we have as single file
             if (!menu) { file_name_list.push_back(saved_url); }
             
-            // Parse the possible list
+            return fSoundReader->checkFiles(fSoundfileDir, file_name_list);
+        }
+
+        // -- soundfiles
+        virtual void addSoundfile(const char* label, const char* url, Soundfile** sf_zone)
+        {
+            const char* saved_url = url;
+            
             if (fSoundfileMap.find(saved_url) == fSoundfileMap.end()) {
                 // Check all files and get their complete path
-                std::vector<std::string> path_name_list = fSoundReader->checkFiles(fSoundfileDir, file_name_list);
-                // Read them and create the Soundfile
-                Soundfile* sound_file = fSoundReader->createSoundfile(path_name_list, MAX_CHAN);
+                std::vector<std::string> path_name_list = getPathNameList(url);
+                // Get the Soundfile already loaded by another SoundUI, from the cache file, or read them and create it
+                Soundfile* sound_file = SoundfileStore::getStore().acquire(fSoundReader, path_name_list, MAX_CHAN);
                 if (sound_file) {
                     fSoundfileMap[saved_url] = sound_file;
                 } else {
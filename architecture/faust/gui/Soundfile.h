@@ -93,6 +93,41 @@ struct Soundfile {
 
 } POST_PACKED_STRUCTURE;
 
+/*
+ Incremental decoder of one sound resource, to stream soundfiles (see SoundfileStreamer.h).
+ */
+
+struct SoundfileDecoder {
+
+    int fChannels;  // number of channels of the sound resource
+    int fLength;    // length in frames
+    int fSR;        // sample rate
+
+    SoundfileDecoder():fChannels(0), fLength(0), fSR(SAMPLE_RATE) {}
+    virtual ~SoundfileDecoder() {}
+
+    /**
+     * Decode the next frames of the sound resource.
+     *
+     * @param buffers - the channel buffers to fill, at the frame to decode
+     * @param frames - the maximum number of frames to decode
+     * @param max_chan - the maximum number of mono channels to fill
+     *
+     * @return the number of decoded frames, 0 at the end of the sound resource.
+     */
+    virtual int decode(FAUSTFLOAT** buffers, int frames, int max_chan) = 0;
+
+    /**
+     * Move the decoding position.
+     *
+     * @param frame - the next frame to decode
+     *
+     * @return true if the position could be moved, false otherwise.
+     */
+    virtual bool seek(int frame) = 0;
+
+};
+
 /*
  The generic soundfile reader.
  */
@@ -148,6 +183,34 @@ class SoundfileReader {
     }
     
     bool isResampling(int sample_rate) { return (fDriverSR > 0 && fDriverSR != sample_rate); }
+    
+    // Read one part at its offset (computed from the lengths given by getParamsFile), returns the number of frames
+    int readPart(Soundfile* soundfile, const std::vector<std::string>& path_name_list, const std::vector<int>& offsets, int part, int max_chan)
+    {
+        int offset = offsets[part];
+        if (path_name_list[part] == "__empty_sound__") {
+            emptyFile(soundfile, part, offset);
+        } else {
+            readFile(soundfile, path_name_list[part], part, offset, max_chan);
+        }
+        return offset - offsets[part];
+    }
+    
+    /**
+     * Read all parts, each one at its offset, so that they can be read in any order or concurrently (see ParallelReader.h).
+     *
+     * @param soundfile - the soundfile to be filled
+     * @param path_name_list - the complete path of each part
+     * @param offsets - the offset of each part in the soundfile buffers
+     * @param max_chan - the maximum number of mono channels to fill
+     *
+     */
+    virtual void readFiles(Soundfile* soundfile, const std::vector<std::string>& path_name_list, const std::vector<int>& offsets, int max_chan)
+    {
+        for (int part = 0; part < int(path_name_list.size()); part++) {
+            readPart(soundfile, path_name_list, offsets, part, max_chan);
+        }
+    }
  
     // To be implemented by subclasses
 
@@ -219,17 +282,29 @@ class SoundfileReader {
 
   public:
     
+    SoundfileReader():fDriverSR(-1) {}
     virtual ~SoundfileReader() {}
     
     void setSampleRate(int sample_rate) { fDriverSR = sample_rate; }
+    int getSampleRate() { return fDriverSR; }
+
+    /**
+     * Create an incremental decoder of a sound resource, to be implemented by subclasses which can stream soundfiles.
+     *
+     * @param path_name - the name of the file, or sound resource identified this way
+     *
+     * @return the decoder, or nullptr if the sound resource cannot be streamed.
+     */
+    virtual SoundfileDecoder* createDecoder(const std::string& path_name) { return nullptr; }
    
     Soundfile* createSoundfile(const std::vector<std::string>& path_name_list, int max_chan)
     {
         try {
             int cur_chan = 1; // At least one channel
             int total_length = 0;
+            std::vector<int> offsets;
             
-            // Compute total length and channels max of all files
+            // Compute total length and channels max of all files, and the offset of each part
             for (int i = 0; i < int(path_name_list.size()); i++) {
                 int chan, length;
                 if (path_name_list[i] == "__empty_sound__") {
@@ -239,8 +314,12 @@ class SoundfileReader {
                     getParamsFile(path_name_list[i], chan, length);
                 }
                 cur_chan = std::max<int>(cur_chan, chan);
+                offsets.push_back(total_length);
                 total_length += length;
             }
+            
+            // Init offset of the empty parts
+            int offset = total_length;
            
             // Complete with empty parts
             total_length += (MAX_SOUNDFILE_PARTS - path_name_list.size()) * BUFFER_SIZE;
@@ -248,17 +327,8 @@ class SoundfileReader {
             // Create the soundfile
             Soundfile* soundfile = createSoundfile(cur_chan, total_length, max_chan);
             
-            // Init offset
-            int offset = 0;
-            
             // Read all files
-            for (int i = 0; i < int(path_name_list.size()); i++) {
-                if (path_name_list[i] == "__empty_sound__") {
-                    emptyFile(soundfile, i, offset);
-                } else {
-                    readFile(soundfile, path_name_list[i], i, offset, max_chan);
-                }
-            }
+            readFiles(soundfile, path_name_list, offsets, max_chan);
             
             // Complete with empty parts
             for (int i = int(path_name_list.size()); i < MAX_SOUNDFILE_PARTS; i++) {
@@ -0,0 +1,359 @@
+/************************** BEGIN SoundfileStore.h **************************/
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __SoundfileStore__
+#define __SoundfileStore__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "faust/gui/Soundfile.h"
+
+/*
+ Process wide store of soundfiles, shared by all SoundUI (and so all DSP instances) loading
+ the same list of sound resources with the same reader sample rate.
+
+ Soundfiles are reference counted: 'acquire' returns the already loaded soundfile, or loads it,
+ and 'release' deletes it when it is not used anymore.
+
+ When a cache directory is set (with 'setCacheDirectory'), loaded soundfiles are also written
+ there in a pre-decoded (and possibly resampled) cache file, to be directly memory-mapped
+ by the next loads, including by other processes, which then share the same pages,
+ only read when accessed. Cache files are identified by the sound resources names, size and
+ modification date, the reader sample rate, the number of channels and the sample type.
+ The cache is only available on POSIX systems.
+*/
+
+#define SOUNDFILE_CACHE_MAGIC "FAUSTSND"
+#define SOUNDFILE_CACHE_VERSION 1
+
+class SoundfileStore {
+
+    private:
+
+        // Cache file header, followed by the key, then the channels samples at a 64 bytes aligned offset
+        struct CacheHeader {
+            char fMagic[8];
+            uint32_t fVersion;
+            uint32_t fSampleSize;
+            int32_t fChannels;
+            int32_t fTotalLength;
+            int32_t fLength[MAX_SOUNDFILE_PARTS];
+            int32_t fSR[MAX_SOUNDFILE_PARTS];
+            int32_t fOffset[MAX_SOUNDFILE_PARTS];
+            uint32_t fKeySize;
+            uint32_t fDataOffset;
+        };
+
+        // Soundfile whose channels are in a memory-mapped cache file
+        struct MappedSoundfile : public Soundfile {
+
+            void* fMap;
+            size_t fMapSize;
+
+            MappedSoundfile():fMap(nullptr), fMapSize(0) {}
+
+            ~MappedSoundfile()
+            {
+            #ifndef _WIN32
+                if (fMap) munmap(fMap, fMapSize);
+            #endif
+                // Channels are not allocated: only the buffers table will be deleted by the Soundfile destructor
+                fChannels = 0;
+            }
+
+        };
+
+        struct Entry {
+            Soundfile* fSoundfile;
+            MappedSoundfile* fMapped;   // Same as fSoundfile when memory-mapped, so that the right destructor is called
+            int fRefCount;
+        };
+
+        std::map<std::string, Entry> fEntries;
+        std::map<Soundfile*, std::string> fKeys;
+        std::string fCacheDirectory;
+        std::mutex fMutex;
+
+        SoundfileStore() {}
+
+        static uint64_t hash(const std::string& str)
+        {
+            // FNV-1a
+            uint64_t res = 14695981039346656037ULL;
+            for (size_t i = 0; i < str.size(); i++) {
+                res = (res ^ uint8_t(str[i])) * 1099511628211ULL;
+            }
+            return res;
+        }
+
+        static std::string makeKey(SoundfileReader* reader, const std::vector<std::string>& path_name_list, int max_chan)
+        {
+            std::stringstream key;
+            key << "sr " << reader->getSampleRate() << " chan " << max_chan << " sample " << sizeof(FAUSTFLOAT);
+            for (size_t i = 0; i < path_name_list.size(); i++) {
+                key << "\n" << path_name_list[i];
+            #ifndef _WIN32
+                struct stat info;
+                if (stat(path_name_list[i].c_str(), &info) == 0) {
+                    key << " " << info.st_size << " " << info.st_mtime;
+                }
+            #endif
+            }
+            return key.str();
+        }
+
+        std::string cachePath(const std::string& key)
+        {
+            std::stringstream path;
+            path << fCacheDirectory << "/faust-soundfile-" << std::hex << hash(key) << ".cache";
+            return path.str();
+        }
+
+        static int totalLength(Soundfile* soundfile)
+        {
+            return soundfile->fOffset[MAX_SOUNDFILE_PARTS - 1] + soundfile->fLength[MAX_SOUNDFILE_PARTS - 1];
+        }
+
+        // Whether the cache file content (of 'size' bytes) is a soundfile for 'key', with all parts and channels inside the file
+        bool checkCache(const CacheHeader* header, const std::string& key, size_t size)
+        {
+            if (memcmp(header->fMagic, SOUNDFILE_CACHE_MAGIC, 8) != 0
+                || header->fVersion != SOUNDFILE_CACHE_VERSION
+                || header->fSampleSize != sizeof(FAUSTFLOAT)
+                || header->fChannels <= 0
+                || header->fTotalLength < 0
+                || header->fKeySize != key.size()
+                || sizeof(CacheHeader) + header->fKeySize > size
+                || memcmp(reinterpret_cast<const char*>(header) + sizeof(CacheHeader), key.data(), key.size()) != 0
+                || header->fDataOffset < sizeof(CacheHeader) + header->fKeySize
+                || header->fDataOffset % sizeof(FAUSTFLOAT) != 0
+                || header->fDataOffset + size_t(header->fChannels) * size_t(header->fTotalLength) * sizeof(FAUSTFLOAT) != size) {
+                return false;
+            }
+            for (int part = 0; part < MAX_SOUNDFILE_PARTS; part++) {
+                if (header->fLength[part] < 0
+                    || header->fOffset[part] < 0
+                    || int64_t(header->fOffset[part]) + int64_t(header->fLength[part]) > int64_t(header->fTotalLength)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        MappedSoundfile* mapCache(const std::string& key, int max_chan)
+        {
+        #ifndef _WIN32
+            int fd = open(cachePath(key).c_str(), O_RDONLY);
+            if (fd < 0) return nullptr;
+            struct stat info;
+            void* map = MAP_FAILED;
+            if (fstat(fd, &info) == 0 && size_t(info.st_size) >= sizeof(CacheHeader)) {
+                map = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            }
+            close(fd);
+            if (map == MAP_FAILED) return nullptr;
+
+            // Check the cache file content, the soundfile is decoded again if anything is wrong
+            const CacheHeader* header = static_cast<const CacheHeader*>(map);
+            size_t size = info.st_size;
+            if (!checkCache(header, key, size)) {
+                munmap(map, size);
+                return nullptr;
+            }
+
+            MappedSoundfile* soundfile = new MappedSoundfile();
+            soundfile->fMap = map;
+            soundfile->fMapSize = size;
+            for (int part = 0; part < MAX_SOUNDFILE_PARTS; part++) {
+                soundfile->fLength[part] = header->fLength[part];
+                soundfile->fSR[part] = header->fSR[part];
+                soundfile->fOffset[part] = header->fOffset[part];
+            }
+            // Pages are read-only: the DSP only reads soundfiles
+            FAUSTFLOAT* data = reinterpret_cast<FAUSTFLOAT*>(static_cast<char*>(map) + header->fDataOffset);
+            soundfile->fBuffers = new FAUSTFLOAT*[max_chan];
+            for (int chan = 0; chan < max_chan; chan++) {
+                soundfile->fBuffers[chan] = data + size_t(chan % header->fChannels) * header->fTotalLength;
+            }
+            soundfile->fChannels = header->fChannels;
+            return soundfile;
+        #else
+            return nullptr;
+        #endif
+        }
+
+        // Write the cache file in a temporary file, then rename it, so that concurrent processes always see a complete file
+        void writeCache(const std::string& key, Soundfile* soundfile)
+        {
+        #ifndef _WIN32
+            CacheHeader header;
+            memset(&header, 0, sizeof(CacheHeader));
+            memcpy(header.fMagic, SOUNDFILE_CACHE_MAGIC, 8);
+            header.fVersion = SOUNDFILE_CACHE_VERSION;
+            header.fSampleSize = sizeof(FAUSTFLOAT);
+            header.fChannels = soundfile->fChannels;
+            header.fTotalLength = totalLength(soundfile);
+            for (int part = 0; part < MAX_SOUNDFILE_PARTS; part++) {
+                header.fLength[part] = soundfile->fLength[part];
+                header.fSR[part] = soundfile->fSR[part];
+                header.fOffset[part] = soundfile->fOffset[part];
+            }
+            header.fKeySize = uint32_t(key.size());
+            header.fDataOffset = uint32_t(((sizeof(CacheHeader) + key.size()) + 63) & ~size_t(63));
+
+            std::string path = cachePath(key);
+            std::stringstream tmp_path;
+            tmp_path << path << "." << getpid() << ".tmp";
+            FILE* file = fopen(tmp_path.str().c_str(), "wb");
+            if (!file) {
+                std::cerr << "SoundfileStore : cannot write cache file " << tmp_path.str() << std::endl;
+                return;
+            }
+            std::vector<char> padding(header.fDataOffset - sizeof(CacheHeader) - key.size(), 0);
+            bool res = fwrite(&header, sizeof(CacheHeader), 1, file) == 1
+                && fwrite(key.data(), 1, key.size(), file) == key.size()
+                && fwrite(padding.data(), 1, padding.size(), file) == padding.size();
+            for (int chan = 0; res && chan < soundfile->fChannels; chan++) {
+                res = fwrite(soundfile->fBuffers[chan], sizeof(FAUSTFLOAT), header.fTotalLength, file) == size_t(header.fTotalLength);
+            }
+            res = (fclose(file) == 0) && res;
+            if (!res || rename(tmp_path.str().c_str(), path.c_str()) != 0) {
+                std::cerr << "SoundfileStore : cannot write cache file " << path << std::endl;
+                remove(tmp_path.str().c_str());
+            }
+        #endif
+        }
+
+    public:
+
+        static SoundfileStore& getStore()
+        {
+            static SoundfileStore store;
+            return store;
+        }
+
+        /**
+         * Set the directory of the pre-decoded cache files.
+         *
+         * @param directory - an existing directory, or an empty string to not use cache files (the default)
+         */
+        void setCacheDirectory(const std::string& directory)
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fCacheDirectory = directory;
+        }
+
+        /**
+         * Get a soundfile: the already loaded one, the memory-mapped cache file, or one read by the reader.
+         *
+         * @param reader - the reader to use to read the sound resources, with its sample rate set
+         * @param path_name_list - the complete path of each part (as returned by SoundfileReader::checkFiles)
+         * @param max_chan - the number of channels of the soundfile
+         *
+         * @return the soundfile, or nullptr if it cannot be read.
+         */
+        Soundfile* acquire(SoundfileReader* reader, const std::vector<std::string>& path_name_list, int max_chan)
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            std::string key = makeKey(reader, path_name_list, max_chan);
+
+            std::map<std::string, Entry>::iterator it = fEntries.find(key);
+            if (it != fEntries.end()) {
+                (*it).second.fRefCount++;
+                return (*it).second.fSoundfile;
+            }
+
+            Entry entry = { nullptr, nullptr, 1 };
+            if (fCacheDirectory != "") {
+                entry.fMapped = mapCache(key, max_chan);
+                entry.fSoundfile = entry.fMapped;
+            }
+            if (!entry.fSoundfile) {
+                entry.fSoundfile = reader->createSoundfile(path_name_list, max_chan);
+                if (!entry.fSoundfile) return nullptr;
+                if (fCacheDirectory != "") writeCache(key, entry.fSoundfile);
+            }
+
+            fEntries[key] = entry;
+            fKeys[entry.fSoundfile] = key;
+            return entry.fSoundfile;
+        }
+
+        /**
+         * Release a soundfile returned by 'acquire', deleted when not used anymore.
+         *
+         * @param soundfile - the soundfile
+         */
+        void release(Soundfile* soundfile)
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            std::map<Soundfile*, std::string>::iterator it = fKeys.find(soundfile);
+            if (it == fKeys.end()) return;
+            Entry& entry = fEntries[(*it).second];
+            if (--entry.fRefCount == 0) {
+                if (entry.fMapped) {
+                    delete entry.fMapped;
+                } else {
+                    delete entry.fSoundfile;
+                }
+                fEntries.erase((*it).second);
+                fKeys.erase(it);
+            }
+        }
+
+        // Number of users of a soundfile (0 if not in the store)
+        int getRefCount(Soundfile* soundfile)
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            std::map<Soundfile*, std::string>::iterator it = fKeys.find(soundfile);
+            return (it == fKeys.end()) ? 0 : fEntries[(*it).second].fRefCount;
+        }
+
+        // Whether a soundfile is memory-mapped from a cache file
+        bool isMapped(Soundfile* soundfile)
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            std::map<Soundfile*, std::string>::iterator it = fKeys.find(soundfile);
+            return (it != fKeys.end()) && fEntries[(*it).second].fMapped;
+        }
+
+};
+
+#endif
+/**************************  END  SoundfileStore.h **************************/
@@ -0,0 +1,432 @@
+/************************** BEGIN SoundfileStreamer.h **************************/
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __SoundfileStreamer__
+#define __SoundfileStreamer__
+
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "faust/gui/Soundfile.h"
+#include "faust/gui/SoundUI.h"
+
+/*
+ Streaming mode for long soundfiles (like backing tracks): instead of decoding all parts when loaded,
+ a background I/O thread decodes each part (with SoundfileReader::createDecoder) ahead of its read position,
+ and gives back the memory of the frames far enough behind it.
+
+ The DSP code directly indexes the soundfile buffers, so they keep the complete soundfile layout:
+ each channel is a virtual memory reservation of the total length (pages are only allocated when decoded,
+ and released pages read as silence). The read position of each part is given by the host with 'advance'
+ (typically after each 'compute') or 'setReadPosition' (to seek or loop), from the audio thread without locking.
+ Reading frames not yet decoded is counted as an underrun (and gives silence).
+ Memory is only given back on POSIX systems.
+*/
+
+class StreamingSoundfile : public Soundfile {
+
+    friend class SoundfileStreamer;
+
+    private:
+
+        struct Part {
+            SoundfileDecoder* fDecoder;     // nullptr for empty parts
+            std::atomic<int> fStart;        // First decoded frame (relative to the part), written by the I/O thread
+            std::atomic<int> fEnd;          // End of the decoded frames, written by the I/O thread
+            std::atomic<int> fReadPos;      // Read position, written by the audio thread
+
+            Part():fDecoder(nullptr), fStart(0), fEnd(0), fReadPos(0) {}
+        };
+
+        Part fParts[MAX_SOUNDFILE_PARTS];
+        int fUsedChannels;      // Channels to decode
+        size_t fBufferSize;     // Size in bytes of each channel buffer
+        std::atomic<int> fUnderruns;
+
+        StreamingSoundfile():fUsedChannels(0), fBufferSize(0), fUnderruns(0) {}
+
+        void allocate(int cur_chan, int total_length, int max_chan)
+        {
+            fBuffers = new FAUSTFLOAT*[max_chan];
+            fBufferSize = sizeof(FAUSTFLOAT) * size_t(total_length);
+            for (int chan = 0; chan < cur_chan; chan++) {
+            #ifndef _WIN32
+                void* buffer = mmap(nullptr, fBufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+                if (buffer == MAP_FAILED) throw -1;
+                fBuffers[chan] = static_cast<FAUSTFLOAT*>(buffer);
+            #else
+                fBuffers[chan] = new FAUSTFLOAT[total_length];
+                memset(fBuffers[chan], 0, fBufferSize);
+            #endif
+                // Channels are allocated one by one, so that they can be freed if an allocation fails
+                fChannels = chan + 1;
+            }
+            // Share the same buffers for all other channels so that we have max_chan channels available
+            for (int chan = cur_chan; chan < max_chan; chan++) {
+                fBuffers[chan] = fBuffers[chan % cur_chan];
+            }
+            fUsedChannels = std::min<int>(cur_chan, max_chan);
+        }
+
+        // Decode [fEnd, end) of a part (I/O thread only)
+        void decode(int part, int end)
+        {
+            Part& cur = fParts[part];
+            FAUSTFLOAT* buffers[MAX_CHAN];
+            int start = cur.fEnd.load(std::memory_order_relaxed);
+            while (start < end) {
+                for (int chan = 0; chan < fUsedChannels; chan++) {
+                    buffers[chan] = &fBuffers[chan][fOffset[part] + start];
+                }
+                int frames = cur.fDecoder->decode(buffers, std::min<int>(BUFFER_SIZE, end - start), fUsedChannels);
+                // A truncated resource is considered decoded (and will be silent)
+                start = (frames > 0) ? (start + frames) : end;
+                // Frames are written before being visible to the audio thread
+                cur.fEnd.store(start, std::memory_order_release);
+            }
+        }
+
+        // Give back the memory of [start, end) of a part, frames before 'start' being not used anymore (I/O thread only)
+        void release(int part, int start, int end)
+        {
+        #ifndef _WIN32
+            static const uintptr_t page_mask = ~uintptr_t(sysconf(_SC_PAGESIZE) - 1);
+            for (int chan = 0; chan < fChannels; chan++) {
+                // Pages shared with the decoded frames or with another part are kept
+                uintptr_t part_first = uintptr_t(&fBuffers[chan][fOffset[part]]);
+                uintptr_t first = std::max<uintptr_t>((part_first + ~page_mask) & page_mask,
+                                                      uintptr_t(&fBuffers[chan][fOffset[part] + start]) & page_mask);
+                uintptr_t last = uintptr_t(&fBuffers[chan][fOffset[part] + end]) & page_mask;
+                if (first < last) madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+            }
+        #endif
+        }
+
+        // Decode ahead of the read position and release behind it (I/O thread only)
+        void prefetch(int ahead, int behind)
+        {
+            for (int part = 0; part < MAX_SOUNDFILE_PARTS; part++) {
+                Part& cur = fParts[part];
+                if (!cur.fDecoder) continue;
+                int read_pos = std::max<int>(0, std::min<int>(cur.fReadPos.load(std::memory_order_acquire), fLength[part]));
+                int start = cur.fStart.load(std::memory_order_relaxed);
+                int end = cur.fEnd.load(std::memory_order_relaxed);
+
+                // Seek when the read position is out of the decoded frames, or the I/O thread is late
+                if (read_pos < start || read_pos > end) {
+                    if (!cur.fDecoder->seek(read_pos)) continue;
+                    // The previous frames are invalidated before releasing them
+                    cur.fStart.store(read_pos, std::memory_order_release);
+                    cur.fEnd.store(read_pos, std::memory_order_release);
+                    release(part, start, end);
+                    start = end = read_pos;
+                }
+
+                decode(part, std::min<int>(fLength[part], read_pos + ahead));
+
+                if (read_pos - behind > start) {
+                    cur.fStart.store(read_pos - behind, std::memory_order_release);
+                    release(part, start, read_pos - behind);
+                }
+            }
+        }
+
+    public:
+
+        ~StreamingSoundfile()
+        {
+            for (int part = 0; part < MAX_SOUNDFILE_PARTS; part++) {
+                delete fParts[part].fDecoder;
+            }
+        #ifndef _WIN32
+            for (int chan = 0; chan < fChannels; chan++) {
+                munmap(fBuffers[chan], fBufferSize);
+            }
+            // Channels are not allocated with new: only the buffers table will be deleted by the Soundfile destructor
+            fChannels = 0;
+        #endif
+        }
+
+        /**
+         * Move the read position of a part, to be called from the audio thread (wait-free).
+         *
+         * @param part - the part number
+         * @param frame - the next frame read by the DSP in the part
+         */
+        void setReadPosition(int part, int frame)
+        {
+            fParts[part].fReadPos.store(frame, std::memory_order_release);
+        }
+
+        /**
+         * Advance the read position of a part after reading frames, to be called from the audio thread (wait-free).
+         * Frames which were not decoded when read are counted as an underrun.
+         *
+         * @param part - the part number
+         * @param frames - the number of read frames
+         */
+        void advance(int part, int frames)
+        {
+            Part& cur = fParts[part];
+            int read_pos = cur.fReadPos.load(std::memory_order_relaxed);
+            int last = std::min<int>(read_pos + frames, fLength[part]);
+            if (read_pos < last
+                && (read_pos < cur.fStart.load(std::memory_order_acquire) || last > cur.fEnd.load(std::memory_order_acquire))) {
+                fUnderruns.fetch_add(1, std::memory_order_relaxed);
+            }
+            cur.fReadPos.store(read_pos + frames, std::memory_order_release);
+        }
+
+        int getReadPosition(int part) { return fParts[part].fReadPos.load(std::memory_order_relaxed); }
+
+        // Whether [frame, frame + frames) of a part can be read
+        bool isDecoded(int part, int frame, int frames)
+        {
+            return frame >= fParts[part].fStart.load(std::memory_order_acquire)
+                && std::min<int>(frame + frames, fLength[part]) <= fParts[part].fEnd.load(std::memory_order_acquire);
+        }
+
+        // Number of 'advance' calls which read frames not yet decoded
+        int getUnderruns() { return fUnderruns.load(std::memory_order_relaxed); }
+
+};
+
+/*
+ The I/O thread decoding the streamed soundfiles.
+*/
+
+class SoundfileStreamer {
+
+    private:
+
+        std::vector<StreamingSoundfile*> fSoundfiles;
+        std::mutex fMutex;
+        std::condition_variable fCondition;
+        std::thread fThread;
+        bool fRunning;
+        int fAhead;
+        int fBehind;
+        int fPeriod;
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            while (fRunning) {
+                for (size_t i = 0; i < fSoundfiles.size(); i++) {
+                    fSoundfiles[i]->prefetch(fAhead, fBehind);
+                }
+                fCondition.wait_for(lock, std::chrono::milliseconds(fPeriod));
+            }
+        }
+
+    public:
+
+        /**
+         * Create the streamer.
+         *
+         * @param ahead - the number of frames decoded ahead of the read position of each part
+         * @param behind - the number of frames kept behind the read position of each part
+         * @param period - the I/O thread period in ms, or 0 to not start the I/O thread ('prefetch' is then called by the application)
+         */
+        SoundfileStreamer(int ahead = 4 * SAMPLE_RATE, int behind = SAMPLE_RATE, int period = 10)
+        :fRunning(period > 0), fAhead(ahead), fBehind(behind), fPeriod(period)
+        {
+            if (fRunning) fThread = std::thread(&SoundfileStreamer::run, this);
+        }
+
+        virtual ~SoundfileStreamer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                fRunning = false;
+            }
+            fCondition.notify_one();
+            if (fThread.joinable()) fThread.join();
+            for (size_t i = 0; i < fSoundfiles.size(); i++) {
+                delete fSoundfiles[i];
+            }
+        }
+
+        /**
+         * Create a streamed soundfile, with the beginning of each part already decoded.
+         *
+         * @param reader - the reader to use to decode the sound resources, with its sample rate set
+         * @param path_name_list - the complete path of each part (as returned by SoundfileReader::checkFiles)
+         * @param max_chan - the number of channels of the soundfile
+         *
+         * @return the soundfile, or nullptr if a sound resource cannot be streamed by the reader.
+         */
+        StreamingSoundfile* createSoundfile(SoundfileReader* reader, const std::vector<std::string>& path_name_list, int max_chan)
+        {
+            StreamingSoundfile* soundfile = new StreamingSoundfile();
+            int cur_chan = 1; // At least one channel
+            int offset = 0;
+            for (int part = 0; part < MAX_SOUNDFILE_PARTS; part++) {
+                if (part < int(path_name_list.size()) && path_name_list[part] != "__empty_sound__") {
+                    SoundfileDecoder* decoder = reader->createDecoder(path_name_list[part]);
+                    if (!decoder) {
+                        delete soundfile;
+                        return nullptr;
+                    }
+                    soundfile->fParts[part].fDecoder = decoder;
+                    soundfile->fLength[part] = decoder->fLength;
+                    soundfile->fSR[part] = decoder->fSR;
+                    cur_chan = std::max<int>(cur_chan, decoder->fChannels);
+                } else {
+                    // Empty parts are silent
+                    soundfile->fLength[part] = BUFFER_SIZE;
+                    soundfile->fSR[part] = SAMPLE_RATE;
+                    soundfile->fParts[part].fEnd = BUFFER_SIZE;
+                }
+                soundfile->fOffset[part] = offset;
+                offset += soundfile->fLength[part];
+            }
+
+            try {
+                soundfile->allocate(cur_chan, offset, max_chan);
+            } catch (...) {
+                delete soundfile;
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(fMutex);
+            soundfile->prefetch(fAhead, fBehind);
+            fSoundfiles.push_back(soundfile);
+            return soundfile;
+        }
+
+        // Stop streaming and delete a soundfile returned by 'createSoundfile'
+        void release(StreamingSoundfile* soundfile)
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            std::vector<StreamingSoundfile*>::iterator it = std::find(fSoundfiles.begin(), fSoundfiles.end(), soundfile);
+            if (it != fSoundfiles.end()) {
+                fSoundfiles.erase(it);
+                delete soundfile;
+            }
+        }
+
+        // Decode ahead of the read positions and release behind them, done by the I/O thread if started
+        void prefetch()
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            for (size_t i = 0; i < fSoundfiles.size(); i++) {
+                fSoundfiles[i]->prefetch(fAhead, fBehind);
+            }
+        }
+
+        // Wake up the I/O thread (for instance after a seek), not to be called from the audio thread
+        void wakeUp() { fCondition.notify_one(); }
+
+};
+
+/*
+ A SoundUI which streams the soundfiles that the reader can stream, and completely loads the others.
+*/
+
+class StreamingSoundUI : public SoundUI
+{
+
+    protected:
+
+        SoundfileStreamer* fStreamer;
+        std::map<std::string, StreamingSoundfile*> fStreamingMap;
+
+    public:
+
+        /**
+         * Create a streaming soundfile loader.
+         *
+         * @param streamer - the streamer which decodes the soundfiles
+         * @param sound_directory - the base directory to look for files, which paths will be relative to this one
+         * @param sample_rate - the audio driver SR (files with another SR are completely loaded and resampled)
+         * @param reader - an alternative soundfile reader
+         */
+        StreamingSoundUI(SoundfileStreamer* streamer, const std::string& sound_directory = "", int sample_rate = -1, SoundfileReader* reader = nullptr)
+        :SoundUI(sound_directory, sample_rate, reader), fStreamer(streamer)
+        {}
+
+        virtual ~StreamingSoundUI()
+        {
+            for (auto& it : fStreamingMap) {
+                fStreamer->release(it.second);
+            }
+        }
+
+        virtual void addSoundfile(const char* label, const char* url, Soundfile** sf_zone)
+        {
+            if (fStreamingMap.find(url) == fStreamingMap.end()) {
+                StreamingSoundfile* sound_file = fStreamer->createSoundfile(fSoundReader, getPathNameList(url), MAX_CHAN);
+                if (!sound_file) {
+                    SoundUI::addSoundfile(label, url, sf_zone);
+                    return;
+                }
+                fStreamingMap[url] = sound_file;
+            }
+            *sf_zone = fStreamingMap[url];
+        }
+
+        // Advance the read position of a part of all streamed soundfiles (see StreamingSoundfile::advance)
+        void advance(int part, int frames)
+        {
+            for (auto& it : fStreamingMap) {
+                it.second->advance(part, frames);
+            }
+        }
+
+        // Move the read position of a part of all streamed soundfiles (see StreamingSoundfile::setReadPosition)
+        void setReadPosition(int part, int frame)
+        {
+            for (auto& it : fStreamingMap) {
+                it.second->setReadPosition(part, frame);
+            }
+        }
+
+        int getUnderruns()
+        {
+            int underruns = 0;
+            for (auto& it : fStreamingMap) {
+                underruns += it.second->getUnderruns();
+            }
+            return underruns;
+        }
+
+};
+
+#endif
+/**************************  END  SoundfileStreamer.h **************************/
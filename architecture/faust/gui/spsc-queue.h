@@ -0,0 +1,166 @@
+/************************** BEGIN spsc-queue.h **************************/
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __spsc_queue__
+#define __spsc_queue__
+
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#define SPSC_CACHE_LINE 64
+
+/**
+ * Lock-free single producer / single consumer queue of 'T' items (to be copied with memcpy like semantic).
+ *
+ * - 'fTail' is only written by the producer and 'fHead' by the consumer, with release stores
+ *   read by the other side with acquire loads, so that an item is completely written before being visible.
+ * - both indexes (and the copy of the other index kept by each side) are on separated cache lines,
+ *   so that the producer and the consumer do not share a cache line in the common case.
+ * - indexes are never wrapped, the capacity is rounded up to a power of two.
+ */
+template <typename T>
+class spsc_queue {
+
+    private:
+
+        std::vector<T> fItems;
+        size_t fMask;
+
+        char fPad0[SPSC_CACHE_LINE];
+        // Consumer side
+        std::atomic<size_t> fHead;
+        size_t fTailCache;      // Last read value of fTail
+        char fPad1[SPSC_CACHE_LINE];
+        // Producer side
+        std::atomic<size_t> fTail;
+        size_t fHeadCache;      // Last read value of fHead
+        char fPad2[SPSC_CACHE_LINE];
+
+        static size_t roundCapacity(size_t capacity)
+        {
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            return size;
+        }
+
+    public:
+
+        spsc_queue(size_t capacity)
+        :fItems(roundCapacity(capacity)), fMask(fItems.size() - 1), fHead(0), fTailCache(0), fTail(0), fHeadCache(0)
+        {}
+
+        size_t capacity() const { return fItems.size(); }
+
+        // Producer API
+
+        bool push(const T& item)
+        {
+            size_t tail = fTail.load(std::memory_order_relaxed);
+            if (tail - fHeadCache == fItems.size()) {
+                fHeadCache = fHead.load(std::memory_order_acquire);
+                if (tail - fHeadCache == fItems.size()) return false;
+            }
+            fItems[tail & fMask] = item;
+            fTail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Push up to 'count' items, returns the number of pushed items
+        size_t push(const T* items, size_t count)
+        {
+            size_t tail = fTail.load(std::memory_order_relaxed);
+            fHeadCache = fHead.load(std::memory_order_acquire);
+            size_t available = std::min<size_t>(count, fItems.size() - (tail - fHeadCache));
+            for (size_t i = 0; i < available; i++) {
+                fItems[(tail + i) & fMask] = items[i];
+            }
+            fTail.store(tail + available, std::memory_order_release);
+            return available;
+        }
+
+        size_t writeSpace() const
+        {
+            return fItems.size() - (fTail.load(std::memory_order_relaxed) - fHead.load(std::memory_order_acquire));
+        }
+
+        // Consumer API
+
+        // Returns the first item without removing it, or nullptr if the queue is empty
+        T* front()
+        {
+            size_t head = fHead.load(std::memory_order_relaxed);
+            if (head == fTailCache) {
+                fTailCache = fTail.load(std::memory_order_acquire);
+                if (head == fTailCache) return nullptr;
+            }
+            return &fItems[head & fMask];
+        }
+
+        bool pop(T& item)
+        {
+            T* first = front();
+            if (!first) return false;
+            item = *first;
+            pop();
+            return true;
+        }
+
+        // Remove the first item, which has to be available (see 'front')
+        void pop()
+        {
+            fHead.store(fHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Pop up to 'count' items, returns the number of popped items
+        size_t pop(T* items, size_t count)
+        {
+            size_t head = fHead.load(std::memory_order_relaxed);
+            fTailCache = fTail.load(std::memory_order_acquire);
+            size_t available = std::min<size_t>(count, fTailCache - head);
+            for (size_t i = 0; i < available; i++) {
+                items[i] = fItems[(head + i) & fMask];
+            }
+            fHead.store(head + available, std::memory_order_release);
+            return available;
+        }
+
+        size_t readSpace() const
+        {
+            return fTail.load(std::memory_order_acquire) - fHead.load(std::memory_order_relaxed);
+        }
+
+        // Not thread safe: to be used when no producer or consumer is running
+        void reset()
+        {
+            fHead = 0;
+            fTail = 0;
+            fHeadCache = fTailCache = 0;
+        }
+
+};
+
+#endif
+/**************************  END  spsc-queue.h **************************/
@@ -27,12 +27,13 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <string.h>
 
 #include <jack/jack.h>
 #include <jack/midiport.h>
 
 #include "faust/midi/midi.h"
-#include "faust/gui/ring-buffer.h"
+#include "faust/gui/spsc-queue.h"
 
 class MapUI;
 
@@ -43,7 +44,7 @@ class jack_midi : public midi_handler {
         
     protected:
 
-        ringbuffer_t* fOutBuffer;
+        spsc_queue<DatedMessage> fOutBuffer;
         jack_port_t* fInputMidiPort;    // JACK input MIDI port
         jack_port_t* fOutputMidiPort;   // JACK output MIDI port
 
@@ -56,10 +57,8 @@ class jack_midi : public midi_handler {
     
         void writeMessage(double date, unsigned char* buffer, size_t size)
         {
-            size_t res;
-            DatedMessage dated_message(date, buffer, size);
-            if ((res = ringbuffer_write(fOutBuffer, (const char*)&dated_message, sizeof(DatedMessage))) != sizeof(DatedMessage)) {
-                std::cerr << "ringbuffer_write error DatedMessage" << std::endl;
+            if (!fOutBuffer.push(DatedMessage(date, buffer, size))) {
+                std::cerr << "spsc_queue::push error DatedMessage" << std::endl;
             }
         }
 
@@ -108,14 +107,17 @@ class jack_midi : public midi_handler {
                 jack_midi_clear_buffer(port_buf_out);
             }
            
-            // Write each message one by one
-            DatedMessage dated_message;
-            while (ringbuffer_read(fOutBuffer, (char*)&dated_message, sizeof(DatedMessage)) == sizeof(DatedMessage)) {
-                jack_midi_data_t* data = jack_midi_event_reserve(port_buf_out, dated_message.fDate, dated_message.fSize);
-                if (data) {
-                    memcpy(data, dated_message.fBuffer, dated_message.fSize);
-                } else {
-                    std::cerr << "jack_midi_event_reserve error" << std::endl;
+            // Write messages by batches
+            DatedMessage dated_messages[64];
+            size_t count;
+            while ((count = fOutBuffer.pop(dated_messages, 64)) > 0) {
+                for (size_t i = 0; i < count; i++) {
+                    jack_midi_data_t* data = jack_midi_event_reserve(port_buf_out, dated_messages[i].fDate, dated_messages[i].fSize);
+                    if (data) {
+                        memcpy(data, dated_messages[i].fBuffer, dated_messages[i].fSize);
+                    } else {
+                        std::cerr << "jack_midi_event_reserve error" << std::endl;
+                    }
                 }
             }
         }
@@ -129,14 +131,10 @@ class jack_midi : public midi_handler {
     public:
 
         jack_midi(const std::string& name = "JACKHandler")
-            :midi_handler(name), fInputMidiPort(nullptr), fOutputMidiPort(nullptr)
-        {
-            fOutBuffer = ringbuffer_create(8192);
-        }
+            :midi_handler(name), fOutBuffer(512), fInputMidiPort(nullptr), fOutputMidiPort(nullptr)
+        {}
         virtual ~jack_midi()
-        {
-            ringbuffer_free(fOutBuffer);
-        }
+        {}
     
         // To be used in polling mode
         int recvMessages(std::vector<MIDIMessage>* messages)
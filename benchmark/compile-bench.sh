@@ -0,0 +1,22 @@
+#!/bin/bash
+# Measure the Faust compiler itself: compilation time and peak memory (RSS) for each .dsp
+# usage: ./compile-bench.sh [faust binary] [faust options...]
+FAUST=${1:-faust}
+shift
+DST=compile-results-$(date +%y%m%d.%H%M%S)
+
+if [[ $(uname) == Darwin ]]; then
+TIME=gtime
+else
+TIME=/usr/bin/time
+fi
+
+echo "Faust compilation benchmark : " $FAUST $@ > $DST
+$FAUST --version | head -1 >> $DST
+uname -a >> $DST
+date  >> $DST
+
+for f in *.dsp; do
+	printf "%s\t" $f >> $DST
+	$TIME -f "%e s\t%M KB" $FAUST $@ $f -o /dev/null 2>&1 >/dev/null | tail -1 >> $DST
+done
@@ -32,11 +32,11 @@
 #include "timing.hh"
 
 // Timing can be used outside of the scope of 'gGlobal'
-bool     gTimingSwitch;
-int      gTimingIndex;
-double   gStartTime[1024];
-double   gEndTime[1024];
-ostream* gTimingLog = 0;
+thread_local bool     gTimingSwitch;
+thread_local int      gTimingIndex;
+thread_local double   gStartTime[1024];
+thread_local double   gEndTime[1024];
+thread_local ostream* gTimingLog = 0;
 
 #ifndef _WIN32
 double mysecond()
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <new>
+#include <ostream>
 
 #include "exception.hh"
 
@@ -42,6 +43,9 @@ class Garbageable {
     void  operator delete[](void* ptr);
 
     static void cleanup();
+
+    // Print the allocation counters of the current compilation
+    static void printStatistics(std::ostream& fout);
 };
 
 template <class P>
@@ -397,6 +397,24 @@ void CodeContainer::processFIR(void)
      fDeclarationInstructions->fCode.sort(sortArrayDeclarations);
      fDeclarationInstructions->fCode.sort(sortTypeDeclarations);
      */
+    
+    // Compute common subexpressions once and move loop invariants in the control block, in scalar mode
+    // (in -os mode, the control block is not computed right before the loop, so invariants are not moved)
+    if (gGlobal->gCommonSubexpressions && !gGlobal->gVectorSwitch) {
+        shareLoopExpressions(fComputeBlockInstructions,
+                             {fCurLoop->fPreInst, fCurLoop->fComputeInst, fCurLoop->fPostInst},
+                             fCurLoop->fLoopIndex, !gGlobal->gOneSample);
+    }
+    
+    // Reorder struct fields by their use in 'compute'
+    if (gGlobal->gStructLayout) {
+        StructAccessCounter loop_counter;
+        transformDAG(&loop_counter);
+        StructAccessCounter block_counter;
+        fComputeBlockInstructions->accept(&block_counter);
+        fPostComputeBlockInstructions->accept(&block_counter);
+        sortStructDeclarations(fDeclarationInstructions, loop_counter, block_counter);
+    }
 }
 
 BlockInst* CodeContainer::flattenFIR(void)
@@ -33,7 +33,7 @@ class DLangInstVisitor : public TextInstVisitor {
      Global functions names table as a static variable in the visitor
      so that each function prototype is generated at most once in the module.
      */
-    static map<string, bool> gFunctionSymbolTable;
+    static thread_local map<string, bool> gFunctionSymbolTable;
 
     // Polymorphic math functions
     map<string, string> gPolyMathLibTable;
@@ -20,8 +20,12 @@
  ************************************************************************/
 
 #include <algorithm>
+#include <functional>
+#include <set>
+#include <sstream>
 
 #include "fir_to_fir.hh"
+#include "global.hh"
 
 using namespace std;
 
@@ -73,6 +77,87 @@ bool sortTypeDeclarations(StatementInst* a, StatementInst* b)
     }
 }
 
+/*
+ Reorder struct fields, so that the state used at each sample in 'compute' (recursion registers, IOTA, small
+ delay lines) is packed in a few cache lines at the beginning of the struct, followed by the fields only used once
+ per block (controls), then the cold fields (UI zones, sample rate...), and finally the large buffers (delay lines
+ used in the loop first, then tables), sorted by increasing size.
+ 
+ Fields of a same group keep their declaration order, the most accessed hot fields being put first.
+ Other statements keep their place.
+ 
+ Delay lines whose size is a multiple of a cache way (typically power of two delay lines), read and written
+ at the same IOTA based index at each sample, would map on the same cache sets when contiguous: a cache line of
+ padding is added after each of these buffers used in the loop, so that their accesses are spread over successive
+ cache sets. Other buffers are not padded, so that the struct only grows when this aliasing can happen.
+*/
+
+// Arrays bigger than 4 cache lines are considered as 'large' buffers
+#define LARGE_FIELD_SIZE 256
+#define CACHE_LINE_SIZE 64
+// Size of a way of a 32 KB 8-way L1 data cache (64 sets of 64 bytes)
+#define CACHE_WAY_SIZE 4096
+
+enum { kHotScalar, kHotArray, kControlField, kColdField, kHotBuffer, kColdBuffer };
+
+struct StructField {
+    DeclareVarInst* fDecl;
+    int             fGroup;
+    int             fKey;  // sort key inside the group
+    bool            fPadded;
+};
+
+void sortStructDeclarations(BlockInst* declarations, const StructAccessCounter& loop_counter,
+                            const StructAccessCounter& block_counter)
+{
+    vector<StructField> fields;
+    for (auto& it : declarations->fCode) {
+        DeclareVarInst* inst = dynamic_cast<DeclareVarInst*>(it);
+        if (!inst || !(inst->fAddress->getAccess() & Address::kStruct)) continue;
+        
+        string name   = inst->fAddress->getName();
+        int    loop   = loop_counter.getAccesses(name);
+        int    block  = block_counter.getAccesses(name);
+        int    size   = inst->fType->getSize();
+        bool   array  = dynamic_cast<ArrayTyped*>(inst->fType) != nullptr;
+        bool   large  = array && (size > LARGE_FIELD_SIZE);
+        
+        StructField field;
+        field.fDecl   = inst;
+        field.fPadded = false;
+        if (large) {
+            field.fGroup  = (loop > 0) ? kHotBuffer : kColdBuffer;
+            field.fKey    = size;
+            field.fPadded = (loop > 0) && (size % CACHE_WAY_SIZE == 0);
+        } else if (loop > 0) {
+            field.fGroup = (array) ? kHotArray : kHotScalar;
+            field.fKey   = -loop;
+        } else {
+            field.fGroup = (block > 0) ? kControlField : kColdField;
+            field.fKey   = 0;
+        }
+        fields.push_back(field);
+    }
+    
+    stable_sort(fields.begin(), fields.end(), [](const StructField& a, const StructField& b) {
+        return (a.fGroup == b.fGroup) ? (a.fKey < b.fKey) : (a.fGroup < b.fGroup);
+    });
+    
+    // Put the sorted fields back in the places of the struct fields
+    size_t field = 0;
+    for (auto it = declarations->fCode.begin(); it != declarations->fCode.end(); it++) {
+        DeclareVarInst* inst = dynamic_cast<DeclareVarInst*>(*it);
+        if (inst && (inst->fAddress->getAccess() & Address::kStruct)) {
+            *it = fields[field].fDecl;
+            if (fields[field].fPadded) {
+                Typed* pad_type = InstBuilder::genArrayTyped(InstBuilder::genInt32Typed(), CACHE_LINE_SIZE / 4);
+                it = declarations->fCode.insert(++it, InstBuilder::genDecStructVar(gGlobal->getFreshID("iPad"), pad_type));
+            }
+            field++;
+        }
+    }
+}
+
 // Expand and rewrite ControlInst as 'IF (cond) {....}' instructions
 void ControlExpander::beginCond(ControlInst* inst)
 {
@@ -140,3 +225,377 @@ StatementInst* ControlExpander::visit(BlockInst* inst)
     
     return cloned;
 }
+
+/*
+ Common subexpression elimination and loop-invariant code motion in the scalar 'compute' loop.
+
+ Expressions are compared with a textual key built on their structure (operands of commutative operators being
+ put in a canonical order, so that '(a * b)' and '(b * a)' are the same) and on the 'version' of each variable they
+ read, incremented at each store or declaration of the variable. So the same expression found after promotion and
+ casts in several signals (like the delay lines index '(IOTA & 2047)') gets the same key, as long as the variables
+ it reads are not written in between.
+
+ Only pure expressions are considered: arithmetic (except integer division and remainder), casts, math functions
+ and selects, reading scalar variables and struct arrays (input/output buffers may alias). Only the condition
+ of a select is always computed, so its branches are not looked into. Statements with control flow (ControlInst,
+ IfInst, loops...) are kept as they are, and only increment the version of the variables they write.
+
+ - in the loop, the largest expressions only reading variables not written in the loop (and no array) are moved
+   at the end of the control block in 'fSlow/iSlow' variables
+ - then in the control block and in the loop, an expression computed several times is computed once in a
+   'fTemp/iTemp' variable declared before the statement of its first use
+*/
+
+struct ExpressionInfo {
+    string fKey;
+    bool   fPure;       // can be moved or shared
+    bool   fLoad;       // reads a variable
+    bool   fArray;      // reads an array
+    bool   fInvariant;  // only reads variables not written in the loop
+};
+
+// Variables written by a statement
+struct VariableWriter : public DispatchVisitor {
+    set<string> fNames;
+
+    virtual void visit(DeclareVarInst* inst)
+    {
+        fNames.insert(inst->fAddress->getName());
+        DispatchVisitor::visit(inst);
+    }
+    virtual void visit(StoreVarInst* inst)
+    {
+        fNames.insert(inst->fAddress->getName());
+        DispatchVisitor::visit(inst);
+    }
+    virtual void visit(TeeVarInst* inst)
+    {
+        fNames.insert(inst->fAddress->getName());
+        DispatchVisitor::visit(inst);
+    }
+};
+
+struct ExpressionSharing : public BasicCloneVisitor {
+    map<string, int>                fVersions;      // version of the written variables
+    set<string>                     fVariants;      // variables written in the loop
+    map<ValueInst*, ExpressionInfo> fInfos;         // for the current statement
+    map<string, int>                fCounts;        // number of computations of each expression key
+    map<string, string>             fShared;        // variables holding the shared or moved expressions
+    list<StatementInst*>            fDeclarations;  // to be inserted before the current statement
+    BlockInst*                      fControl;       // where the loop invariants are moved, or nullptr when sharing
+    int                             fKeep;          // > 0 when subexpressions are kept as they are
+
+    ExpressionSharing() : fControl(nullptr), fKeep(0) {}
+
+    static bool isPureFunction(const string& name)
+    {
+        static set<string> functions = {"abs",   "fabs",  "acos",  "asin",  "atan",      "atan2", "ceil",  "cos",
+                                        "exp",   "exp10", "floor", "fmod",  "log",       "log10", "pow",   "remainder",
+                                        "rint",  "round", "sin",   "sqrt",  "tan",       "acosh", "asinh", "atanh",
+                                        "cosh",  "sinh",  "tanh",  "max_",  "min_",      "max_i", "min_i", "max_f",
+                                        "min_f", "max_l", "min_l", "isnan", "isinf",     "copysign"};
+        if (functions.find(name) != functions.end()) return true;
+        // Float and long double versions
+        char suffix = name.back();
+        return (suffix == 'f' || suffix == 'l') && functions.find(name.substr(0, name.size() - 1)) != functions.end();
+    }
+
+    static bool isCommutative(int opcode)
+    {
+        return opcode == kAdd || opcode == kMul || opcode == kEQ || opcode == kNE || opcode == kAND || opcode == kOR ||
+               opcode == kXOR;
+    }
+
+    static Typed::VarType getType(ValueInst* inst)
+    {
+        try {
+            TypingVisitor typing;
+            inst->accept(&typing);
+            return typing.fCurType;
+        } catch (faustexception& e) {
+            return Typed::kNoType;
+        }
+    }
+
+    template <typename T>
+    static string getNumKey(const string& prefix, T num)
+    {
+        stringstream key;
+        key << prefix << hexfloat << num;
+        return key.str();
+    }
+
+    ExpressionInfo getVariableInfo(const string& name)
+    {
+        ExpressionInfo info;
+        info.fKey       = name + "@" + to_string(fVersions[name]);
+        info.fPure      = true;
+        info.fLoad      = true;
+        info.fArray     = false;
+        info.fInvariant = fVariants.find(name) == fVariants.end();
+        return info;
+    }
+
+    void merge(ExpressionInfo& info, const ExpressionInfo& arg)
+    {
+        info.fPure      = info.fPure && arg.fPure;
+        info.fLoad      = info.fLoad || arg.fLoad;
+        info.fArray     = info.fArray || arg.fArray;
+        info.fInvariant = info.fInvariant && arg.fInvariant;
+    }
+
+    const ExpressionInfo& analyze(ValueInst* inst)
+    {
+        auto it = fInfos.find(inst);
+        if (it != fInfos.end()) return it->second;
+
+        ExpressionInfo info;
+        info.fPure      = false;
+        info.fLoad      = false;
+        info.fArray     = false;
+        info.fInvariant = true;
+
+        if (FloatNumInst* num = dynamic_cast<FloatNumInst*>(inst)) {
+            info.fKey  = getNumKey("f", num->fNum);
+            info.fPure = true;
+        } else if (DoubleNumInst* num = dynamic_cast<DoubleNumInst*>(inst)) {
+            info.fKey  = getNumKey("d", num->fNum);
+            info.fPure = true;
+        } else if (Int32NumInst* num = dynamic_cast<Int32NumInst*>(inst)) {
+            info.fKey  = "i" + to_string(num->fNum);
+            info.fPure = true;
+        } else if (Int64NumInst* num = dynamic_cast<Int64NumInst*>(inst)) {
+            info.fKey  = "l" + to_string(num->fNum);
+            info.fPure = true;
+        } else if (BoolNumInst* num = dynamic_cast<BoolNumInst*>(inst)) {
+            info.fKey  = "b" + to_string(num->fNum);
+            info.fPure = true;
+        } else if (LoadVarInst* load = dynamic_cast<LoadVarInst*>(inst)) {
+            NamedAddress*   named   = dynamic_cast<NamedAddress*>(load->fAddress);
+            IndexedAddress* indexed = dynamic_cast<IndexedAddress*>(load->fAddress);
+            if (named) {
+                info = getVariableInfo(named->fName);
+            } else if (indexed && dynamic_cast<NamedAddress*>(indexed->fAddress)
+                       && (indexed->getAccess() & (Address::kStruct | Address::kStaticStruct))
+                       && !isStructType(indexed->getName())) {
+                const ExpressionInfo& index = analyze(indexed->fIndex);
+                info = getVariableInfo(indexed->getName());
+                merge(info, index);
+                info.fKey   = info.fKey + "[" + index.fKey + "]";
+                info.fArray = true;
+            }
+        } else if (BinopInst* binop = dynamic_cast<BinopInst*>(inst)) {
+            const ExpressionInfo& arg1 = analyze(binop->fInst1);
+            const ExpressionInfo& arg2 = analyze(binop->fInst2);
+            info.fPure = true;
+            merge(info, arg1);
+            merge(info, arg2);
+            string key1 = arg1.fKey;
+            string key2 = arg2.fKey;
+            if (isCommutative(binop->fOpcode) && key2 < key1) swap(key1, key2);
+            info.fKey = "(" + key1 + " " + gBinOpTable[binop->fOpcode]->fName + " " + key2 + ")";
+            // Integer division by zero traps
+            if (info.fPure && (binop->fOpcode == kDiv || binop->fOpcode == kRem) && !isRealType(getType(binop))) {
+                info.fPure = false;
+            }
+        } else if (::CastInst* cast = dynamic_cast<::CastInst*>(inst)) {
+            info = analyze(cast->fInst);
+            info.fKey = Typed::gTypeString[cast->fType->getType()] + "(" + info.fKey + ")";
+        } else if (FunCallInst* call = dynamic_cast<FunCallInst*>(inst)) {
+            info.fPure = !call->fMethod && isPureFunction(call->fName) && gGlobal->hasVarType(call->fName);
+            info.fKey  = call->fName + "(";
+            for (auto& it : call->fArgs) {
+                const ExpressionInfo& arg = analyze(it);
+                merge(info, arg);
+                info.fKey += arg.fKey + ",";
+            }
+            info.fKey += ")";
+        } else if (Select2Inst* select = dynamic_cast<Select2Inst*>(inst)) {
+            const ExpressionInfo& cond     = analyze(select->fCond);
+            const ExpressionInfo& then_exp = analyze(select->fThen);
+            const ExpressionInfo& else_exp = analyze(select->fElse);
+            info.fPure = true;
+            merge(info, cond);
+            merge(info, then_exp);
+            merge(info, else_exp);
+            info.fKey = "(" + cond.fKey + " ? " + then_exp.fKey + " : " + else_exp.fKey + ")";
+        }
+
+        return fInfos[inst] = info;
+    }
+
+    // Expressions worth being computed in a variable
+    bool isCandidate(ValueInst* inst, const ExpressionInfo& info)
+    {
+        if (!info.fPure || !info.fLoad) return false;
+        if (fControl && (info.fArray || !info.fInvariant)) return false;
+        if (!dynamic_cast<BinopInst*>(inst) && !dynamic_cast<::CastInst*>(inst) && !dynamic_cast<FunCallInst*>(inst) &&
+            !dynamic_cast<Select2Inst*>(inst)) {
+            return false;
+        }
+        Typed::VarType type = getType(inst);
+        return type == Typed::kInt32 || type == Typed::kFloat || type == Typed::kDouble;
+    }
+
+    // Count the computations of the candidates, in the same order as the rewriting
+    void count(ValueInst* inst)
+    {
+        const ExpressionInfo& info = analyze(inst);
+        // Later computations will be replaced, with their subexpressions
+        if (isCandidate(inst, info) && fCounts[info.fKey]++ > 0) return;
+
+        if (LoadVarInst* load = dynamic_cast<LoadVarInst*>(inst)) {
+            count(load->fAddress);
+        } else if (BinopInst* binop = dynamic_cast<BinopInst*>(inst)) {
+            count(binop->fInst1);
+            count(binop->fInst2);
+        } else if (::CastInst* cast = dynamic_cast<::CastInst*>(inst)) {
+            count(cast->fInst);
+        } else if (FunCallInst* call = dynamic_cast<FunCallInst*>(inst)) {
+            for (auto& it : call->fArgs) count(it);
+        } else if (Select2Inst* select = dynamic_cast<Select2Inst*>(inst)) {
+            count(select->fCond);
+        }
+    }
+
+    void count(Address* address)
+    {
+        if (IndexedAddress* indexed = dynamic_cast<IndexedAddress*>(address)) {
+            count(indexed->fAddress);
+            count(indexed->fIndex);
+        }
+    }
+
+    // Possibly replace the expression by a variable
+    ValueInst* replace(ValueInst* inst, std::function<ValueInst*()> clone)
+    {
+        if (fKeep > 0) return clone();
+
+        const ExpressionInfo& info = analyze(inst);
+        if (!isCandidate(inst, info) || (!fControl && fCounts[info.fKey] < 2)) return clone();
+
+        auto it = fShared.find(info.fKey);
+        if (it == fShared.end()) {
+            Typed::VarType type = getType(inst);
+            string         name = ((type == Typed::kInt32) ? "i" : "f") + gGlobal->getFreshID((fControl) ? "Slow" : "Temp");
+            if (fControl) {
+                // The whole expression is moved
+                fKeep++;
+                fControl->pushBackInst(InstBuilder::genDecStackVar(name, InstBuilder::genBasicTyped(type), clone()));
+                fKeep--;
+            } else {
+                fDeclarations.push_back(InstBuilder::genDecStackVar(name, InstBuilder::genBasicTyped(type), clone()));
+            }
+            it = fShared.insert(make_pair(info.fKey, name)).first;
+        }
+        return InstBuilder::genLoadStackVar(it->second);
+    }
+
+    virtual ValueInst* visit(BinopInst* inst)
+    {
+        return replace(inst, [=]() { return BasicCloneVisitor::visit(inst); });
+    }
+    virtual ValueInst* visit(::CastInst* inst)
+    {
+        return replace(inst, [=]() { return BasicCloneVisitor::visit(inst); });
+    }
+    virtual ValueInst* visit(FunCallInst* inst)
+    {
+        return replace(inst, [=]() { return BasicCloneVisitor::visit(inst); });
+    }
+    virtual ValueInst* visit(Select2Inst* inst)
+    {
+        return replace(inst, [=]() {
+            fKeep++;
+            ValueInst* then_exp = inst->fThen->clone(this);
+            ValueInst* else_exp = inst->fElse->clone(this);
+            fKeep--;
+            return InstBuilder::genSelect2Inst(inst->fCond->clone(this), then_exp, else_exp);
+        });
+    }
+
+    static bool isSimple(StatementInst* inst)
+    {
+        DropInst* drop = dynamic_cast<DropInst*>(inst);
+        return dynamic_cast<DeclareVarInst*>(inst) || dynamic_cast<StoreVarInst*>(inst) || (drop && drop->fResult);
+    }
+
+    void countStatement(StatementInst* inst)
+    {
+        if (DeclareVarInst* declare = dynamic_cast<DeclareVarInst*>(inst)) {
+            if (declare->fValue) count(declare->fValue);
+        } else if (StoreVarInst* store = dynamic_cast<StoreVarInst*>(inst)) {
+            count(store->fAddress);
+            count(store->fValue);
+        } else if (DropInst* drop = dynamic_cast<DropInst*>(inst)) {
+            count(drop->fResult);
+        }
+    }
+
+    void write(StatementInst* inst)
+    {
+        VariableWriter writer;
+        inst->accept(&writer);
+        for (auto& it : writer.fNames) fVersions[it]++;
+    }
+
+    // Move the loop invariants at the end of the control block
+    void hoist(BlockInst* control, const list<BlockInst*>& loop, const string& index)
+    {
+        VariableWriter writer;
+        for (auto& block : loop) block->accept(&writer);
+        fVariants = writer.fNames;
+        fVariants.insert(index);
+        fControl = control;
+
+        for (auto& block : loop) {
+            for (auto& it : block->fCode) {
+                fInfos.clear();
+                if (isSimple(it)) it = it->clone(this);
+            }
+        }
+
+        fVariants.clear();
+        fShared.clear();
+        fControl = nullptr;
+    }
+
+    // Share the expressions computed several times in a sequence of blocks
+    void share(const list<BlockInst*>& blocks)
+    {
+        for (auto& block : blocks) {
+            for (auto& it : block->fCode) {
+                fInfos.clear();
+                if (isSimple(it)) countStatement(it);
+                write(it);
+            }
+        }
+
+        fVersions.clear();
+        for (auto& block : blocks) {
+            list<StatementInst*> code;
+            for (auto& it : block->fCode) {
+                fInfos.clear();
+                StatementInst* inst = (isSimple(it)) ? it->clone(this) : it;
+                code.splice(code.end(), fDeclarations);
+                code.push_back(inst);
+                write(it);
+            }
+            block->fCode = code;
+        }
+
+        fVersions.clear();
+        fCounts.clear();
+        fShared.clear();
+    }
+};
+
+void shareLoopExpressions(BlockInst* control, const list<BlockInst*>& loop, const string& index, bool hoist)
+{
+    gGlobal->setVarType(index, Typed::kInt32);
+
+    ExpressionSharing sharing;
+    if (hoist) sharing.hoist(control, loop, index);
+    sharing.share({control});
+    sharing.share(loop);
+}
@@ -22,6 +22,7 @@
 #ifndef _FIR_TO_FIR_H
 #define _FIR_TO_FIR_H
 
+#include <map>
 #include <stack>
 
 #include "code_container.hh"
@@ -73,6 +74,31 @@ inline void dump2FIR(Typed* type, std::ostream* out = &cerr, bool complete = tru
 bool sortArrayDeclarations(StatementInst* a, StatementInst* b);
 bool sortTypeDeclarations(StatementInst* a, StatementInst* b);
 
+// Count the accesses of each struct field
+struct StructAccessCounter : public DispatchVisitor {
+    std::map<std::string, int> fAccesses;
+
+    virtual void visit(NamedAddress* named)
+    {
+        if (named->getAccess() & Address::kStruct) {
+            fAccesses[named->fName]++;
+        }
+    }
+
+    int getAccesses(const std::string& name) const
+    {
+        auto it = fAccesses.find(name);
+        return (it != fAccesses.end()) ? it->second : 0;
+    }
+};
+
+// Reorder struct fields declarations for the cache locality of 'compute'
+void sortStructDeclarations(BlockInst* declarations, const StructAccessCounter& loop_counter,
+                            const StructAccessCounter& block_counter);
+
+// Share common subexpressions, and possibly move loop invariants in the control block, in the scalar 'compute' loop
+void shareLoopExpressions(BlockInst* control, const list<BlockInst*>& loop, const string& index, bool hoist);
+
 // Analysis to change stack access to struct access
 struct Stack2StructRewriter1 : public DispatchVisitor {
     string fName;
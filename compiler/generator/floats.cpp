@@ -41,11 +41,11 @@ using namespace std;
 //          3: long double precision float
 //          4: fixed-point
 
-static const char* mathsuffix[5];  // suffix for math functions
-static const char* numsuffix[5];   // suffix for numeric constants
-static const char* floatname[5];   // float types
-static const char* castname[5];    // float castings
-static double      floatmin[5];    // minimum float values before denormals
+static thread_local const char* mathsuffix[5];  // suffix for math functions
+static thread_local const char* numsuffix[5];   // suffix for numeric constants
+static thread_local const char* floatname[5];   // float types
+static thread_local const char* castname[5];    // float castings
+static thread_local double      floatmin[5];    // minimum float values before denormals
 
 void initFaustFloat()
 {
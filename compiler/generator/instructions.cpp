@@ -28,7 +28,7 @@
 #include "fir_to_fir.hh"
 
 // Used when inlining functions
-std::stack<BlockInst*> BasicCloneVisitor::fBlockStack;
+thread_local std::stack<BlockInst*> BasicCloneVisitor::fBlockStack;
 
 DeclareStructTypeInst* isStructType(const string& name)
 {
@@ -378,9 +378,9 @@ static Sym TYPEARRAY = symbol ("TypeArray");
 Tree  typeArray(int n, Tree t)                    { return tree(TYPEARRAY, tree(n), t);         }
 bool  isTypeArray(Tree t, int* n, Tree& u)        { Tree x; return isTree(t, TYPEARRAY, x, u) && isInt(x->node(), n); }
 
-static property<DeclareTypeInst* > gFirTypeProperty;
+static thread_local property<DeclareTypeInst* > gFirTypeProperty;
 
-map<string, int> InstBuilder::fIDCounters;
+thread_local map<string, int> InstBuilder::fIDCounters;
 
 static Tree signalTypeToSharedType(AudioType* type)
 {
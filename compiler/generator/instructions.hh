@@ -1363,7 +1363,7 @@ struct WhileLoopInst : public StatementInst {
 class BasicCloneVisitor : public CloneVisitor {
    protected:
     // Used when inlining functions
-    static std::stack<BlockInst*> fBlockStack;
+    static thread_local std::stack<BlockInst*> fBlockStack;
 
    public:
     BasicCloneVisitor() {}
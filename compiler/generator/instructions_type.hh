@@ -31,7 +31,7 @@
 // ============================
 
 struct Printable : public virtual Garbageable {
-    static std::ostream* fOut;
+    static thread_local std::ostream* fOut;
 
     Printable() {}
     virtual ~Printable() {}
@@ -24,6 +24,10 @@
 
 //#define MIR_BUILD 1
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #include "fbc_interpreter.hh"
 #ifdef MIR_BUILD
 #include "fbc_mir_compiler.hh"
@@ -31,55 +35,106 @@
 #include "fbc_llvm_compiler.hh"
 #endif
 
-// FBC compiler
+#if defined(MIR_BUILD) || defined(LLVM_BUILD)
+#define FBC_COMPILER 1
+#endif
+
+/*
+ Tiered execution: the block is interpreted while its compiled version is built by a background thread,
+ then each instance switches to the compiled code at its next block boundary.
+ The heaps are shared by both versions, so the switch keeps the DSP state.
+*/
+
 template <class REAL>
-class FBCCompiler : public FBCInterpreter<REAL,0> {
-   public:
-    typedef typename std::map<FBCBlockInstruction<REAL>*, FBCExecuteFun<REAL>*>           CompiledBlocksType;
-    typedef typename std::map<FBCBlockInstruction<REAL>*, FBCExecuteFun<REAL>*>::iterator CompiledBlocksTypeIT;
+class FBCTieredBlock {
+   protected:
+    FBCBlockInstruction<REAL>*        fBlock;
+    std::atomic<FBCExecuteFun<REAL>*> fCompiled;  // Published by the compilation thread
+    std::thread                       fThread;
 
-    FBCCompiler(interpreter_dsp_factory_aux<REAL,0>* factory, CompiledBlocksType* map) : FBCInterpreter<REAL,0>(factory)
-    {
-        fCompiledBlocks = map;
+    // The compilers use global states (like the LLVM global context)
+    static std::mutex gCompilerMutex;
 
-        // FBC blocks compilation
-        //CompileBlock(factory->fComputeBlock);
-        CompileBlock(factory->fComputeDSPBlock);
+    void compile()
+    {
+        std::lock_guard<std::mutex> lock(gCompilerMutex);
+    #ifdef MIR_BUILD
+        // Run with interp/MIR compiler
+        fCompiled.store(new FBCMIRCompiler<REAL>(fBlock), std::memory_order_release);
+    #elif LLVM_BUILD
+        // Run with interp/LLVM compiler
+        fCompiled.store(new FBCLLVMCompiler<REAL>(fBlock), std::memory_order_release);
+    #endif
     }
 
-    virtual ~FBCCompiler() {}
+   public:
+    std::atomic<int> fInterpretedCount;  // Number of blocks interpreted while the compiled code was not ready,
+                                         // added by each instance when it switches to the compiled code or is deleted
+    std::atomic<int> fSwapCount;         // Number of instances switched to the compiled code
 
-    void ExecuteBlock(FBCBlockInstruction<REAL>* block, bool compile)
+    FBCTieredBlock(FBCBlockInstruction<REAL>* block, bool background)
+        : fBlock(block), fCompiled(nullptr), fInterpretedCount(0), fSwapCount(0)
     {
-        if (compile && fCompiledBlocks->find(block) == fCompiledBlocks->end()) {
-            CompileBlock(block);
-        }
-
-        // The 'DSP' compute block only is compiled..
-        if (fCompiledBlocks->find(block) != fCompiledBlocks->end()) {
-            ((*fCompiledBlocks)[block])->Execute(this->fIntHeap, this->fRealHeap, this->fInputs, this->fOutputs);
+        if (background) {
+            fThread = std::thread(&FBCTieredBlock::compile, this);
         } else {
-            FBCInterpreter<REAL,0>::ExecuteBlock(block);
+            compile();
         }
     }
 
-   protected:
-    CompiledBlocksType* fCompiledBlocks;
+    virtual ~FBCTieredBlock()
+    {
+        if (fThread.joinable()) fThread.join();
+        std::lock_guard<std::mutex> lock(gCompilerMutex);
+        delete fCompiled.load();
+    }
+
+    FBCBlockInstruction<REAL>* getBlock() { return fBlock; }
 
-    void CompileBlock(FBCBlockInstruction<REAL>* block)
+    FBCExecuteFun<REAL>* getCompiled() { return fCompiled.load(std::memory_order_acquire); }
+};
+
+template <class REAL>
+std::mutex FBCTieredBlock<REAL>::gCompilerMutex;
+
+// FBC compiler
+template <class REAL>
+class FBCCompiler : public FBCInterpreter<REAL,0> {
+   public:
+    FBCCompiler(interpreter_dsp_factory_aux<REAL,0>* factory, FBCTieredBlock<REAL>* tiered_block)
+        : FBCInterpreter<REAL,0>(factory), fTieredBlock(tiered_block), fCompiled(nullptr), fInterpretedCount(0)
+    {}
+
+    virtual ~FBCCompiler() { flushInterpretedCount(); }
+
+    void flushInterpretedCount()
     {
-        if (fCompiledBlocks->find(block) == fCompiledBlocks->end()) {
-        #ifdef MIR_BUILD
-            // Run with interp/MIR compiler
-            (*fCompiledBlocks)[block] = new FBCMIRCompiler<REAL>(block);
-        #elif LLVM_BUILD
-            // Run with interp/LLVM compiler
-            (*fCompiledBlocks)[block] = new FBCLLVMCompiler<REAL>(block);
-        #endif
-        } else {
-            // std::cout << "FBCCompiler: reuse compiled block" << std::endl;
+        fTieredBlock->fInterpretedCount.fetch_add(fInterpretedCount, std::memory_order_relaxed);
+        fInterpretedCount = 0;
+    }
+
+    void ExecuteBlock(FBCBlockInstruction<REAL>* block, bool compile)
+    {
+        // The 'DSP' compute block only is compiled..
+        if (block == fTieredBlock->getBlock()) {
+            // Switch to the compiled code as soon as it is ready
+            if (!fCompiled && (fCompiled = fTieredBlock->getCompiled())) {
+                fTieredBlock->fSwapCount.fetch_add(1, std::memory_order_relaxed);
+                flushInterpretedCount();
+            }
+            if (fCompiled) {
+                fCompiled->Execute(this->fIntHeap, this->fRealHeap, this->fInputs, this->fOutputs);
+                return;
+            }
+            fInterpretedCount++;
         }
+        FBCInterpreter<REAL,0>::ExecuteBlock(block);
     }
+
+   protected:
+    FBCTieredBlock<REAL>* fTieredBlock;  // Shared between all DSP instances
+    FBCExecuteFun<REAL>*  fCompiled;     // Only used by the audio thread
+    int                   fInterpretedCount;  // Blocks interpreted by this instance, not yet added to fTieredBlock
 };
 
 #endif
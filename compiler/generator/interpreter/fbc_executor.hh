@@ -34,6 +34,9 @@ struct FBCExecutor {
     virtual void setIntValue(int offset, int value) {}
     virtual int  getIntValue(int offset) { return -1; }
 
+    virtual void setRealValue(int offset, REAL value) {}
+    virtual REAL getRealValue(int offset) { return REAL(-1); }
+
     virtual void setInput(int offset, REAL* buffer) {}
     virtual void setOutput(int offset, REAL* buffer) {}
 
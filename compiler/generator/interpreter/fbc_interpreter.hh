@@ -55,6 +55,48 @@
 //#define assertInterp(exp) faustassert(exp)
 #define assertInterp(exp)
 
+/*
+ Profiling mode: compiled with INTERP_PROFILE, the interpreter counts the executed sequences of 2 and 3 opcodes,
+ and prints the most frequent ones at exit. Used to choose the superinstructions in gFBCSuperInstructionTable.
+*/
+
+//#define INTERP_PROFILE 1
+
+#ifdef INTERP_PROFILE
+#include <algorithm>
+
+struct FBCSequenceProfiler {
+    std::map<std::vector<int>, long> fSequences;
+    int                              fLast[2] = {-1, -1};
+
+    void count(int opcode)
+    {
+        if (fLast[1] >= 0) fSequences[{fLast[1], opcode}]++;
+        if (fLast[0] >= 0) fSequences[{fLast[0], fLast[1], opcode}]++;
+        fLast[0] = fLast[1];
+        fLast[1] = opcode;
+    }
+
+    ~FBCSequenceProfiler()
+    {
+        std::vector<std::pair<long, std::vector<int>>> sorted;
+        for (const auto& it : fSequences) sorted.push_back(std::make_pair(it.second, it.first));
+        std::sort(sorted.rbegin(), sorted.rend());
+        std::cout << "Most frequent sequences" << std::endl;
+        for (size_t i = 0; i < std::min(sorted.size(), size_t(32)); i++) {
+            std::cout << sorted[i].first;
+            for (int opcode : sorted[i].second) std::cout << " " << gFBCInstructionTable[opcode];
+            std::cout << std::endl;
+        }
+    }
+};
+
+static FBCSequenceProfiler gSequenceProfiler;
+#define profileInstruction(it) gSequenceProfiler.count(it->fOpcode)
+#else
+#define profileInstruction(it)
+#endif
+
 template <class REAL, int TRACE>
 struct interpreter_dsp_factory_aux;
 
@@ -107,9 +149,9 @@ class FBCInterpreter : public FBCExecutor<REAL> {
             }
         }
 
-        void traceInstruction(InstructionIT it)
+        void traceInstruction(FBCBasicInstruction<REAL>* inst)
         {
-            (*it)->write(&fMessage, false, false, false);  // Last param = false means no recursion in branches
+            inst->write(&fMessage, false, false, false);  // Last param = false means no recursion in branches
             push(fMessage.str());
             fMessage.str("");
         }
@@ -117,10 +159,13 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
     InterpreterTrace fTraceContext;
 
-    inline void traceInstruction(InstructionIT it)
+    // Currently executed packed block, to retrieve the original instructions in trace mode
+    FBCPackedBlock<REAL>* fPackedBlock;
+
+    inline void traceInstruction(PackedInstructionIT it)
     {
         if (TRACE >= 4) {
-            fTraceContext.traceInstruction(it);
+            fTraceContext.traceInstruction(fPackedBlock->getSource(it));
         }
     }
 
@@ -145,7 +190,7 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         }
     }
 
-    inline void warningOverflow(InstructionIT it)
+    inline void warningOverflow(PackedInstructionIT it)
     {
         if (TRACE >= 6) return;
 
@@ -161,7 +206,7 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         }
     }
 
-    inline void checkDivZero(InstructionIT it, REAL val)
+    inline void checkDivZero(PackedInstructionIT it, REAL val)
     {
         if (TRACE >= 6) return;
 
@@ -177,7 +222,7 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         }
     }
 
-    inline REAL checkRealAux(InstructionIT it, REAL val)
+    inline REAL checkRealAux(PackedInstructionIT it, REAL val)
     {
         if (TRACE >= 6) return val;
 
@@ -219,7 +264,7 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         return val;
     }
 
-    inline int assertAudioBuffer(InstructionIT it, int index)
+    inline int assertAudioBuffer(PackedInstructionIT it, int index)
     {
         if (TRACE >= 6) return index;
 
@@ -236,20 +281,20 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         return index;
     }
 
-    inline int assertIntHeap(InstructionIT it, int index, int size = -1)
+    inline int assertIntHeap(PackedInstructionIT it, int index, int size = -1)
     {
         if (TRACE >= 4 &&
-            ((index < 0) || (index >= fFactory->fIntHeapSize) || (size > 0 && (index >= ((*it)->fOffset1 + size))))) {
+            ((index < 0) || (index >= fFactory->fIntHeapSize) || (size > 0 && (index >= (it->fOffset1 + size))))) {
             std::cout << "-------- Interpreter crash trace start --------" << std::endl;
             if (size > 0) {
                 std::cout << "assertIntHeap array: fIntHeapSize ";
-                std::cout << fFactory->fIntHeapSize << " index " << (index - (*it)->fOffset1);
+                std::cout << fFactory->fIntHeapSize << " index " << (index - it->fOffset1);
                 std::cout << " size " << size;
-                std::cout << " name " << (*it)->fName << std::endl;
+                std::cout << " name " << fPackedBlock->getSource(it)->fName << std::endl;
             } else {
                 std::cout << "assertIntHeap scalar: fIntHeapSize ";
                 std::cout << fFactory->fIntHeapSize << " index " << index;
-                std::cout << " name " << (*it)->fName << std::endl;
+                std::cout << " name " << fPackedBlock->getSource(it)->fName << std::endl;
             }
             fTraceContext.write(&std::cout);
             std::cout << "-------- Interpreter crash trace end --------\n\n";
@@ -260,20 +305,20 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         return index;
     }
 
-    inline int assertRealHeap(InstructionIT it, int index, int size = -1)
+    inline int assertRealHeap(PackedInstructionIT it, int index, int size = -1)
     {
         if (TRACE >= 4 &&
-            ((index < 0) || (index >= fFactory->fRealHeapSize) || (size > 0 && (index >= ((*it)->fOffset1 + size))))) {
+            ((index < 0) || (index >= fFactory->fRealHeapSize) || (size > 0 && (index >= (it->fOffset1 + size))))) {
             std::cout << "-------- Interpreter crash trace start --------" << std::endl;
             if (size > 0) {
                 std::cout << "assertRealHeap array: fIntHeapSize ";
-                std::cout << fFactory->fRealHeapSize << " index " << (index - (*it)->fOffset1);
+                std::cout << fFactory->fRealHeapSize << " index " << (index - it->fOffset1);
                 std::cout << " size " << size;
-                std::cout << " name " << (*it)->fName << std::endl;
+                std::cout << " name " << fPackedBlock->getSource(it)->fName << std::endl;
             } else {
                 std::cout << "assertRealHeap scalar: fIntHeapSize ";
                 std::cout << fFactory->fRealHeapSize << " index " << index;
-                std::cout << " name " << (*it)->fName << std::endl;
+                std::cout << " name " << fPackedBlock->getSource(it)->fName << std::endl;
             }
             fTraceContext.write(&std::cout);
             std::cout << "-------- Interpreter crash trace end --------\n\n";
@@ -284,7 +329,7 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         return index;
     }
 
-    inline int assertSoundHeap(InstructionIT it, int index, int size = -1)
+    inline int assertSoundHeap(PackedInstructionIT it, int index, int size = -1)
     {
         if (TRACE >= 4 && ((index < 0) || (index >= fFactory->fSoundHeapSize) || (size > 0 && index >= size))) {
             std::cout << "-------- Interpreter crash trace start --------" << std::endl;
@@ -300,24 +345,24 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         return index;
     }
 
-    inline int assertLoadIntHeap(InstructionIT it, int index, int size = -1)
+    inline int assertLoadIntHeap(PackedInstructionIT it, int index, int size = -1)
     {
         if ((TRACE >= 4) &&
             ((index < 0)
              || (index >= fFactory->fIntHeapSize)
-             || (size > 0 && (index >= ((*it)->fOffset1 + size)))
+             || (size > 0 && (index >= (it->fOffset1 + size)))
              || (fIntHeap[index] == DUMMY_INT))) {
             std::cout << "-------- Interpreter crash trace start --------" << std::endl;
             if (size > 0) {
                 std::cout << "assertLoadIntHeap array: fIntHeapSize ";
-                std::cout << fFactory->fIntHeapSize << " index " << (index - (*it)->fOffset1);
+                std::cout << fFactory->fIntHeapSize << " index " << (index - it->fOffset1);
                 std::cout << " size " << size;
                 std::cout << " value " << fIntHeap[index];
-                std::cout << " name " << (*it)->fName << std::endl;
+                std::cout << " name " << fPackedBlock->getSource(it)->fName << std::endl;
             } else {
                 std::cout << "assertLoadIntHeap scalar: fIntHeapSize ";
                 std::cout << fFactory->fIntHeapSize << " index " << index;
-                std::cout << " name " << (*it)->fName << std::endl;
+                std::cout << " name " << fPackedBlock->getSource(it)->fName << std::endl;
             }
             fTraceContext.write(&std::cout);
             std::cout << "-------- Interpreter crash trace end --------\n\n";
@@ -328,24 +373,24 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         return index;
     }
 
-    inline int assertLoadRealHeap(InstructionIT it, int index, int size = -1)
+    inline int assertLoadRealHeap(PackedInstructionIT it, int index, int size = -1)
     {
         if ((TRACE >= 4) &&
             ((index < 0)
              || (index >= fFactory->fRealHeapSize)
-             || (size > 0 && (index >= ((*it)->fOffset1 + size)))
+             || (size > 0 && (index >= (it->fOffset1 + size)))
              || (fRealHeap[index] == REAL(DUMMY_REAL)))) {
             std::cout << "-------- Interpreter crash trace start --------" << std::endl;
             if (size > 0) {
                 std::cout << "assertLoadRealHeap array: fRealHeapSize ";
-                std::cout << fFactory->fRealHeapSize << " index " << (index - (*it)->fOffset1);
+                std::cout << fFactory->fRealHeapSize << " index " << (index - it->fOffset1);
                 std::cout << " size " << size;
                 std::cout << " value " << fRealHeap[index];
-                std::cout << " name " << (*it)->fName << std::endl;
+                std::cout << " name " << fPackedBlock->getSource(it)->fName << std::endl;
             } else {
                 std::cout << "assertLoadRealHeap scalar: fRealHeapSize ";
                 std::cout << fFactory->fRealHeapSize << " index " << index;
-                std::cout << " name " << (*it)->fName << std::endl;
+                std::cout << " name " << fPackedBlock->getSource(it)->fName << std::endl;
             }
             fTraceContext.write(&std::cout);
             std::cout << "-------- Interpreter crash trace end --------\n\n";
@@ -356,7 +401,7 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         return index;
     }
     
-    inline void assertIndex(InstructionIT it, int index, int size = -1)
+    inline void assertIndex(PackedInstructionIT it, int index, int size = -1)
     {
         if ((TRACE >= 4) && ((index < 0) || (index >= size))) {
             std::cout << "-------- Interpreter crash trace start --------" << std::endl;
@@ -370,7 +415,7 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         }
     }
 
-    inline REAL checkReal(InstructionIT it, REAL val) { return (TRACE > 0) ? checkRealAux(it, val) : val; }
+    inline REAL checkReal(PackedInstructionIT it, REAL val) { return (TRACE > 0) ? checkRealAux(it, val) : val; }
 
 #define pushInt(val) (int_stack[int_stack_index++] = val)
 #define popInt() (int_stack[--int_stack_index])
@@ -555,7 +600,12 @@ class FBCInterpreter : public FBCExecutor<REAL> {
             &&do_kLoop, &&do_kReturn,
 
             // Select/if
-            &&do_kIf, &&do_kSelectReal, &&do_kSelectInt, &&do_kCondBranch
+            &&do_kIf, &&do_kSelectReal, &&do_kSelectInt, &&do_kCondBranch,
+
+            // Superinstructions
+            &&do_kStoreAddIntValue, &&do_kLoopStepIntHeap, &&do_kLoopStepIntValue, &&do_kLoadInputHeap,
+            &&do_kStoreOutputHeap, &&do_kStoreIndexedRealHeap, &&do_kMultAddRealHeap, &&do_kMultAddRealStack,
+            &&do_kAddMultRealStack, &&do_kSubStoreReal
 
         };
 
@@ -567,37 +617,38 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         REAL          real_stack[512];
         int           int_stack[512];
         Soundfile*    sound_stack[512];
-        InstructionIT address_stack[64];
+        PackedInstructionIT address_stack[64];
 
-#define dispatchFirstScal()                   \
-    {                                         \
-        goto *fDispatchTable[(*it)->fOpcode]; \
+#define dispatchFirstScal()            \
+    {                                  \
+        goto *fDispatchTable[it->fOpcode]; \
     }
-#define dispatchNextScal()                    \
-    {                                         \
-        traceInstruction(it);                 \
-        it++;                                 \
-        goto *fDispatchTable[(*it)->fOpcode]; \
+#define dispatchNextScal()             \
+    {                                  \
+        traceInstruction(it);          \
+        profileInstruction(it);        \
+        it++;                          \
+        goto *fDispatchTable[it->fOpcode]; \
     }
 
-#define dispatchBranch1Scal()                        \
-    {                                                \
-        it = (*it)->fBranch1->fInstructions.begin(); \
-        dispatchFirstScal();                         \
+#define dispatchBranch1Scal()  \
+    {                          \
+        it += it->fBranch1;    \
+        dispatchFirstScal();   \
     }
-#define dispatchBranch2Scal()                        \
-    {                                                \
-        it = (*it)->fBranch2->fInstructions.begin(); \
-        dispatchFirstScal();                         \
+#define dispatchBranch2Scal()  \
+    {                          \
+        it += it->fBranch2;    \
+        dispatchFirstScal();   \
     }
 
-#define pushBranch1Scal()                                  \
-    {                                                      \
-        pushAddr_((*it)->fBranch1->fInstructions.begin()); \
+#define pushBranch1Scal()                \
+    {                                    \
+        pushAddr_(it + it->fBranch1);    \
     }
-#define pushBranch2Scal()                                  \
-    {                                                      \
-        pushAddr_((*it)->fBranch2->fInstructions.begin()); \
+#define pushBranch2Scal()                \
+    {                                    \
+        pushAddr_(it + it->fBranch2);    \
     }
 
 #define dispatchReturnScal() \
@@ -614,44 +665,49 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         // Check block coherency
         block->check();
 
-        InstructionIT it = block->fInstructions.begin();
+        // Execute the packed form of the block, lowered by the factory
+        fPackedBlock                = block->getPacked();
+        faustassert(fPackedBlock);
+        const REAL* real_tables     = fPackedBlock->fRealTables.data();
+        const int*  int_tables      = fPackedBlock->fIntTables.data();
+        PackedInstructionIT it      = fPackedBlock->fCode.data();
         dispatchFirstScal();
 
     // Number operations
     do_kRealValue : {
-        pushReal(it, (*it)->fRealValue);
+        pushReal(it, it->fRealValue);
         dispatchNextScal();
     }
 
     do_kInt32Value : {
-        pushInt((*it)->fIntValue);
+        pushInt(it->fIntValue);
         dispatchNextScal();
     }
 
     // Memory operations
     do_kLoadReal : {
         if (TRACE > 0) {
-            pushReal(it, fRealHeap[assertLoadRealHeap(it, (*it)->fOffset1)]);
+            pushReal(it, fRealHeap[assertLoadRealHeap(it, it->fOffset1)]);
         } else {
-            pushReal(it, fRealHeap[(*it)->fOffset1]);
+            pushReal(it, fRealHeap[it->fOffset1]);
         }
         dispatchNextScal();
     }
 
     do_kLoadInt : {
         if (TRACE > 0) {
-            pushInt(fIntHeap[assertLoadIntHeap(it, (*it)->fOffset1)]);
+            pushInt(fIntHeap[assertLoadIntHeap(it, it->fOffset1)]);
         } else {
-            pushInt(fIntHeap[(*it)->fOffset1]);
+            pushInt(fIntHeap[it->fOffset1]);
         }
         dispatchNextScal();
     }
 
     do_kLoadSound : {
         if (TRACE > 0) {
-            pushSound(fSoundHeap[assertSoundHeap(it, (*it)->fOffset1)]);
+            pushSound(fSoundHeap[assertSoundHeap(it, it->fOffset1)]);
         } else {
-            pushSound(fSoundHeap[(*it)->fOffset1]);
+            pushSound(fSoundHeap[it->fOffset1]);
         }
         dispatchNextScal();
     }
@@ -659,9 +715,9 @@ class FBCInterpreter : public FBCExecutor<REAL> {
     do_kLoadSoundField : {
         /*
         if (TRACE > 0) {
-            pushSound(fSoundHeap[assertSoundHeap(it, (*it)->fOffset1)]);
+            pushSound(fSoundHeap[assertSoundHeap(it, it->fOffset1)]);
         } else {
-            pushSound(fSoundHeap[(*it)->fOffset1]);
+            pushSound(fSoundHeap[it->fOffset1]);
         }
         dispatchNextScal();
         */
@@ -669,18 +725,18 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
     do_kStoreReal : {
         if (TRACE > 0) {
-            fRealHeap[assertRealHeap(it, (*it)->fOffset1)] = popReal(it);
+            fRealHeap[assertRealHeap(it, it->fOffset1)] = popReal(it);
         } else {
-            fRealHeap[(*it)->fOffset1] = popReal(it);
+            fRealHeap[it->fOffset1] = popReal(it);
         }
         dispatchNextScal();
     }
 
     do_kStoreInt : {
         if (TRACE > 0) {
-            fIntHeap[assertIntHeap(it, (*it)->fOffset1)] = popInt();
+            fIntHeap[assertIntHeap(it, it->fOffset1)] = popInt();
         } else {
-            fIntHeap[(*it)->fOffset1] = popInt();
+            fIntHeap[it->fOffset1] = popInt();
         }
         dispatchNextScal();
     }
@@ -688,9 +744,9 @@ class FBCInterpreter : public FBCExecutor<REAL> {
     do_kStoreSound : {
         /*
         if (TRACE > 0) {
-            fSoundHeap[assertSoundHeap(it, (*it)->fOffset1)] = popSound();
+            fSoundHeap[assertSoundHeap(it, it->fOffset1)] = popSound();
         } else {
-            fSoundHeap[(*it)->fOffset1] = popSound();
+            fSoundHeap[it->fOffset1] = popSound();
         }
         */
         dispatchNextScal();
@@ -699,18 +755,18 @@ class FBCInterpreter : public FBCExecutor<REAL> {
     // Directly store a value
     do_kStoreRealValue : {
         if (TRACE > 0) {
-            fRealHeap[assertRealHeap(it, (*it)->fOffset1)] = (*it)->fRealValue;
+            fRealHeap[assertRealHeap(it, it->fOffset1)] = it->fRealValue;
         } else {
-            fRealHeap[(*it)->fOffset1] = (*it)->fRealValue;
+            fRealHeap[it->fOffset1] = it->fRealValue;
         }
         dispatchNextScal();
     }
 
     do_kStoreIntValue : {
         if (TRACE > 0) {
-            fIntHeap[assertIntHeap(it, (*it)->fOffset1)] = (*it)->fIntValue;
+            fIntHeap[assertIntHeap(it, it->fOffset1)] = it->fIntValue;
         } else {
-            fIntHeap[(*it)->fOffset1] = (*it)->fIntValue;
+            fIntHeap[it->fOffset1] = it->fIntValue;
         }
         dispatchNextScal();
     }
@@ -719,10 +775,10 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         int offset = popInt();
         if (TRACE > 0) {
             // DEBUG
-            // assertIndex(it, offset, (*it)->fOffset2);
-            pushReal(it, fRealHeap[assertLoadRealHeap(it, (*it)->fOffset1 + offset, (*it)->fOffset2)]);
+            // assertIndex(it, offset, it->fOffset2);
+            pushReal(it, fRealHeap[assertLoadRealHeap(it, it->fOffset1 + offset, it->fOffset2)]);
         } else {
-            pushReal(it, fRealHeap[(*it)->fOffset1 + offset]);
+            pushReal(it, fRealHeap[it->fOffset1 + offset]);
         }
         dispatchNextScal();
     }
@@ -731,10 +787,10 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         int offset = popInt();
         if (TRACE > 0) {
             // DEBUG
-            // assertIndex(it, offset, (*it)->fOffset2);
-            pushInt(fIntHeap[assertLoadIntHeap(it, (*it)->fOffset1 + offset, (*it)->fOffset2)]);
+            // assertIndex(it, offset, it->fOffset2);
+            pushInt(fIntHeap[assertLoadIntHeap(it, it->fOffset1 + offset, it->fOffset2)]);
         } else {
-            pushInt(fIntHeap[(*it)->fOffset1 + offset]);
+            pushInt(fIntHeap[it->fOffset1 + offset]);
         }
         dispatchNextScal();
     }
@@ -743,10 +799,10 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         int offset = popInt();
         if (TRACE > 0) {
             // DEBUG
-            // assertIndex(it, offset, (*it)->fOffset2);
-            fRealHeap[assertRealHeap(it, (*it)->fOffset1 + offset, (*it)->fOffset2)] = popReal(it);
+            // assertIndex(it, offset, it->fOffset2);
+            fRealHeap[assertRealHeap(it, it->fOffset1 + offset, it->fOffset2)] = popReal(it);
         } else {
-            fRealHeap[(*it)->fOffset1 + offset] = popReal(it);
+            fRealHeap[it->fOffset1 + offset] = popReal(it);
         }
         dispatchNextScal();
     }
@@ -755,77 +811,73 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         int offset = popInt();
         if (TRACE > 0) {
             // DEBUG
-            // assertIndex(it, offset, (*it)->fOffset2);
-            fIntHeap[assertIntHeap(it, (*it)->fOffset1 + offset, (*it)->fOffset2)] = popInt();
+            // assertIndex(it, offset, it->fOffset2);
+            fIntHeap[assertIntHeap(it, it->fOffset1 + offset, it->fOffset2)] = popInt();
         } else {
-            fIntHeap[(*it)->fOffset1 + offset] = popInt();
+            fIntHeap[it->fOffset1 + offset] = popInt();
         }
         dispatchNextScal();
     }
 
     do_kBlockStoreReal : {
-        FIRBlockStoreRealInstruction<REAL>* inst = static_cast<FIRBlockStoreRealInstruction<REAL>*>(*it);
-        assertInterp(inst);
-        for (int i = 0; i < inst->fOffset2; i++) {
-            fRealHeap[inst->fOffset1 + i] = inst->fNumTable[i];
+        for (int i = 0; i < it->fOffset2; i++) {
+            fRealHeap[it->fOffset1 + i] = real_tables[it->fIntValue + i];
         }
         dispatchNextScal();
     }
 
     do_kBlockStoreInt : {
-        FIRBlockStoreIntInstruction<REAL>* inst = static_cast<FIRBlockStoreIntInstruction<REAL>*>(*it);
-        assertInterp(inst);
-        for (int i = 0; i < inst->fOffset2; i++) {
-            fIntHeap[inst->fOffset1 + i] = inst->fNumTable[i];
+        for (int i = 0; i < it->fOffset2; i++) {
+            fIntHeap[it->fOffset1 + i] = int_tables[it->fIntValue + i];
         }
         dispatchNextScal();
     }
 
     do_kMoveReal : {
-        fRealHeap[(*it)->fOffset1] = fRealHeap[(*it)->fOffset2];
+        fRealHeap[it->fOffset1] = fRealHeap[it->fOffset2];
         dispatchNextScal();
     }
 
     do_kMoveInt : {
-        fIntHeap[(*it)->fOffset1] = fIntHeap[(*it)->fOffset2];
+        fIntHeap[it->fOffset1] = fIntHeap[it->fOffset2];
         dispatchNextScal();
     }
 
     do_kPairMoveReal : {
-        fRealHeap[(*it)->fOffset1] = fRealHeap[(*it)->fOffset1 - 1];
-        fRealHeap[(*it)->fOffset2] = fRealHeap[(*it)->fOffset2 - 1];
+        fRealHeap[it->fOffset1] = fRealHeap[it->fOffset1 - 1];
+        fRealHeap[it->fOffset2] = fRealHeap[it->fOffset2 - 1];
         dispatchNextScal();
     }
 
     do_kPairMoveInt : {
-        fIntHeap[(*it)->fOffset1] = fIntHeap[(*it)->fOffset1 - 1];
-        fIntHeap[(*it)->fOffset2] = fIntHeap[(*it)->fOffset2 - 1];
+        fIntHeap[it->fOffset1] = fIntHeap[it->fOffset1 - 1];
+        fIntHeap[it->fOffset2] = fIntHeap[it->fOffset2 - 1];
         dispatchNextScal();
     }
 
     do_kBlockPairMoveReal : {
-        for (int i = (*it)->fOffset1; i < (*it)->fOffset2; i += 2) {
+        for (int i = it->fOffset1; i < it->fOffset2; i += 2) {
             fRealHeap[i + 1] = fRealHeap[i];
         }
         dispatchNextScal();
     }
 
     do_kBlockPairMoveInt : {
-        for (int i = (*it)->fOffset1; i < (*it)->fOffset2; i += 2) {
+        for (int i = it->fOffset1; i < it->fOffset2; i += 2) {
             fIntHeap[i + 1] = fIntHeap[i];
         }
         dispatchNextScal();
     }
 
     do_kBlockShiftReal : {
-        for (int i = (*it)->fOffset1; i > (*it)->fOffset2; i -= 1) {
+        for (int i = it->fOffset1; i > it->fOffset2; i -= 1) {
             fRealHeap[i] = fRealHeap[i - 1];
         }
         dispatchNextScal();
     }
 
     do_kBlockShiftInt : {
-        for (int i = (*it)->fOffset1; i > (*it)->fOffset2; i -= 1) {
+        for (int i = it->fOffset1; i > it->fOffset2; i -= 1) {
             fIntHeap[i] = fIntHeap[i - 1];
         }
         dispatchNextScal();
@@ -834,28 +886,28 @@ class FBCInterpreter : public FBCExecutor<REAL> {
     // Input/output access
     do_kLoadInput : {
         if (TRACE > 0) {
-            pushReal(it, fInputs[(*it)->fOffset1][assertAudioBuffer(it, popInt())]);
+            pushReal(it, fInputs[it->fOffset1][assertAudioBuffer(it, popInt())]);
         } else {
             /*
             int index = popInt();
-            pushReal(it, fInputs[(*it)->fOffset1][index]);
+            pushReal(it, fInputs[it->fOffset1][index]);
             std::cout << "do_kLoadInput " << index << std::endl;
             */
-            pushReal(it, fInputs[(*it)->fOffset1][popInt()]);
+            pushReal(it, fInputs[it->fOffset1][popInt()]);
         }
         dispatchNextScal();
     }
 
     do_kStoreOutput : {
         if (TRACE > 0) {
-            fOutputs[(*it)->fOffset1][assertAudioBuffer(it, popInt())] = popReal(it);
+            fOutputs[it->fOffset1][assertAudioBuffer(it, popInt())] = popReal(it);
         } else {
             /*
             int index = popInt();
             std::cout << "do_kStoreOutput " << index << std::endl;
-            fOutputs[(*it)->fOffset1][index] = popReal(it);
+            fOutputs[it->fOffset1][index] = popReal(it);
             */
-            fOutputs[(*it)->fOffset1][popInt()] = popReal(it);
+            fOutputs[it->fOffset1][popInt()] = popReal(it);
         }
         dispatchNextScal();
     }
@@ -867,7 +919,7 @@ class FBCInterpreter : public FBCExecutor<REAL> {
     }
 
     do_kCastRealHeap : {
-        pushReal(it, REAL(fIntHeap[(*it)->fOffset1]));
+        pushReal(it, REAL(fIntHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
@@ -886,13 +938,13 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
     do_kCastIntHeap : {
         if (TRACE >= 3) {
-            REAL val = fRealHeap[(*it)->fOffset1];
+            REAL val = fRealHeap[it->fOffset1];
             if (val > std::numeric_limits<int>::max() || val < std::numeric_limits<int>::min()) {
                 fRealStats[CAST_INT_OVERFLOW]++;
             }
             pushInt(int(val));
         } else {
-            pushInt(int(fRealHeap[(*it)->fOffset1]));
+            pushInt(int(fRealHeap[it->fOffset1]));
         }
         dispatchNextScal();
     }
@@ -1158,147 +1210,147 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         //-----------------------------------------------------
 
     do_kAddRealHeap : {
-        pushReal(it, fRealHeap[(*it)->fOffset1] + fRealHeap[(*it)->fOffset2]);
+        pushReal(it, fRealHeap[it->fOffset1] + fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kAddIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] + fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] + fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kSubRealHeap : {
-        pushReal(it, fRealHeap[(*it)->fOffset1] - fRealHeap[(*it)->fOffset2]);
+        pushReal(it, fRealHeap[it->fOffset1] - fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kSubIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] - fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] - fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kMultRealHeap : {
-        pushReal(it, fRealHeap[(*it)->fOffset1] * fRealHeap[(*it)->fOffset2]);
+        pushReal(it, fRealHeap[it->fOffset1] * fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kMultIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] * fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] * fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kDivRealHeap : {
-        pushReal(it, fRealHeap[(*it)->fOffset1] / fRealHeap[(*it)->fOffset2]);
+        pushReal(it, fRealHeap[it->fOffset1] / fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kDivIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] / fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] / fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kRemRealHeap : {
-        pushReal(it, std::remainder(fRealHeap[(*it)->fOffset1], fRealHeap[(*it)->fOffset2]));
+        pushReal(it, std::remainder(fRealHeap[it->fOffset1], fRealHeap[it->fOffset2]));
         dispatchNextScal();
     }
 
     do_kRemIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] % fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] % fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     // Shift operation
     do_kLshIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] << fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] << fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kARshIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] >> fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] >> fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
         
     do_kLRshIntHeap : {
         // TODO
-        pushInt(fIntHeap[(*it)->fOffset1] >> fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] >> fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     // Comparaison Int
     do_kGTIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] > fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] > fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kLTIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] < fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] < fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kGEIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] >= fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] >= fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kLEIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] <= fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] <= fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kEQIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] == fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] == fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kNEIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] != fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] != fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     // Comparaison Real
     do_kGTRealHeap : {
-        pushInt(fRealHeap[(*it)->fOffset1] > fRealHeap[(*it)->fOffset2]);
+        pushInt(fRealHeap[it->fOffset1] > fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kLTRealHeap : {
-        pushInt(fRealHeap[(*it)->fOffset1] < fRealHeap[(*it)->fOffset2]);
+        pushInt(fRealHeap[it->fOffset1] < fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kGERealHeap : {
-        pushInt(fRealHeap[(*it)->fOffset1] >= fRealHeap[(*it)->fOffset2]);
+        pushInt(fRealHeap[it->fOffset1] >= fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kLERealHeap : {
-        pushInt(fRealHeap[(*it)->fOffset1] <= fRealHeap[(*it)->fOffset2]);
+        pushInt(fRealHeap[it->fOffset1] <= fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kEQRealHeap : {
-        pushInt(fRealHeap[(*it)->fOffset1] == fRealHeap[(*it)->fOffset2]);
+        pushInt(fRealHeap[it->fOffset1] == fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kNERealHeap : {
-        pushInt(fRealHeap[(*it)->fOffset1] != fRealHeap[(*it)->fOffset2]);
+        pushInt(fRealHeap[it->fOffset1] != fRealHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     // Logical operations
     do_kANDIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] & fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] & fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kORIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] | fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] | fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
     do_kXORIntHeap : {
-        pushInt(fIntHeap[(*it)->fOffset1] ^ fIntHeap[(*it)->fOffset2]);
+        pushInt(fIntHeap[it->fOffset1] ^ fIntHeap[it->fOffset2]);
         dispatchNextScal();
     }
 
@@ -1308,174 +1360,174 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
     do_kAddRealStack : {
         REAL v1 = popReal(it);
-        pushReal(it, fRealHeap[(*it)->fOffset1] + v1);
+        pushReal(it, fRealHeap[it->fOffset1] + v1);
         dispatchNextScal();
     }
 
     do_kAddIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] + v1);
+        pushInt(fIntHeap[it->fOffset1] + v1);
         dispatchNextScal();
     }
 
     do_kSubRealStack : {
         REAL v1 = popReal(it);
-        pushReal(it, fRealHeap[(*it)->fOffset1] - v1);
+        pushReal(it, fRealHeap[it->fOffset1] - v1);
         dispatchNextScal();
     }
 
     do_kSubIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] - v1);
+        pushInt(fIntHeap[it->fOffset1] - v1);
         dispatchNextScal();
     }
 
     do_kMultRealStack : {
         REAL v1 = popReal(it);
-        pushReal(it, fRealHeap[(*it)->fOffset1] * v1);
+        pushReal(it, fRealHeap[it->fOffset1] * v1);
         dispatchNextScal();
     }
 
     do_kMultIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] * v1);
+        pushInt(fIntHeap[it->fOffset1] * v1);
         dispatchNextScal();
     }
 
     do_kDivRealStack : {
         REAL v1 = popReal(it);
-        pushReal(it, fRealHeap[(*it)->fOffset1] / v1);
+        pushReal(it, fRealHeap[it->fOffset1] / v1);
         dispatchNextScal();
     }
 
     do_kDivIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] / v1);
+        pushInt(fIntHeap[it->fOffset1] / v1);
         dispatchNextScal();
     }
 
     do_kRemRealStack : {
         REAL v1 = popReal(it);
-        pushReal(it, std::remainder(fRealHeap[(*it)->fOffset1], v1));
+        pushReal(it, std::remainder(fRealHeap[it->fOffset1], v1));
         dispatchNextScal();
     }
 
     do_kRemIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] % v1);
+        pushInt(fIntHeap[it->fOffset1] % v1);
         dispatchNextScal();
     }
 
     // Shift operation
     do_kLshIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] << v1);
+        pushInt(fIntHeap[it->fOffset1] << v1);
         dispatchNextScal();
     }
 
     do_kARshIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] >> v1);
+        pushInt(fIntHeap[it->fOffset1] >> v1);
         dispatchNextScal();
     }
         
     do_kLRshIntStack : {
         // TODO
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] >> v1);
+        pushInt(fIntHeap[it->fOffset1] >> v1);
         dispatchNextScal();
     }
 
     // Comparaison Int
     do_kGTIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] > v1);
+        pushInt(fIntHeap[it->fOffset1] > v1);
         dispatchNextScal();
     }
 
     do_kLTIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] < v1);
+        pushInt(fIntHeap[it->fOffset1] < v1);
         dispatchNextScal();
     }
 
     do_kGEIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] >= v1);
+        pushInt(fIntHeap[it->fOffset1] >= v1);
         dispatchNextScal();
     }
 
     do_kLEIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] <= v1);
+        pushInt(fIntHeap[it->fOffset1] <= v1);
         dispatchNextScal();
     }
 
     do_kEQIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] == v1);
+        pushInt(fIntHeap[it->fOffset1] == v1);
         dispatchNextScal();
     }
 
     do_kNEIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] != v1);
+        pushInt(fIntHeap[it->fOffset1] != v1);
         dispatchNextScal();
     }
 
     // Comparaison Real
     do_kGTRealStack : {
         REAL v1 = popReal(it);
-        pushInt(fRealHeap[(*it)->fOffset1] > v1);
+        pushInt(fRealHeap[it->fOffset1] > v1);
         dispatchNextScal();
     }
 
     do_kLTRealStack : {
         REAL v1 = popReal(it);
-        pushInt(fRealHeap[(*it)->fOffset1] < v1);
+        pushInt(fRealHeap[it->fOffset1] < v1);
         dispatchNextScal();
     }
 
     do_kGERealStack : {
         REAL v1 = popReal(it);
-        pushInt(fRealHeap[(*it)->fOffset1] >= v1);
+        pushInt(fRealHeap[it->fOffset1] >= v1);
         dispatchNextScal();
     }
 
     do_kLERealStack : {
         REAL v1 = popReal(it);
-        pushInt(fRealHeap[(*it)->fOffset1] <= v1);
+        pushInt(fRealHeap[it->fOffset1] <= v1);
         dispatchNextScal();
     }
 
     do_kEQRealStack : {
         REAL v1 = popReal(it);
-        pushInt(fRealHeap[(*it)->fOffset1] == v1);
+        pushInt(fRealHeap[it->fOffset1] == v1);
         dispatchNextScal();
     }
 
     do_kNERealStack : {
         REAL v1 = popReal(it);
-        pushInt(fRealHeap[(*it)->fOffset1] != v1);
+        pushInt(fRealHeap[it->fOffset1] != v1);
         dispatchNextScal();
     }
 
     // Logical operations
     do_kANDIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] & v1);
+        pushInt(fIntHeap[it->fOffset1] & v1);
         dispatchNextScal();
     }
 
     do_kORIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] | v1);
+        pushInt(fIntHeap[it->fOffset1] | v1);
         dispatchNextScal();
     }
 
     do_kXORIntStack : {
         int v1 = popInt();
-        pushInt(fIntHeap[(*it)->fOffset1] ^ v1);
+        pushInt(fIntHeap[it->fOffset1] ^ v1);
         dispatchNextScal();
     }
 
@@ -1485,174 +1537,174 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
     do_kAddRealStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, (*it)->fRealValue + v1);
+        pushReal(it, it->fRealValue + v1);
         dispatchNextScal();
     }
 
     do_kAddIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue + v1);
+        pushInt(it->fIntValue + v1);
         dispatchNextScal();
     }
 
     do_kSubRealStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, (*it)->fRealValue - v1);
+        pushReal(it, it->fRealValue - v1);
         dispatchNextScal();
     }
 
     do_kSubIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue - v1);
+        pushInt(it->fIntValue - v1);
         dispatchNextScal();
     }
 
     do_kMultRealStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, (*it)->fRealValue * v1);
+        pushReal(it, it->fRealValue * v1);
         dispatchNextScal();
     }
 
     do_kMultIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue * v1);
+        pushInt(it->fIntValue * v1);
         dispatchNextScal();
     }
 
     do_kDivRealStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, (*it)->fRealValue / v1);
+        pushReal(it, it->fRealValue / v1);
         dispatchNextScal();
     }
 
     do_kDivIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue / v1);
+        pushInt(it->fIntValue / v1);
         dispatchNextScal();
     }
 
     do_kRemRealStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, std::remainder((*it)->fRealValue, v1));
+        pushReal(it, std::remainder(it->fRealValue, v1));
         dispatchNextScal();
     }
 
     do_kRemIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue % v1);
+        pushInt(it->fIntValue % v1);
         dispatchNextScal();
     }
 
     // Shift operation
     do_kLshIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue << v1);
+        pushInt(it->fIntValue << v1);
         dispatchNextScal();
     }
 
     do_kARshIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue >> v1);
+        pushInt(it->fIntValue >> v1);
         dispatchNextScal();
     }
         
     do_kLRshIntStackValue : {
         // TODO
         int v1 = popInt();
-        pushInt((*it)->fIntValue >> v1);
+        pushInt(it->fIntValue >> v1);
         dispatchNextScal();
     }
 
     // Comparaison Int
     do_kGTIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue > v1);
+        pushInt(it->fIntValue > v1);
         dispatchNextScal();
     }
 
     do_kLTIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue < v1);
+        pushInt(it->fIntValue < v1);
         dispatchNextScal();
     }
 
     do_kGEIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue >= v1);
+        pushInt(it->fIntValue >= v1);
         dispatchNextScal();
     }
 
     do_kLEIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue <= v1);
+        pushInt(it->fIntValue <= v1);
         dispatchNextScal();
     }
 
     do_kEQIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue == v1);
+        pushInt(it->fIntValue == v1);
         dispatchNextScal();
     }
 
     do_kNEIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue != v1);
+        pushInt(it->fIntValue != v1);
         dispatchNextScal();
     }
 
     // Comparaison Real
     do_kGTRealStackValue : {
         REAL v1 = popReal(it);
-        pushInt((*it)->fRealValue > v1);
+        pushInt(it->fRealValue > v1);
         dispatchNextScal();
     }
 
     do_kLTRealStackValue : {
         REAL v1 = popReal(it);
-        pushInt((*it)->fRealValue < v1);
+        pushInt(it->fRealValue < v1);
         dispatchNextScal();
     }
 
     do_kGERealStackValue : {
         REAL v1 = popReal(it);
-        pushInt((*it)->fRealValue >= v1);
+        pushInt(it->fRealValue >= v1);
         dispatchNextScal();
     }
 
     do_kLERealStackValue : {
         REAL v1 = popReal(it);
-        pushInt((*it)->fRealValue <= v1);
+        pushInt(it->fRealValue <= v1);
         dispatchNextScal();
     }
 
     do_kEQRealStackValue : {
         REAL v1 = popReal(it);
-        pushInt((*it)->fRealValue == v1);
+        pushInt(it->fRealValue == v1);
         dispatchNextScal();
     }
 
     do_kNERealStackValue : {
         REAL v1 = popReal(it);
-        pushInt((*it)->fRealValue != v1);
+        pushInt(it->fRealValue != v1);
         dispatchNextScal();
     }
 
     // Logical operations
     do_kANDIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue & v1);
+        pushInt(it->fIntValue & v1);
         dispatchNextScal();
     }
 
     do_kORIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue | v1);
+        pushInt(it->fIntValue | v1);
         dispatchNextScal();
     }
 
     do_kXORIntStackValue : {
         int v1 = popInt();
-        pushInt((*it)->fIntValue ^ v1);
+        pushInt(it->fIntValue ^ v1);
         dispatchNextScal();
     }
 
@@ -1661,147 +1713,147 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         //------------------------------------------------------
 
     do_kAddRealValue : {
-        pushReal(it, (*it)->fRealValue + fRealHeap[(*it)->fOffset1]);
+        pushReal(it, it->fRealValue + fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kAddIntValue : {
-        pushInt((*it)->fIntValue + fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue + fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kSubRealValue : {
-        pushReal(it, (*it)->fRealValue - fRealHeap[(*it)->fOffset1]);
+        pushReal(it, it->fRealValue - fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kSubIntValue : {
-        pushInt((*it)->fIntValue - fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue - fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kMultRealValue : {
-        pushReal(it, (*it)->fRealValue * fRealHeap[(*it)->fOffset1]);
+        pushReal(it, it->fRealValue * fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kMultIntValue : {
-        pushInt((*it)->fIntValue * fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue * fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kDivRealValue : {
-        pushReal(it, (*it)->fRealValue / fRealHeap[(*it)->fOffset1]);
+        pushReal(it, it->fRealValue / fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kDivIntValue : {
-        pushInt((*it)->fIntValue / fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue / fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kRemRealValue : {
-        pushReal(it, std::remainder((*it)->fRealValue, fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::remainder(it->fRealValue, fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kRemIntValue : {
-        pushInt((*it)->fIntValue % fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue % fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     // Shift operation
     do_kLshIntValue : {
-        pushInt((*it)->fIntValue << fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue << fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kARshIntValue : {
-        pushInt((*it)->fIntValue >> fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue >> fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
         
     do_kLRshIntValue : {
         // TODO
-        pushInt((*it)->fIntValue >> fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue >> fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     // Comparaison Int
     do_kGTIntValue : {
-        pushInt((*it)->fIntValue > fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue > fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kLTIntValue : {
-        pushInt((*it)->fIntValue < fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue < fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kGEIntValue : {
-        pushInt((*it)->fIntValue >= fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue >= fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kLEIntValue : {
-        pushInt((*it)->fIntValue <= fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue <= fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kEQIntValue : {
-        pushInt((*it)->fIntValue == fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue == fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kNEIntValue : {
-        pushInt((*it)->fIntValue != fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue != fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     // Comparaison Real
     do_kGTRealValue : {
-        pushInt((*it)->fRealValue > fRealHeap[(*it)->fOffset1]);
+        pushInt(it->fRealValue > fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kLTRealValue : {
-        pushInt((*it)->fRealValue < fRealHeap[(*it)->fOffset1]);
+        pushInt(it->fRealValue < fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kGERealValue : {
-        pushInt((*it)->fRealValue >= fRealHeap[(*it)->fOffset1]);
+        pushInt(it->fRealValue >= fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kLERealValue : {
-        pushInt((*it)->fRealValue <= fRealHeap[(*it)->fOffset1]);
+        pushInt(it->fRealValue <= fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kEQRealValue : {
-        pushInt((*it)->fRealValue == fRealHeap[(*it)->fOffset1]);
+        pushInt(it->fRealValue == fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kNERealValue : {
-        pushInt((*it)->fRealValue != fRealHeap[(*it)->fOffset1]);
+        pushInt(it->fRealValue != fRealHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     // Logical operations
     do_kANDIntValue : {
-        pushInt((*it)->fIntValue & fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue & fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kORIntValue : {
-        pushInt((*it)->fIntValue | fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue | fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
     do_kXORIntValue : {
-        pushInt((*it)->fIntValue ^ fIntHeap[(*it)->fOffset1]);
+        pushInt(it->fIntValue ^ fIntHeap[it->fOffset1]);
         dispatchNextScal();
     }
 
@@ -1811,91 +1863,91 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         //----------------------------------------------------
 
     do_kSubRealValueInvert : {
-        pushReal(it, fRealHeap[(*it)->fOffset1] - (*it)->fRealValue);
+        pushReal(it, fRealHeap[it->fOffset1] - it->fRealValue);
         dispatchNextScal();
     }
 
     do_kSubIntValueInvert : {
-        pushInt(fIntHeap[(*it)->fOffset1] - (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] - it->fIntValue);
         dispatchNextScal();
     }
 
     do_kDivRealValueInvert : {
-        pushReal(it, fRealHeap[(*it)->fOffset1] / (*it)->fRealValue);
+        pushReal(it, fRealHeap[it->fOffset1] / it->fRealValue);
         dispatchNextScal();
     }
 
     do_kDivIntValueInvert : {
-        pushInt(fIntHeap[(*it)->fOffset1] / (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] / it->fIntValue);
         dispatchNextScal();
     }
 
     do_kRemRealValueInvert : {
-        pushReal(it, std::remainder(fRealHeap[(*it)->fOffset1], (*it)->fRealValue));
+        pushReal(it, std::remainder(fRealHeap[it->fOffset1], it->fRealValue));
         dispatchNextScal();
     }
 
     do_kRemIntValueInvert : {
-        pushInt(fIntHeap[(*it)->fOffset1] % (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] % it->fIntValue);
         dispatchNextScal();
     }
 
     // Shift operation
     do_kLshIntValueInvert : {
-        pushInt(fIntHeap[(*it)->fOffset1] << (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] << it->fIntValue);
         dispatchNextScal();
     }
 
     do_kARshIntValueInvert : {
-        pushInt(fIntHeap[(*it)->fOffset1] >> (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] >> it->fIntValue);
         dispatchNextScal();
     }
         
     do_kLRshIntValueInvert : {
         // TODO
-        pushInt(fIntHeap[(*it)->fOffset1] >> (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] >> it->fIntValue);
         dispatchNextScal();
     }
 
     // Comparaison Int
     do_kGTIntValueInvert : {
-        pushInt(fIntHeap[(*it)->fOffset1] > (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] > it->fIntValue);
         dispatchNextScal();
     }
 
     do_kLTIntValueInvert : {
-        pushInt(fIntHeap[(*it)->fOffset1] < (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] < it->fIntValue);
         dispatchNextScal();
     }
 
     do_kGEIntValueInvert : {
-        pushInt(fIntHeap[(*it)->fOffset1] >= (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] >= it->fIntValue);
         dispatchNextScal();
     }
 
     do_kLEIntValueInvert : {
-        pushInt(fIntHeap[(*it)->fOffset1] <= (*it)->fIntValue);
+        pushInt(fIntHeap[it->fOffset1] <= it->fIntValue);
         dispatchNextScal();
     }
 
     // Comparaison Real
     do_kGTRealValueInvert : {
-        pushInt(fRealHeap[(*it)->fOffset1] > (*it)->fRealValue);
+        pushInt(fRealHeap[it->fOffset1] > it->fRealValue);
         dispatchNextScal();
     }
 
     do_kLTRealValueInvert : {
-        pushInt(fRealHeap[(*it)->fOffset1] < (*it)->fRealValue);
+        pushInt(fRealHeap[it->fOffset1] < it->fRealValue);
         dispatchNextScal();
     }
 
     do_kGERealValueInvert : {
-        pushInt(fRealHeap[(*it)->fOffset1] >= (*it)->fRealValue);
+        pushInt(fRealHeap[it->fOffset1] >= it->fRealValue);
         dispatchNextScal();
     }
 
     do_kLERealValueInvert : {
-        pushInt(fRealHeap[(*it)->fOffset1] <= (*it)->fRealValue);
+        pushInt(fRealHeap[it->fOffset1] <= it->fRealValue);
         dispatchNextScal();
     }
 
@@ -2052,112 +2104,112 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         ///-----------------------------------
 
     do_kAbsHeap : {
-        pushInt(std::abs(fIntHeap[(*it)->fOffset1]));
+        pushInt(std::abs(fIntHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kAbsfHeap : {
-        pushReal(it, std::fabs(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::fabs(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kAcosfHeap : {
-        pushReal(it, std::acos(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::acos(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
         
     do_kAcoshfHeap : {
-        pushReal(it, std::acosh(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::acosh(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kAsinfHeap : {
-        pushReal(it, std::asin(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::asin(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
         
     do_kAsinhfHeap : {
-        pushReal(it, std::asinh(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::asinh(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kAtanfHeap : {
-        pushReal(it, std::atan(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::atan(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
         
     do_kAtanhfHeap : {
-        pushReal(it, std::atanh(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::atanh(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kCeilfHeap : {
-        pushReal(it, std::ceil(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::ceil(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kCosfHeap : {
-        pushReal(it, std::cos(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::cos(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kCoshfHeap : {
-        pushReal(it, std::cosh(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::cosh(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kExpfHeap : {
-        pushReal(it, std::exp(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::exp(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kFloorfHeap : {
-        pushReal(it, std::floor(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::floor(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kLogfHeap : {
-        pushReal(it, std::log(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::log(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kLog10fHeap : {
-        pushReal(it, std::log10(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::log10(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
         
     do_kRintfHeap : {
-        pushReal(it, std::rint(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::rint(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
    
     do_kRoundfHeap : {
-        pushReal(it, std::round(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::round(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kSinfHeap : {
-        pushReal(it, std::sin(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::sin(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kSinhfHeap : {
-        pushReal(it, std::sinh(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::sinh(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kSqrtfHeap : {
-        pushReal(it, std::sqrt(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::sqrt(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kTanfHeap : {
-        pushReal(it, std::tan(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::tan(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kTanhfHeap : {
-        pushReal(it, std::tanh(fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::tanh(fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
@@ -2219,37 +2271,37 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         //-------------------------------------
 
     do_kAtan2fHeap : {
-        pushReal(it, std::atan2(fRealHeap[(*it)->fOffset1], fRealHeap[(*it)->fOffset2]));
+        pushReal(it, std::atan2(fRealHeap[it->fOffset1], fRealHeap[it->fOffset2]));
         dispatchNextScal();
     }
 
     do_kFmodfHeap : {
-        pushReal(it, std::fmod(fRealHeap[(*it)->fOffset1], fRealHeap[(*it)->fOffset2]));
+        pushReal(it, std::fmod(fRealHeap[it->fOffset1], fRealHeap[it->fOffset2]));
         dispatchNextScal();
     }
 
     do_kPowfHeap : {
-        pushReal(it, std::pow(fRealHeap[(*it)->fOffset1], fRealHeap[(*it)->fOffset2]));
+        pushReal(it, std::pow(fRealHeap[it->fOffset1], fRealHeap[it->fOffset2]));
         dispatchNextScal();
     }
 
     do_kMaxHeap : {
-        pushInt(std::max(fIntHeap[(*it)->fOffset1], fIntHeap[(*it)->fOffset2]));
+        pushInt(std::max(fIntHeap[it->fOffset1], fIntHeap[it->fOffset2]));
         dispatchNextScal();
     }
 
     do_kMaxfHeap : {
-        pushReal(it, std::max(fRealHeap[(*it)->fOffset1], fRealHeap[(*it)->fOffset2]));
+        pushReal(it, std::max(fRealHeap[it->fOffset1], fRealHeap[it->fOffset2]));
         dispatchNextScal();
     }
 
     do_kMinHeap : {
-        pushInt(std::min(fIntHeap[(*it)->fOffset1], fIntHeap[(*it)->fOffset2]));
+        pushInt(std::min(fIntHeap[it->fOffset1], fIntHeap[it->fOffset2]));
         dispatchNextScal();
     }
 
     do_kMinfHeap : {
-        pushReal(it, std::min(fRealHeap[(*it)->fOffset1], fRealHeap[(*it)->fOffset2]));
+        pushReal(it, std::min(fRealHeap[it->fOffset1], fRealHeap[it->fOffset2]));
         dispatchNextScal();
     }
 
@@ -2259,43 +2311,43 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
     do_kAtan2fStack : {
         REAL v1 = popReal(it);
-        pushReal(it, std::atan2(fRealHeap[(*it)->fOffset1], v1));
+        pushReal(it, std::atan2(fRealHeap[it->fOffset1], v1));
         dispatchNextScal();
     }
 
     do_kFmodfStack : {
         REAL v1 = popReal(it);
-        pushReal(it, std::fmod(fRealHeap[(*it)->fOffset1], v1));
+        pushReal(it, std::fmod(fRealHeap[it->fOffset1], v1));
         dispatchNextScal();
     }
 
     do_kPowfStack : {
         REAL v1 = popReal(it);
-        pushReal(it, std::pow(fRealHeap[(*it)->fOffset1], v1));
+        pushReal(it, std::pow(fRealHeap[it->fOffset1], v1));
         dispatchNextScal();
     }
 
     do_kMaxStack : {
         int v1 = popInt();
-        pushInt(std::max(fIntHeap[(*it)->fOffset1], v1));
+        pushInt(std::max(fIntHeap[it->fOffset1], v1));
         dispatchNextScal();
     }
 
     do_kMaxfStack : {
         REAL v1 = popReal(it);
-        pushReal(it, std::max(fRealHeap[(*it)->fOffset1], v1));
+        pushReal(it, std::max(fRealHeap[it->fOffset1], v1));
         dispatchNextScal();
     }
 
     do_kMinStack : {
         int v1 = popInt();
-        pushInt(std::min(fIntHeap[(*it)->fOffset1], v1));
+        pushInt(std::min(fIntHeap[it->fOffset1], v1));
         dispatchNextScal();
     }
 
     do_kMinfStack : {
         REAL v1 = popReal(it);
-        pushReal(it, std::min(fRealHeap[(*it)->fOffset1], v1));
+        pushReal(it, std::min(fRealHeap[it->fOffset1], v1));
         dispatchNextScal();
     }
 
@@ -2305,43 +2357,43 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
     do_kAtan2fStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, std::atan2((*it)->fRealValue, v1));
+        pushReal(it, std::atan2(it->fRealValue, v1));
         dispatchNextScal();
     }
 
     do_kFmodfStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, std::fmod((*it)->fRealValue, v1));
+        pushReal(it, std::fmod(it->fRealValue, v1));
         dispatchNextScal();
     }
 
     do_kPowfStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, std::pow((*it)->fRealValue, v1));
+        pushReal(it, std::pow(it->fRealValue, v1));
         dispatchNextScal();
     }
 
     do_kMaxStackValue : {
         int v1 = popInt();
-        pushInt(std::max((*it)->fIntValue, v1));
+        pushInt(std::max(it->fIntValue, v1));
         dispatchNextScal();
     }
 
     do_kMaxfStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, std::max((*it)->fRealValue, v1));
+        pushReal(it, std::max(it->fRealValue, v1));
         dispatchNextScal();
     }
 
     do_kMinStackValue : {
         int v1 = popInt();
-        pushInt(std::min((*it)->fIntValue, v1));
+        pushInt(std::min(it->fIntValue, v1));
         dispatchNextScal();
     }
 
     do_kMinfStackValue : {
         REAL v1 = popReal(it);
-        pushReal(it, std::min((*it)->fRealValue, v1));
+        pushReal(it, std::min(it->fRealValue, v1));
         dispatchNextScal();
     }
 
@@ -2350,37 +2402,37 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         //-------------------------------------
 
     do_kAtan2fValue : {
-        pushReal(it, std::atan2((*it)->fRealValue, fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::atan2(it->fRealValue, fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kFmodfValue : {
-        pushReal(it, std::fmod((*it)->fRealValue, fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::fmod(it->fRealValue, fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kPowfValue : {
-        pushReal(it, std::pow((*it)->fRealValue, fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::pow(it->fRealValue, fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kMaxValue : {
-        pushInt(std::max((*it)->fIntValue, fIntHeap[(*it)->fOffset1]));
+        pushInt(std::max(it->fIntValue, fIntHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kMaxfValue : {
-        pushReal(it, std::max((*it)->fRealValue, fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::max(it->fRealValue, fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kMinValue : {
-        pushInt(std::min((*it)->fIntValue, fIntHeap[(*it)->fOffset1]));
+        pushInt(std::min(it->fIntValue, fIntHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
     do_kMinfValue : {
-        pushReal(it, std::min((*it)->fRealValue, fRealHeap[(*it)->fOffset1]));
+        pushReal(it, std::min(it->fRealValue, fRealHeap[it->fOffset1]));
         dispatchNextScal();
     }
 
@@ -2389,17 +2441,17 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         //-------------------------------------------------------------------
 
     do_kAtan2fValueInvert : {
-        pushReal(it, std::atan2(fRealHeap[(*it)->fOffset1], (*it)->fRealValue));
+        pushReal(it, std::atan2(fRealHeap[it->fOffset1], it->fRealValue));
         dispatchNextScal();
     }
 
     do_kFmodfValueInvert : {
-        pushReal(it, std::fmod(fRealHeap[(*it)->fOffset1], (*it)->fRealValue));
+        pushReal(it, std::fmod(fRealHeap[it->fOffset1], it->fRealValue));
         dispatchNextScal();
     }
 
     do_kPowfValueInvert : {
-        pushReal(it, std::pow(fRealHeap[(*it)->fOffset1], (*it)->fRealValue));
+        pushReal(it, std::pow(fRealHeap[it->fOffset1], it->fRealValue));
         dispatchNextScal();
     }
 
@@ -2422,12 +2474,12 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
         if (popInt()) {
             // Execute new block
-            assertInterp((*it)->fBranch1);
+            assertInterp(it->fBranch1);
             dispatchBranch1Scal();
             // No value (If)
         } else {
             // Execute new block
-            assertInterp((*it)->fBranch2);
+            assertInterp(it->fBranch2);
             dispatchBranch2Scal();
             // No value (If)
         }
@@ -2439,12 +2491,12 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
         if (popInt()) {
             // Execute new block
-            assertInterp((*it)->fBranch1);
+            assertInterp(it->fBranch1);
             dispatchBranch1Scal();
             // Real value
         } else {
             // Execute new block
-            assertInterp((*it)->fBranch2);
+            assertInterp(it->fBranch2);
             dispatchBranch2Scal();
             // Real value
         }
@@ -2456,12 +2508,12 @@ class FBCInterpreter : public FBCExecutor<REAL> {
 
         if (popInt()) {
             // Execute new block
-            assertInterp((*it)->fBranch1);
+            assertInterp(it->fBranch1);
             dispatchBranch1Scal();
             // Int value
         } else {
             // Execute new block
-            assertInterp((*it)->fBranch2);
+            assertInterp(it->fBranch2);
             dispatchBranch2Scal();
             // Int value
         }
@@ -2470,7 +2522,7 @@ class FBCInterpreter : public FBCExecutor<REAL> {
     do_kCondBranch : {
         // If condition is true, just branch back on the block beginning
         if (popInt()) {
-            assertInterp((*it)->fBranch1);
+            assertInterp(it->fBranch1);
             dispatchBranch1Scal();
         } else {
             // Just continue after 'loop block' (do the final 'return')
@@ -2483,14 +2535,106 @@ class FBCInterpreter : public FBCExecutor<REAL> {
         saveReturnScal();
 
         // Push branch2 (loop content)
-        assertInterp((*it)->fBranch2);
+        assertInterp(it->fBranch2);
         pushBranch2Scal();
 
         // And start branch1 loop variable declaration block
-        assertInterp((*it)->fBranch1);
+        assertInterp(it->fBranch1);
         dispatchBranch1Scal();
     }
 
+    //-------------------
+    // Superinstructions
+    //-------------------
+
+    // The handlers read the operands of the fused instructions that follow, and leave 'it'
+    // on the last of them before dispatching
+
+    // kAddIntValue, kStoreInt
+    do_kStoreAddIntValue : {
+        fIntHeap[it[1].fOffset1] = it->fIntValue + fIntHeap[it->fOffset1];
+        it += 1;
+        dispatchNextScal();
+    }
+
+    // kAddIntValue, kStoreInt, kLTIntHeap, kCondBranch
+    do_kLoopStepIntHeap : {
+        fIntHeap[it[1].fOffset1] = it->fIntValue + fIntHeap[it->fOffset1];
+        bool cond                = fIntHeap[it[2].fOffset1] < fIntHeap[it[2].fOffset2];
+        it += 3;
+        if (cond) {
+            dispatchBranch1Scal();
+        } else {
+            dispatchNextScal();
+        }
+    }
+
+    // kAddIntValue, kStoreInt, kLTIntValueInvert, kCondBranch
+    do_kLoopStepIntValue : {
+        fIntHeap[it[1].fOffset1] = it->fIntValue + fIntHeap[it->fOffset1];
+        bool cond                = fIntHeap[it[2].fOffset1] < it[2].fIntValue;
+        it += 3;
+        if (cond) {
+            dispatchBranch1Scal();
+        } else {
+            dispatchNextScal();
+        }
+    }
+
+    // kLoadInt, kLoadInput
+    do_kLoadInputHeap : {
+        pushReal(it, fInputs[it[1].fOffset1][fIntHeap[it->fOffset1]]);
+        it += 1;
+        dispatchNextScal();
+    }
+
+    // kLoadInt, kStoreOutput
+    do_kStoreOutputHeap : {
+        fOutputs[it[1].fOffset1][fIntHeap[it->fOffset1]] = popReal(it);
+        it += 1;
+        dispatchNextScal();
+    }
+
+    // kLoadInt, kStoreIndexedReal
+    do_kStoreIndexedRealHeap : {
+        fRealHeap[it[1].fOffset1 + fIntHeap[it->fOffset1]] = popReal(it);
+        it += 1;
+        dispatchNextScal();
+    }
+
+    // kMultRealHeap, kAddReal
+    do_kMultAddRealHeap : {
+        REAL v1 = popReal(it);
+        pushReal(it, (fRealHeap[it->fOffset1] * fRealHeap[it->fOffset2]) + v1);
+        it += 1;
+        dispatchNextScal();
+    }
+
+    // kMultRealHeap, kAddRealStack
+    do_kMultAddRealStack : {
+        pushReal(it, fRealHeap[it[1].fOffset1] + (fRealHeap[it->fOffset1] * fRealHeap[it->fOffset2]));
+        it += 1;
+        dispatchNextScal();
+    }
+
+    // kAddReal, kMultRealStack
+    do_kAddMultRealStack : {
+        REAL v1 = popReal(it);
+        REAL v2 = popReal(it);
+        pushReal(it, fRealHeap[it[1].fOffset1] * (v1 + v2));
+        it += 1;
+        dispatchNextScal();
+    }
+
+    // kSubReal, kStoreReal
+    do_kSubStoreReal : {
+        REAL v1                  = popReal(it);
+        REAL v2                  = popReal(it);
+        fRealHeap[it[1].fOffset1] = v1 - v2;
+        it += 1;
+        dispatchNextScal();
+    }
+
     end:
         // Check stack coherency
         assertInterp(real_stack_index == 0 && int_stack_index == 0 && sound_stack_index == 0);
@@ -2507,7 +2651,8 @@ class FBCInterpreter : public FBCExecutor<REAL> {
                 << " count_offset " << count_offset << std::endl;
         */
 
-        fFactory = factory;
+        fFactory     = factory;
+        fPackedBlock = nullptr;
 
         if (fFactory->getMemoryManager()) {
             fRealHeap  = static_cast<REAL*>(fFactory->allocate(sizeof(REAL) * fFactory->fRealHeapSize));
@@ -2582,6 +2727,9 @@ class FBCInterpreter : public FBCExecutor<REAL> {
     void setIntValue(int offset, int value) { fIntHeap[offset] = value; }
     int  getIntValue(int offset) { return fIntHeap[offset]; }
 
+    void setRealValue(int offset, REAL value) { fRealHeap[offset] = value; }
+    REAL getRealValue(int offset) { return fRealHeap[offset]; }
+
     virtual void setInput(int input, REAL* buffer) { fInputs[input] = buffer; }
     virtual void setOutput(int output, REAL* buffer) { fOutputs[output] = buffer; }
 };
@@ -926,7 +926,7 @@ class FBCLLVMCompiler : public FBCExecuteFun<REAL> {
         LLVMDisposeBuilder(fAllocaBuilder);
         // fModule is deallocated by fJIT
         LLVMDisposeExecutionEngine(fJIT);
-        LLVMShutdown();
+        // LLVMShutdown is not called since other blocks may still be compiled or executed
     }
 
     void Execute(int* int_heap, REAL* real_heap, REAL** inputs, REAL** outputs)
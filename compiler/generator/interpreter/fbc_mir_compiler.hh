@@ -33,11 +33,9 @@
 extern "C" {
 #endif
 
-//#include "mir.h"
-//#include "mir-gen.h"
-
-#include "/Documents/JIT-compilation/mir/mir.h"
-#include "/Documents/JIT-compilation/mir/mir-gen.h"
+// Found in the MIR source directory (see FBC_MIR_DIR in build/interp/CMakeLists.txt)
+#include "mir.h"
+#include "mir-gen.h"
     
 #ifdef __cplusplus
 }
@@ -348,6 +348,18 @@ struct FBCInstruction {
         kSelectInt,
         kCondBranch,
 
+        // Superinstructions (only generated in packed code, see FBCPackedBlock)
+        kStoreAddIntValue,
+        kLoopStepIntHeap,
+        kLoopStepIntValue,
+        kLoadInputHeap,
+        kStoreOutputHeap,
+        kStoreIndexedRealHeap,
+        kMultAddRealHeap,
+        kMultAddRealStack,
+        kAddMultRealStack,
+        kSubStoreReal,
+
         // User Interface
         kOpenVerticalBox,
         kOpenHorizontalBox,
@@ -449,7 +461,7 @@ static std::string gFBCInstructionTable[] = {
     // Standard math (value OP heap) : non commutative operations
     "kSubRealValueInvert", "kSubIntValueInvert", "kDivRealValueInvert", "kDivIntValueInvert", "kRemRealValueInvert",
     "kRemIntValueInvert", "kLshIntValueInvert", "kARshIntValueInvert", "kLRshIntValueInvert", "kGTIntValueInvert", "kLTIntValueInvert",
-    "kLTIntValueInvert", "kLEIntValueInvert", "kGTRealValueInvert", "kLTRealValueInvert", "kGERealValueInvert",
+    "kGEIntValueInvert", "kLEIntValueInvert", "kGTRealValueInvert", "kLTRealValueInvert", "kGERealValueInvert",
     "kLERealValueInvert",
 
     // Extended unary math
@@ -486,6 +498,10 @@ static std::string gFBCInstructionTable[] = {
     // Select/if
     "kIf", "kSelectReal", "kSelectInt", "kCondBranch",
 
+    // Superinstructions
+    "kStoreAddIntValue", "kLoopStepIntHeap", "kLoopStepIntValue", "kLoadInputHeap", "kStoreOutputHeap",
+    "kStoreIndexedRealHeap", "kMultAddRealHeap", "kMultAddRealStack", "kAddMultRealStack", "kSubStoreReal",
+
     // User Interface
     "kOpenVerticalBox", "kOpenHorizontalBox", "kOpenTabBox", "kCloseBox", "kAddButton", "kAddChecButton",
     "kAddHorizontalSlider", "kAddVerticalSlider", "kAddNumEntry", "kAddSoundfile", "kAddHorizontalBargraph",
@@ -493,6 +509,6 @@ static std::string gFBCInstructionTable[] = {
 
     "kNop"};
 
-#define INTERP_FILE_VERSION 8
+#define INTERP_FILE_VERSION 9
 
 #endif
@@ -2522,6 +2522,9 @@ class FBCVecInterpreter : public FBCExecutor<REAL> {
     void setIntValue(int offset, int value) { fIntHeap[offset] = value; }
     int  getIntValue(int offset) { return fIntHeap[offset]; }
 
+    void setRealValue(int offset, REAL value) { fRealHeap[offset] = value; }
+    REAL getRealValue(int offset) { return fRealHeap[offset]; }
+
     virtual void setInput(int offset, REAL* buffer) { fInputs[offset] = buffer; }
     virtual void setOutput(int offset, REAL* buffer) { fOutputs[offset] = buffer; }
 };
@@ -23,7 +23,10 @@
 #define _FIR_INTERPRETER_BYTECODE_H
 
 #include <math.h>
+#include <atomic>
 #include <iostream>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -431,6 +434,19 @@ struct FIRUserInterfaceBlockInstruction : public FBCInstruction {
         return fPathMap;
     }
 
+    // Offsets of the slow-changing controls used to specialize the code, declared with [specialize:1]
+    std::vector<int> getSpecializedZones()
+    {
+        std::vector<int> zones;
+        for (auto& it : fInstructions) {
+            if (it->fOpcode == FBCInstruction::kDeclare && it->fOffset != -1 && it->fKey == "specialize"
+                && it->fValue != "0") {
+                zones.push_back(it->fOffset);
+            }
+        }
+        return zones;
+    }
+
     void freezeDefaultValues(std::map<int, REAL>& real_map)
     {
         for (auto& it : fInstructions) {
@@ -494,17 +510,75 @@ struct FIRMetaBlockInstruction : public FBCInstruction {
     }
 };
 
+/*
+ Packed bytecode: a block and all its sub-blocks are lowered in a single contiguous array of
+ pointer-free instructions, with inline operands and branches coded as relative offsets.
+ This is the form actually executed by the interpreter.
+*/
+
+template <class REAL>
+struct FBCPackedInstruction {
+    FBCInstruction::Opcode fOpcode;
+    int                    fIntValue;  // Also the index of the table in FBCPackedBlock for kBlockStoreReal/Int
+    int                    fOffset1;
+    int                    fOffset2;
+    REAL                   fRealValue;
+    int                    fBranch1;  // Relative offset of the first branch (or of the loop start for kCondBranch)
+    int                    fBranch2;  // Relative offset of the second branch
+};
+
+#define PackedInstructionIT const FBCPackedInstruction<REAL>*
+
+template <class REAL>
+struct FBCPackedBlock {
+    std::vector<FBCPackedInstruction<REAL>> fCode;
+    std::vector<FBCBasicInstruction<REAL>*> fSources;  // Original instructions, only used in trace mode
+    std::vector<REAL>                       fRealTables;
+    std::vector<int>                        fIntTables;
+
+    // 'fuse' replaces the most frequent instruction sequences by superinstructions
+    FBCPackedBlock(FBCBlockInstruction<REAL>* block, bool fuse)
+    {
+        std::map<FBCBlockInstruction<REAL>*, int> starts;
+        pack(block, starts, fuse);
+    }
+
+    int  pack(FBCBlockInstruction<REAL>* block, std::map<FBCBlockInstruction<REAL>*, int>& starts, bool fuse);
+    void fuse(int start, int size);
+
+    FBCBasicInstruction<REAL>* getSource(PackedInstructionIT it) { return fSources[it - fCode.data()]; }
+};
+
 template <class REAL>
 struct FBCBlockInstruction : public FBCInstruction {
     std::vector<FBCBasicInstruction<REAL>*> fInstructions;
+    std::atomic<FBCPackedBlock<REAL>*>      fPacked;
+
+    FBCBlockInstruction() : fPacked(nullptr) {}
 
     virtual ~FBCBlockInstruction()
     {
         for (auto& it : fInstructions) {
             delete it;
         }
+        delete fPacked.load();
+    }
+
+    // Lowered in packed form once optimized, before any DSP instance executes the block
+    void pack(bool fuse)
+    {
+        if (!fPacked.load(std::memory_order_acquire)) {
+            // If another thread packed the block meanwhile, its version is kept
+            FBCPackedBlock<REAL>* expected = nullptr;
+            FBCPackedBlock<REAL>* packed   = new FBCPackedBlock<REAL>(this, fuse);
+            if (!fPacked.compare_exchange_strong(expected, packed, std::memory_order_acq_rel)) {
+                delete packed;
+            }
+        }
     }
 
+    FBCPackedBlock<REAL>* getPacked() { return fPacked.load(std::memory_order_acquire); }
+
     // Check block coherency
     void check()
     {
@@ -515,6 +589,7 @@ struct FBCBlockInstruction : public FBCInstruction {
 
     void push(FBCBasicInstruction<REAL>* inst)
     {
+        faustassert(!fPacked.load());
         if (inst) fInstructions.push_back(inst);
     }
 
@@ -572,7 +647,131 @@ struct FBCBlockInstruction : public FBCInstruction {
         return size;
     }
 
+    // Collect the heap offsets written by the (non optimized) store instructions of the block and its sub-blocks
+    void getStoredOffsets(std::set<int>& int_set, std::set<int>& real_set)
+    {
+        for (auto& it : fInstructions) {
+            switch (it->fOpcode) {
+                case kStoreReal:
+                case kStoreRealValue:
+                case kStoreIndexedReal:
+                case kBlockStoreReal:
+                    real_set.insert(it->fOffset1);
+                    break;
+
+                case kStoreInt:
+                case kStoreIntValue:
+                case kStoreIndexedInt:
+                case kBlockStoreInt:
+                    int_set.insert(it->fOffset1);
+                    break;
+
+                default:
+                    break;
+            }
+            // kCondBranch branches back on the loop block itself
+            if (it->fOpcode != kCondBranch) {
+                if (it->fBranch1) it->fBranch1->getStoredOffsets(int_set, real_set);
+                if (it->fBranch2) it->fBranch2->getStoredOffsets(int_set, real_set);
+            }
+        }
+    }
+
     bool isRealInst() { return isRealType(fInstructions.back()->fOpcode); }
 };
 
+/*
+ Superinstructions: the most frequent sequences found by profiling the interpreter on the
+ 'tests/impulse-tests' corpus (see INTERP_PROFILE in fbc_interpreter.hh), longest first.
+ The first instruction of a sequence receives the superinstruction opcode, the following ones
+ stay in place to keep their operands, and are skipped by the superinstruction handler.
+*/
+struct FBCSuperInstruction {
+    FBCInstruction::Opcode fOpcode;
+    int                    fSize;
+    FBCInstruction::Opcode fSequence[4];
+};
+
+static const FBCSuperInstruction gFBCSuperInstructionTable[] = {
+    {FBCInstruction::kLoopStepIntHeap,
+     4,
+     {FBCInstruction::kAddIntValue, FBCInstruction::kStoreInt, FBCInstruction::kLTIntHeap, FBCInstruction::kCondBranch}},
+    {FBCInstruction::kLoopStepIntValue,
+     4,
+     {FBCInstruction::kAddIntValue, FBCInstruction::kStoreInt, FBCInstruction::kLTIntValueInvert,
+      FBCInstruction::kCondBranch}},
+    {FBCInstruction::kStoreAddIntValue, 2, {FBCInstruction::kAddIntValue, FBCInstruction::kStoreInt}},
+    {FBCInstruction::kLoadInputHeap, 2, {FBCInstruction::kLoadInt, FBCInstruction::kLoadInput}},
+    {FBCInstruction::kStoreOutputHeap, 2, {FBCInstruction::kLoadInt, FBCInstruction::kStoreOutput}},
+    {FBCInstruction::kStoreIndexedRealHeap, 2, {FBCInstruction::kLoadInt, FBCInstruction::kStoreIndexedReal}},
+    {FBCInstruction::kMultAddRealHeap, 2, {FBCInstruction::kMultRealHeap, FBCInstruction::kAddReal}},
+    {FBCInstruction::kMultAddRealStack, 2, {FBCInstruction::kMultRealHeap, FBCInstruction::kAddRealStack}},
+    {FBCInstruction::kAddMultRealStack, 2, {FBCInstruction::kAddReal, FBCInstruction::kMultRealStack}},
+    {FBCInstruction::kSubStoreReal, 2, {FBCInstruction::kSubReal, FBCInstruction::kStoreReal}}};
+
+template <class REAL>
+void FBCPackedBlock<REAL>::fuse(int start, int size)
+{
+    int pos = start;
+    while (pos < start + size) {
+        int fused = 1;
+        for (const auto& super : gFBCSuperInstructionTable) {
+            if (pos + super.fSize > start + size) continue;
+            int i = 0;
+            while (i < super.fSize && fCode[pos + i].fOpcode == super.fSequence[i]) i++;
+            if (i == super.fSize) {
+                fCode[pos].fOpcode = super.fOpcode;
+                fused              = super.fSize;
+                break;
+            }
+        }
+        pos += fused;
+    }
+}
+
+// Returns the start index of the block, which is laid out before its sub-blocks
+template <class REAL>
+int FBCPackedBlock<REAL>::pack(FBCBlockInstruction<REAL>* block, std::map<FBCBlockInstruction<REAL>*, int>& starts,
+                               bool fuse)
+{
+    if (starts.find(block) != starts.end()) return starts[block];
+
+    int start     = int(fCode.size());
+    starts[block] = start;
+
+    for (auto& it : block->fInstructions) {
+        FBCPackedInstruction<REAL> inst = {it->fOpcode, it->fIntValue, it->fOffset1, it->fOffset2, it->fRealValue, 0, 0};
+        if (it->fOpcode == FBCInstruction::kBlockStoreReal) {
+            FIRBlockStoreRealInstruction<REAL>* store = static_cast<FIRBlockStoreRealInstruction<REAL>*>(it);
+            inst.fIntValue = int(fRealTables.size());
+            fRealTables.insert(fRealTables.end(), store->fNumTable.begin(), store->fNumTable.end());
+        } else if (it->fOpcode == FBCInstruction::kBlockStoreInt) {
+            FIRBlockStoreIntInstruction<REAL>* store = static_cast<FIRBlockStoreIntInstruction<REAL>*>(it);
+            inst.fIntValue = int(fIntTables.size());
+            fIntTables.insert(fIntTables.end(), store->fNumTable.begin(), store->fNumTable.end());
+        }
+        fCode.push_back(inst);
+        fSources.push_back(it);
+    }
+
+    // Sub-blocks are laid out after the block (fCode may be reallocated, so indexes are used)
+    for (size_t i = 0; i < block->fInstructions.size(); i++) {
+        FBCBasicInstruction<REAL>* it  = block->fInstructions[i];
+        int                        pos = start + int(i);
+        if (it->fBranch1) {
+            fCode[pos].fBranch1 = pack(it->fBranch1, starts, fuse) - pos;
+        }
+        if (it->fBranch2) {
+            fCode[pos].fBranch2 = pack(it->fBranch2, starts, fuse) - pos;
+        }
+    }
+
+    // Sequences never cross a block boundary, since only block starts are branch targets
+    if (fuse) {
+        this->fuse(start, int(block->fInstructions.size()));
+    }
+
+    return start;
+}
+
 #endif
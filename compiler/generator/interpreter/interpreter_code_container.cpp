@@ -48,7 +48,7 @@ global memory allocation is implemented)
 */
 
 template <class REAL>
-map<string, FBCInstruction::Opcode> InterpreterInstVisitor<REAL>::gMathLibTable;
+thread_local map<string, FBCInstruction::Opcode> InterpreterInstVisitor<REAL>::gMathLibTable;
 
 template <class REAL>
 static FBCBlockInstruction<REAL>* getCurrentBlock()
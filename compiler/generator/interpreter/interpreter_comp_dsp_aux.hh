@@ -26,12 +26,16 @@
 #include "fbc_compiler.hh"
 
 // Interpreter factory using a LLVM or MIR compiler for the 'compute' method
+// The 'DSP' block is interpreted until compiled by a background thread (tiered execution, see FBCTieredBlock),
+// or compiled when the first instance is created if tiered execution has been disabled with 'setTieredExecution'
 
 template <class REAL, int TRACE>
-struct interpreter_comp_dsp_factory_aux : public interpreter_dsp_factory_aux<REAL,TRACE> {
+struct interpreter_comp_dsp_factory_aux : public interpreter_dsp_factory_aux<REAL,TRACE>, public interpreter_tiered_factory {
     
-    // Shared between all DSP instances
-    typename FBCCompiler<REAL>::CompiledBlocksType* fCompiledBlocks;
+    bool fTiered;
+    
+    // Shared between all DSP instances, created once in 'prepareExecutors'
+    std::atomic<FBCTieredBlock<REAL>*> fTieredBlock;
 
     interpreter_comp_dsp_factory_aux(const std::string& name, const std::string& compile_options, const std::string& sha_key,
                                 int version_num, int inputs, int outputs, int int_heap_size, int real_heap_size,
@@ -46,22 +50,45 @@ struct interpreter_comp_dsp_factory_aux : public interpreter_dsp_factory_aux<REA
                                   meta, firinterface,
                                   static_init, init,
                                   resetui, clear,
-                                  compute_control, compute_dsp)
+                                  compute_control, compute_dsp),
+      fTiered(true),
+      fTieredBlock(nullptr)
+    {}
+
+    virtual void prepareExecutors()
     {
-        fCompiledBlocks = new std::map<FBCBlockInstruction<REAL>*, FBCExecuteFun<REAL>*>();
+    #ifdef FBC_COMPILER
+        // Compilation is started with the first instance
+        fTieredBlock.store(new FBCTieredBlock<REAL>(this->fComputeDSPBlock, fTiered), std::memory_order_release);
+    #endif
     }
 
     virtual FBCExecutor<REAL>* createFBCExecutor()
     {
-        return new FBCCompiler<REAL>(this, fCompiledBlocks);
+    #ifdef FBC_COMPILER
+        return new FBCCompiler<REAL>(this, fTieredBlock.load(std::memory_order_acquire));
+    #else
+        return new FBCInterpreter<REAL,TRACE>(this);
+    #endif
+    }
+
+    virtual void setTieredExecution(bool tiered) { fTiered = tiered; }
+
+    virtual int getInterpretedComputeCount()
+    {
+        FBCTieredBlock<REAL>* tiered_block = fTieredBlock.load(std::memory_order_acquire);
+        return (tiered_block) ? tiered_block->fInterpretedCount.load() : 0;
+    }
+
+    virtual int getCompiledSwapCount()
+    {
+        FBCTieredBlock<REAL>* tiered_block = fTieredBlock.load(std::memory_order_acquire);
+        return (tiered_block) ? tiered_block->fSwapCount.load() : 0;
     }
 
     virtual ~interpreter_comp_dsp_factory_aux()
     {
-        for (auto& it : *fCompiledBlocks) {
-            delete it.second;
-        }
-        delete fCompiledBlocks;
+        delete fTieredBlock.load();
     }
 
 };
@@ -77,6 +104,8 @@ struct interpreter_comp_dsp_aux : public interpreter_dsp_aux<REAL,TRACE> {
         this->fInitialized = false;
         this->fCycle = 0;
         this->fTraceOutput = false;
+        // Lowers the blocks in packed form and starts the compilation of the 'DSP' block, before createFBCExecutor
+        factory->optimize();
         this->fFBCExecutor = factory->createFBCExecutor();
     }
     
@@ -25,6 +25,7 @@
 #include "interpreter_comp_dsp_aux.hh"
 #ifndef MACHINE
 #include "interpreter_optimizer.hh"
+#include "interpreter_dsp_aux_pe.hh"
 #endif
 
 // Factory reader
@@ -187,11 +188,13 @@ interpreter_dsp_factory_aux<REAL, TRACE>* interpreter_dsp_factory_aux<REAL, TRAC
 template <class REAL, int TRACE>
 void interpreter_dsp_factory_aux<REAL, TRACE>::optimize()
 {
-    if (!fOptimized) {
-        fOptimized = true;
+    // DSP instances can be created concurrently: the blocks are only optimized and packed once
+    std::call_once(fOptimized, [this]() {
         // Bytecode optimization
         if (TRACE == 0) {
     #ifndef MACHINE
+            // Specialization needs the non optimized code
+            if (fSpecializePeriod > 0) prepareSpecialization();
             fStaticInitBlock = FBCInstructionOptimizer<REAL>::optimizeBlock(fStaticInitBlock, 1, fOptLevel);
             fInitBlock       = FBCInstructionOptimizer<REAL>::optimizeBlock(fInitBlock, 1, fOptLevel);
             fResetUIBlock    = FBCInstructionOptimizer<REAL>::optimizeBlock(fResetUIBlock, 1, fOptLevel);
@@ -200,6 +203,48 @@ void interpreter_dsp_factory_aux<REAL, TRACE>::optimize()
             fComputeDSPBlock = FBCInstructionOptimizer<REAL>::optimizeBlock(fComputeDSPBlock, 1, fOptLevel);
     #endif
         }
+        // Lowered in packed form (superinstructions are not used in trace mode)
+        fStaticInitBlock->pack(TRACE == 0);
+        fInitBlock->pack(TRACE == 0);
+        fResetUIBlock->pack(TRACE == 0);
+        fClearBlock->pack(TRACE == 0);
+        fComputeBlock->pack(TRACE == 0);
+        fComputeDSPBlock->pack(TRACE == 0);
+        prepareExecutors();
+    });
+}
+
+template <class REAL, int TRACE>
+void interpreter_dsp_factory_aux<REAL, TRACE>::prepareSpecialization()
+{
+    fSpecWorker          = new interpreter_specialization_worker(fSpecializePeriod);
+    fSpecComputeBlock    = fComputeBlock->copy();
+    fSpecComputeDSPBlock = fComputeDSPBlock->copy();
+    
+    // Heap offsets which can change after 'instanceConstants'
+    std::set<int> int_stores, real_stores;
+    fComputeBlock->getStoredOffsets(int_stores, real_stores);
+    fComputeDSPBlock->getStoredOffsets(int_stores, real_stores);
+    fComputeDSPBlock->getStoredOffsets(fSpecIntStores, fSpecRealStores);
+    fResetUIBlock->getStoredOffsets(int_stores, real_stores);
+    fClearBlock->getStoredOffsets(int_stores, real_stores);
+    int_stores.insert(fIOTAOffset);
+    int_stores.insert(fCountOffset);
+    
+    // Constants are the values computed by 'classInit' and 'instanceConstants' and never changed afterwards
+    std::set<int> int_constants, real_constants;
+    fStaticInitBlock->getStoredOffsets(int_constants, real_constants);
+    fInitBlock->getStoredOffsets(int_constants, real_constants);
+    int_constants.insert(fSROffset);
+    for (auto& it : int_constants) {
+        if (int_stores.find(it) == int_stores.end()) fSpecIntConstants.push_back(it);
+    }
+    for (auto& it : real_constants) {
+        if (real_stores.find(it) == real_stores.end()) fSpecRealConstants.push_back(it);
+    }
+    
+    for (auto& it : fUserInterfaceBlock->getSpecializedZones()) {
+        if (fSpecRealStores.find(it) == fSpecRealStores.end()) fSpecZones.push_back(it);
     }
 }
 
@@ -217,7 +262,12 @@ dsp* interpreter_dsp_factory_aux<REAL, TRACE>::createDSPInstance(dsp_factory* fa
     #ifdef MACHINE
         return new interpreter_dsp(tmp, new interpreter_comp_dsp_aux<REAL, TRACE>(this));
     #else
-        return new interpreter_dsp(tmp, new interpreter_dsp_aux<REAL, TRACE>(this));
+        optimize();
+        if (fSpecWorker) {
+            return new interpreter_dsp(tmp, new interpreter_dsp_aux_pe<REAL, TRACE>(this));
+        } else {
+            return new interpreter_dsp(tmp, new interpreter_dsp_aux<REAL, TRACE>(this));
+        }
     #endif
     }
 }
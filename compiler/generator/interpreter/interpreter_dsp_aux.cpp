@@ -98,6 +98,30 @@ EXPORT interpreter_dsp* interpreter_dsp_factory::createDSPInstance()
     return static_cast<interpreter_dsp*>(dsp);
 }
 
+EXPORT void interpreter_dsp_factory::setSpecialization(int period)
+{
+    interpreter_specialized_factory* specialized_factory = dynamic_cast<interpreter_specialized_factory*>(fFactory);
+    if (specialized_factory) specialized_factory->setSpecialization(period);
+}
+
+EXPORT void interpreter_dsp_factory::setTieredExecution(bool tiered)
+{
+    interpreter_tiered_factory* tiered_factory = dynamic_cast<interpreter_tiered_factory*>(fFactory);
+    if (tiered_factory) tiered_factory->setTieredExecution(tiered);
+}
+
+EXPORT int interpreter_dsp_factory::getInterpretedComputeCount()
+{
+    interpreter_tiered_factory* tiered_factory = dynamic_cast<interpreter_tiered_factory*>(fFactory);
+    return (tiered_factory) ? tiered_factory->getInterpretedComputeCount() : 0;
+}
+
+EXPORT int interpreter_dsp_factory::getCompiledSwapCount()
+{
+    interpreter_tiered_factory* tiered_factory = dynamic_cast<interpreter_tiered_factory*>(fFactory);
+    return (tiered_factory) ? tiered_factory->getCompiledSwapCount() : 0;
+}
+
 // Use the memory manager if needed
 EXPORT void interpreter_dsp::operator delete(void* ptr)
 {
@@ -26,9 +26,14 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <chrono>
+#include <condition_variable>
 #include <limits>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include "dsp_aux.hh"
 #include "dsp_factory.hh"
@@ -49,8 +54,83 @@ extern dsp_factory_table<SDsp_factory>                gInterpreterFactoryTable;
 template <class REAL, int TRACE>
 class interpreter_dsp_aux;
 
+// Implemented by the factories with a tiered execution, see interpreter_comp_dsp_aux.hh
+struct interpreter_tiered_factory {
+    virtual ~interpreter_tiered_factory() {}
+
+    virtual void setTieredExecution(bool tiered) = 0;
+    virtual int  getInterpretedComputeCount()    = 0;
+    virtual int  getCompiledSwapCount()          = 0;
+};
+
+// Implemented by the instances specialized on their controls, see interpreter_dsp_aux_pe.hh
+struct interpreter_specialized_instance {
+    virtual ~interpreter_specialized_instance() {}
+
+    // Called by the specialization thread of the factory, every period
+    virtual void pollSpecialization() = 0;
+};
+
+// Specialization thread shared by all the specialized instances of a factory, started with the first one
+class interpreter_specialization_worker {
+   private:
+    int                                         fPeriod;  // In ms
+    std::set<interpreter_specialized_instance*> fInstances;
+    std::mutex                                  fMutex;
+    std::condition_variable                     fCondition;
+    std::thread                                 fThread;
+    bool                                        fRunning;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(fMutex);
+        while (fRunning) {
+            fCondition.wait_for(lock, std::chrono::milliseconds(fPeriod));
+            if (!fRunning) break;
+            for (auto& it : fInstances) it->pollSpecialization();
+        }
+    }
+
+   public:
+    interpreter_specialization_worker(int period) : fPeriod(period), fRunning(false) {}
+
+    virtual ~interpreter_specialization_worker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fRunning = false;
+        }
+        fCondition.notify_one();
+        if (fThread.joinable()) fThread.join();
+    }
+
+    void addInstance(interpreter_specialized_instance* instance)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fInstances.insert(instance);
+        if (!fRunning) {
+            fRunning = true;
+            fThread  = std::thread(&interpreter_specialization_worker::run, this);
+        }
+    }
+
+    // Once returned, the instance is no more polled
+    void removeInstance(interpreter_specialized_instance* instance)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fInstances.erase(instance);
+    }
+};
+
+// Implemented by the factories which can specialize their instances
+struct interpreter_specialized_factory {
+    virtual ~interpreter_specialized_factory() {}
+
+    virtual void setSpecialization(int period) = 0;
+};
+
 template <class REAL, int TRACE>
-struct interpreter_dsp_factory_aux : public dsp_factory_imp {
+struct interpreter_dsp_factory_aux : public dsp_factory_imp, public interpreter_specialized_factory {
     int fVersion;
     int fNumInputs;
     int fNumOutputs;
@@ -63,8 +143,8 @@ struct interpreter_dsp_factory_aux : public dsp_factory_imp {
     int fIOTAOffset;
     int fOptLevel;
 
-    bool        fOptimized;
-    std::string fCompileOptions;
+    std::once_flag fOptimized;
+    std::string    fCompileOptions;
 
     FIRMetaBlockInstruction*                fMetaBlock;
     FIRUserInterfaceBlockInstruction<REAL>* fUserInterfaceBlock;
@@ -75,6 +155,17 @@ struct interpreter_dsp_factory_aux : public dsp_factory_imp {
     FBCBlockInstruction<REAL>*              fComputeBlock;
     FBCBlockInstruction<REAL>*              fComputeDSPBlock;
 
+    // Specialization of the instances on the [specialize:1] controls (see 'setSpecialization' and interpreter_dsp_aux_pe.hh)
+    int                                 fSpecializePeriod;     // Period in ms of the specialization thread, 0 if not used
+    interpreter_specialization_worker*  fSpecWorker;           // Created by 'optimize' if fSpecializePeriod > 0
+    FBCBlockInstruction<REAL>*          fSpecComputeBlock;     // Non optimized 'control' block
+    FBCBlockInstruction<REAL>*          fSpecComputeDSPBlock;  // Non optimized 'DSP' block
+    std::vector<int>                    fSpecZones;            // Offsets of the specialized controls
+    std::vector<int>                    fSpecIntConstants;     // Int heap offsets not changed after 'instanceConstants'
+    std::vector<int>                    fSpecRealConstants;    // Real heap offsets not changed after 'instanceConstants'
+    std::set<int>                       fSpecIntStores;        // Int heap offsets written by the 'DSP' block
+    std::set<int>                       fSpecRealStores;       // Real heap offsets written by the 'DSP' block
+
     interpreter_dsp_factory_aux(const std::string& name, const std::string& compile_options, const std::string& sha_key,
                                 int version_num, int inputs, int outputs, int int_heap_size, int real_heap_size,
                                 int sound_heap_size, int sr_offset, int count_offset, int iota_offset, int opt_level,
@@ -93,7 +184,6 @@ struct interpreter_dsp_factory_aux : public dsp_factory_imp {
           fCountOffset(count_offset),
           fIOTAOffset(iota_offset),
           fOptLevel(opt_level),
-          fOptimized(false),
           fCompileOptions(compile_options),
           fMetaBlock(meta),
           fUserInterfaceBlock(firinterface),
@@ -102,7 +192,11 @@ struct interpreter_dsp_factory_aux : public dsp_factory_imp {
           fResetUIBlock(resetui),
           fClearBlock(clear),
           fComputeBlock(compute_control),
-          fComputeDSPBlock(compute_dsp)
+          fComputeDSPBlock(compute_dsp),
+          fSpecializePeriod(0),
+          fSpecWorker(nullptr),
+          fSpecComputeBlock(nullptr),
+          fSpecComputeDSPBlock(nullptr)
     {}
 
     virtual FBCExecutor<REAL>* createFBCExecutor()
@@ -113,6 +207,7 @@ struct interpreter_dsp_factory_aux : public dsp_factory_imp {
     virtual ~interpreter_dsp_factory_aux()
     {
         // No more DSP instances, so delete
+        delete fSpecWorker;
         delete fMetaBlock;
         delete fUserInterfaceBlock;
         delete fStaticInitBlock;
@@ -121,9 +216,18 @@ struct interpreter_dsp_factory_aux : public dsp_factory_imp {
         delete fClearBlock;
         delete fComputeBlock;
         delete fComputeDSPBlock;
+        delete fSpecComputeBlock;
+        delete fSpecComputeDSPBlock;
     }
 
     void optimize(); // moved in interpreted_dsp.hh
+    void prepareSpecialization(); // moved in interpreted_dsp.hh
+    
+    // Called once by 'optimize', when the blocks are optimized and packed
+    virtual void prepareExecutors() {}
+
+    // To be called before the first instance is created
+    virtual void setSpecialization(int period) { fSpecializePeriod = period; }
  
     void write(std::ostream* out, bool binary = false, bool small = false)
     {
@@ -866,6 +970,12 @@ class EXPORT interpreter_dsp_factory : public dsp_factory, public faust_smartabl
 
     dsp_factory_base* getFactory() { return fFactory; }
 
+    void setSpecialization(int period);
+
+    void setTieredExecution(bool tiered);
+    int  getInterpretedComputeCount();
+    int  getCompiledSwapCount();
+
     void write(std::ostream* out, bool binary = false, bool small = false) { fFactory->write(out, binary, small); }
 };
 
@@ -22,202 +22,254 @@
 #ifndef interpreter_dsp_aux_pe_h
 #define interpreter_dsp_aux_pe_h
 
-#include "interpreter_dsp_aux.h"
+#include <atomic>
 
-// Specialization using partial evaluation: making controllers constant and optimizing the code.
+#include "interpreter_dsp_aux.hh"
+#include "interpreter_optimizer.hh"
+
+/*
+ Specialization using partial evaluation: the 'control' and 'DSP' blocks are specialized on the values computed
+ by 'classInit' and 'instanceConstants' (like the sample rate) and on the current values of the slow-changing
+ controls (see FIRUserInterfaceBlockInstruction::getSpecializedZones), then optimized. Folded constants and dead
+ branches thus vanish from the sample loop.
+
+ The specialization thread of the factory (shared by all its instances) polls the specialized controls of each
+ instance, and builds a new specialization when their values have changed and stayed the same during one period. The audio thread takes it at the next block (wait-free),
+ and runs the generic code as long as the current specialization does not match the control values.
+ Replaced specializations are given back to the specialization thread to be deleted.
+
+ Used when activated with interpreter_dsp_factory::setSpecialization (its parameter is the polling period in ms),
+ on the controls declared with [specialize:1] metadata.
+*/
 
 template <class REAL, int TRACE>
-class interpreter_dsp_aux_pe : public interpreter_dsp_aux<REAL, TRACE> {
+class interpreter_dsp_aux_pe : public interpreter_dsp_aux<REAL, TRACE>, public interpreter_specialized_instance {
     protected:
-        FBCBlockInstruction<REAL>* fStaticInitBlock;
-        FBCBlockInstruction<REAL>* fInitBlock;
-        FBCBlockInstruction<REAL>* fResetUIBlock;
-        FBCBlockInstruction<REAL>* fClearBlock;
-        FBCBlockInstruction<REAL>* fComputeBlock;
-        FBCBlockInstruction<REAL>* fComputeDSPBlock;
-    
+
+        struct Specialization {
+            std::vector<REAL>          fValues;  // Values of the specialized controls
+            FBCBlockInstruction<REAL>* fComputeBlock;
+            FBCBlockInstruction<REAL>* fComputeDSPBlock;
+            Specialization*            fNext;    // In the list of replaced specializations
+
+            Specialization(const std::vector<REAL>& values, FBCBlockInstruction<REAL>* compute,
+                           FBCBlockInstruction<REAL>* compute_dsp)
+                : fValues(values), fComputeBlock(compute), fComputeDSPBlock(compute_dsp), fNext(nullptr)
+            {
+            }
+
+            ~Specialization()
+            {
+                delete fComputeBlock;
+                delete fComputeDSPBlock;
+            }
+        };
+
+        // Values computed by 'classInit' and 'instanceConstants'
         std::map<int, int>  fIntMap;
         std::map<int, REAL> fRealMap;
-    
+
+        Specialization*              fCurrent;   // Only used by the audio thread
+        std::atomic<Specialization*> fReady;     // Built by the specialization thread, not yet taken by the audio thread
+        std::atomic<Specialization*> fReplaced;  // Given back by the audio thread
+
+        // Only used by the specialization thread
+        std::vector<REAL> fBuiltValues;   // Control values of the latest built specialization
+        std::vector<REAL> fPolledValues;  // Control values at the previous period
+
+        bool fPolled;  // Registered in the specialization thread of the factory
+
+        void readValues(std::vector<REAL>& values)
+        {
+            values.resize(this->fFactory->fSpecZones.size());
+            for (size_t i = 0; i < values.size(); i++) {
+                values[i] = this->fFBCExecutor->getRealValue(this->fFactory->fSpecZones[i]);
+            }
+        }
+
+        bool matchValues(Specialization* spec)
+        {
+            for (size_t i = 0; i < spec->fValues.size(); i++) {
+                if (this->fFBCExecutor->getRealValue(this->fFactory->fSpecZones[i]) != spec->fValues[i]) return false;
+            }
+            return true;
+        }
+
+        void readConstants()
+        {
+            fIntMap.clear();
+            fRealMap.clear();
+            for (auto& it : this->fFactory->fSpecIntConstants) {
+                fIntMap[it] = this->fFBCExecutor->getIntValue(it);
+            }
+            for (auto& it : this->fFactory->fSpecRealConstants) {
+                fRealMap[it] = this->fFBCExecutor->getRealValue(it);
+            }
+        }
+
+        Specialization* specialize(const std::vector<REAL>& values)
+        {
+            std::map<int, int>  int_map  = fIntMap;
+            std::map<int, REAL> real_map = fRealMap;
+            for (size_t i = 0; i < values.size(); i++) {
+                real_map[this->fFactory->fSpecZones[i]] = values[i];
+            }
+
+            // Constant values stored by the 'control' block are removed from the code and propagated in the maps
+            FBCBlockInstruction<REAL>* compute =
+                FBCInstructionOptimizer<REAL>::specialize(this->fFactory->fSpecComputeBlock->copy(), int_map, real_map);
+
+            // So they must not be written by the 'DSP' block
+            for (auto& it : int_map) {
+                if (this->fFactory->fSpecIntStores.find(it.first) != this->fFactory->fSpecIntStores.end()) {
+                    delete compute;
+                    return nullptr;
+                }
+            }
+            for (auto& it : real_map) {
+                if (this->fFactory->fSpecRealStores.find(it.first) != this->fFactory->fSpecRealStores.end()) {
+                    delete compute;
+                    return nullptr;
+                }
+            }
+
+            // The state is kept in the heap, so that the generic and specialized code can be exchanged at any block
+            FBCBlockInstruction<REAL>* compute_dsp =
+                FBCInstructionOptimizer<REAL>::specialize(this->fFactory->fSpecComputeDSPBlock->copy(), int_map, real_map, false);
+
+            compute     = FBCInstructionOptimizer<REAL>::optimizeBlock(compute, 1, this->fFactory->fOptLevel);
+            compute_dsp = FBCInstructionOptimizer<REAL>::optimizeBlock(compute_dsp, 1, this->fFactory->fOptLevel);
+
+            // Lowered in packed form here instead of in the audio thread
+            compute->pack(TRACE == 0);
+            compute_dsp->pack(TRACE == 0);
+
+            return new Specialization(values, compute, compute_dsp);
+        }
+
+        void deleteReplaced()
+        {
+            Specialization* spec = fReplaced.exchange(nullptr, std::memory_order_acquire);
+            while (spec) {
+                Specialization* next = spec->fNext;
+                delete spec;
+                spec = next;
+            }
+        }
+
+        void stop()
+        {
+            if (fPolled) {
+                this->fFactory->fSpecWorker->removeInstance(this);
+                fPolled = false;
+            }
+            delete fCurrent;
+            fCurrent = nullptr;
+            delete fReady.exchange(nullptr);
+            deleteReplaced();
+        }
+
+        // Specialize on the current constants and control values, then start polling the controls (not in the audio thread)
+        void restart()
+        {
+            stop();
+
+            readValues(fBuiltValues);
+            fPolledValues = fBuiltValues;
+            fCurrent      = specialize(fBuiltValues);
+
+            this->fFactory->fSpecWorker->addInstance(this);
+            fPolled = true;
+        }
+
     public:
         interpreter_dsp_aux_pe(interpreter_dsp_factory_aux<REAL, TRACE>* factory)
+            : interpreter_dsp_aux<REAL, TRACE>(factory),
+              fCurrent(nullptr),
+              fReady(nullptr),
+              fReplaced(nullptr),
+              fPolled(false)
         {
-            std::cout << "interpreter_dsp_aux_pe\n";
-            /*
-             if (this->fFactory->getMemoryManager()) {
-             this->fInputs  = static_cast<T**>(this->fFactory->allocate(sizeof(T*) * this->fFactory->fNumInputs));
-             this->fOutputs = static_cast<T**>(this->fFactory->allocate(sizeof(T*) * this->fFactory->fNumOutputs));
-             } else {
-             this->fInputs  = new T*[this->fFactory->fNumInputs];
-             this->fOutputs = new T*[this->fFactory->fNumOutputs];
-             }
-             */
-            
-            /*
-             fFactory->fStaticInitBlock->write(&std::cout, false);
-             fFactory->fInitBlock->write(&std::cout, false);
-             fFactory->fResetUIBlock->write(&std::cout, false);
-             fFactory->fClearBlock->write(&std::cout, false);
-             fFactory->fComputeBlock->write(&std::cout, false);
-             fFactory->fComputeDSPBlock->write(&std::cout, false);
-             std::cout << "size " << fFactory->fComputeDSPBlock->size() << std::endl;
-             */
-            
-            this->fFactory     = factory;
-            this->fFBCExecutor = factory->createFBCExecutor();
-            
-            fStaticInitBlock = nullptr;
-            fInitBlock       = nullptr;
-            fResetUIBlock    = nullptr;
-            fClearBlock      = nullptr;
-            fComputeBlock    = nullptr;
-            fComputeDSPBlock = nullptr;
         }
-    
-        virtual ~interpreter_dsp_aux_pe()
+
+        virtual ~interpreter_dsp_aux_pe() { stop(); }
+
+        virtual void pollSpecialization()
         {
-            /*
-             if (this->fFactory->getMemoryManager()) {
-             this->fFactory->destroy(this->fInputs);
-             this->fFactory->destroy(this->fOutputs);
-             } else {
-             delete[] this->fInputs;
-             delete[] this->fOutputs;
-             }
-             */
-            
-            delete this->fStaticInitBlock;
-            delete this->fInitBlock;
-            delete this->fResetUIBlock;
-            delete this->fClearBlock;
-            delete this->fComputeBlock;
-            delete this->fComputeDSPBlock;
+            deleteReplaced();
+
+            std::vector<REAL> values;
+            readValues(values);
+            if (values != fBuiltValues && values == fPolledValues) {
+                fBuiltValues         = values;
+                Specialization* spec = specialize(values);
+                // A specialization not taken yet by the audio thread can be deleted
+                if (spec) delete fReady.exchange(spec, std::memory_order_acq_rel);
+            }
+            fPolledValues = values;
         }
-    
+
         virtual void instanceConstants(int sample_rate)
         {
-            // Store sample_rate in specialization fIntMap
-            fIntMap[this->fFactory->fSROffset] = sample_rate;
-            
-            // Store sample_rate in 'fSampleate' variable at correct offset in fIntHeap
-            this->fFBCExecutor->setIntValue(this->fFactory->fSROffset, sample_rate);
-            
-            // Execute state init instructions
-            this->fFBCExecutor->ExecuteBlock(this->fFactory->fInitBlock);
+            interpreter_dsp_aux<REAL, TRACE>::instanceConstants(sample_rate);
+            readConstants();
+            restart();
         }
-    
-        virtual void init(int sample_rate)
+
+        virtual void instanceResetUserInterface()
+        {
+            interpreter_dsp_aux<REAL, TRACE>::instanceResetUserInterface();
+            restart();
+        }
+
+        virtual void instanceInit(int sample_rate)
         {
-            this->fInitialized = true;
-            
-            // Store sample_rate in specialization fIntMap
-            fIntMap[this->fFactory->fSROffset] = sample_rate;
-            
-            // Store sample_rate in 'fSampleRate' variable at correct offset in fIntHeap
-            this->fFBCExecutor->setIntValue(this->fFactory->fSROffset, sample_rate);
-            
+            // Specialized only once, after the controls have been reset
             this->classInit(sample_rate);
-            this->instanceInit(sample_rate);
-            
-            // Propagate constant values stored in the code into the heap
-            this->fStaticInitBlock =
-            FBCInstructionOptimizer<T>::specialize2Heap(this->fFactory->fStaticInitBlock->copy(), fIntMap, fRealMap);
-            this->fInitBlock =
-            FBCInstructionOptimizer<T>::specialize2Heap(this->fFactory->fInitBlock->copy(), fIntMap, fRealMap);
-            this->fResetUIBlock =
-            FBCInstructionOptimizer<T>::specialize2Heap(this->fFactory->fResetUIBlock->copy(), fIntMap, fRealMap);
-            this->fClearBlock =
-            FBCInstructionOptimizer<T>::specialize2Heap(this->fFactory->fClearBlock->copy(), fIntMap, fRealMap);
-            
-            // Suppress IOTA from fIntMap since we don't want specialization to use it
-            if (fIntMap.find(this->fFactory->fIOTAOffset) != fIntMap.end()) {
-                fIntMap.erase(fIntMap.find(this->fFactory->fIOTAOffset));
-            }
-            
-            // Freeze all controllers
-            this->fFactory->fUserInterfaceBlock->freezeDefaultValues(fRealMap);
-            
-            // To test : unfreeze "freg, gate, gain" controllers
-            std::map<std::string, int>& map = this->fFactory->fUserInterfaceBlock->getPathMap();
-            for (auto& it : map) {
-                if ((it.first.find("freq") != std::string::npos) || (it.first.find("gate") != std::string::npos) ||
-                    (it.first.find("gain") != std::string::npos)) {
-                    this->fFactory->fUserInterfaceBlock->unFreezeValue(fRealMap, it.first);
-                }
-            }
-            // Keep button on
-            // this->fFactory->fUserInterfaceBlock->unFreezeValue(fRealMap, FBCInstruction::kAddButton);
-            
-            // Specialization by partial evaluation
-            this->fComputeBlock =
-            FBCInstructionOptimizer<T>::specialize(this->fFactory->fComputeBlock->copy(), fIntMap, fRealMap);
-            
-        #ifdef MACHINE
-            // LLVM JIT only works on unoptimized FBC
-            this->fComputeDSPBlock = this->fFactory->fComputeDSPBlock->copy();
-        #else
-            this->fComputeDSPBlock =
-            FBCInstructionOptimizer<T>::optimizeBlock(this->fFactory->fComputeDSPBlock->copy(), 1, 4);
-        #endif
-            
-            // To test C++ generation
-            // this->fComputeDSPBlock = this->fFactory->fComputeDSPBlock->copy();
-            
-            this->fComputeDSPBlock = FBCInstructionOptimizer<T>::specialize(this->fComputeDSPBlock, fIntMap, fRealMap);
-            
-        #ifndef MACHINE
-            // // LLVM JIT only works on unoptimized FBC
-            this->fComputeBlock    = FBCInstructionOptimizer<T>::optimizeBlock(this->fComputeBlock, 5, 6);
-            this->fComputeDSPBlock = FBCInstructionOptimizer<T>::optimizeBlock(this->fComputeDSPBlock, 5, 6);
-        #endif
-            
-            /*
-             this->fStaticInitBlock->write(&std::cout, false);
-             this->fInitBlock->write(&std::cout, false);
-             this->fResetUIBlock->write(&std::cout, false);
-             this->fClearBlock->write(&std::cout, false);
-             this->fComputeBlock->write(&std::cout, false);
-             this->fComputeDSPBlock->write(&std::cout, false);
-             */
-            /*
-             #ifdef MACHINE
-             FBCCPPGenerator<T> cpp_generator(this->fFactory);
-             cpp_generator.generateCode(std::cout, this->fComputeBlock, this->fComputeDSPBlock);
-             #endif
-             */
+            interpreter_dsp_aux<REAL, TRACE>::instanceConstants(sample_rate);
+            readConstants();
+            interpreter_dsp_aux<REAL, TRACE>::instanceResetUserInterface();
+            interpreter_dsp_aux<REAL, TRACE>::instanceClear();
+            restart();
         }
-    
+
         virtual void compute(int count, FAUSTFLOAT** inputs_aux, FAUSTFLOAT** outputs_aux)
         {
-            if (count == 0) return;  // Beware: compiled loop don't work with an index of 0
-            
-            if (TRACE > 0 && !this->fInitialized) {
-                std::cout << "======== DSP is not initialized ! ========" << std::endl;
-            } else {
-                // std::cout << "compute " << count << std::endl;
-                T** inputs  = reinterpret_cast<T**>(inputs_aux);
-                T** outputs = reinterpret_cast<T**>(outputs_aux);
-                
-                // Prepare in/out buffers
-                for (int i = 0; i < this->fFactory->fNumInputs; i++) {
-                    this->fFBCExecutor->setInput(i, inputs[i]);
-                }
-                for (int i = 0; i < this->fFactory->fNumOutputs; i++) {
-                    this->fFBCExecutor->setOutput(i, outputs[i]);
+            if (count == 0) return;  // Beware: compiled loop does not work with an index of 0
+
+            REAL** inputs  = reinterpret_cast<REAL**>(inputs_aux);
+            REAL** outputs = reinterpret_cast<REAL**>(outputs_aux);
+
+            // Prepare in/out buffers
+            for (int i = 0; i < this->fFactory->fNumInputs; i++) {
+                this->fFBCExecutor->setInput(i, inputs[i]);
+            }
+            for (int i = 0; i < this->fFactory->fNumOutputs; i++) {
+                this->fFBCExecutor->setOutput(i, outputs[i]);
+            }
+
+            // Set count in 'count' variable at the correct offset in fIntHeap
+            this->fFBCExecutor->setIntValue(this->fFactory->fCountOffset, count);
+
+            // Take the latest specialization, and give back the replaced one
+            if (fReady.load(std::memory_order_relaxed)) {
+                Specialization* ready = fReady.exchange(nullptr, std::memory_order_acquire);
+                if (fCurrent && ready) {
+                    fCurrent->fNext = fReplaced.load(std::memory_order_relaxed);
+                    while (!fReplaced.compare_exchange_weak(fCurrent->fNext, fCurrent, std::memory_order_release)) {
+                    }
                 }
-                
-                // Set count in 'count' variable at the correct offset in fIntHeap
-                this->fFBCExecutor->setIntValue(this->fFactory->fCountOffset, count);
-                
-                // Executes the specialized 'control' block
-                this->fFBCExecutor->ExecuteBlock(this->fComputeBlock);
-                
-                // Executes the specialized 'DSP' block
-        #ifdef MACHINE
-                this->fFBCExecutor->ExecuteBlock(this->fComputeDSPBlock, true);
-        #else
-                this->fFBCExecutor->ExecuteBlock(this->fComputeDSPBlock);
-        #endif
+                if (ready) fCurrent = ready;
+            }
+
+            if (fCurrent && matchValues(fCurrent)) {
+                // Executes the specialized 'control' and 'DSP' blocks
+                this->fFBCExecutor->ExecuteBlock(fCurrent->fComputeBlock);
+                this->fFBCExecutor->ExecuteBlock(fCurrent->fComputeDSPBlock);
+            } else {
+                // Executes the generic 'control' and 'DSP' blocks until the controls are specialized again
+                this->fFBCExecutor->ExecuteBlock(this->fFactory->fComputeBlock);
+                this->fFBCExecutor->ExecuteBlock(this->fFactory->fComputeDSPBlock);
             }
         }
 };
@@ -46,7 +46,6 @@ EXPORT interpreter_dsp_factory* createInterpreterDSPFactoryFromFile(const string
 EXPORT interpreter_dsp_factory* createInterpreterDSPFactoryFromString(const string& name_app, const string& dsp_content,
                                                                       int argc, const char* argv[], string& error_msg)
 {
-    LOCK_API
     string expanded_dsp_content, sha_key;
 
     //if ((expanded_dsp_content = expandDSPFromString(name_app, dsp_content, argc, argv, sha_key, error_msg)) == "") {
@@ -57,36 +56,49 @@ EXPORT interpreter_dsp_factory* createInterpreterDSPFactoryFromString(const stri
         dsp_factory_table<SDsp_factory>::factory_iterator it;
         interpreter_dsp_factory* factory = nullptr;
 
-        if (gInterpreterFactoryTable.getFactory(sha_key, it)) {
-            SDsp_factory sfactory = (*it).first;
-            sfactory->addReference();
-            return sfactory;
-        } else {
-            int         argc1 = 0;
-            const char* argv1[64];
-            argv1[argc1++] = "faust";
-            argv1[argc1++] = "-lang";
-            argv1[argc1++] = "interp";
-            argv1[argc1++] = "-o";
-            argv1[argc1++] = "string";
-            // Copy arguments
-            for (int i = 0; i < argc; i++) {
-                argv1[argc1++] = argv[i];
+        {
+            LOCK_API
+            if (gInterpreterFactoryTable.getFactory(sha_key, it)) {
+                SDsp_factory sfactory = (*it).first;
+                sfactory->addReference();
+                return sfactory;
             }
-            argv1[argc1] = nullptr;  // NULL terminated argv
-            
-            dsp_factory_base* dsp_factory_aux =
-                compileFaustFactory(argc1, argv1, name_app.c_str(), dsp_content.c_str(), error_msg, true);
-            if (dsp_factory_aux) {
-                dsp_factory_aux->setName(name_app);
-                factory = new interpreter_dsp_factory(dsp_factory_aux);
-                gInterpreterFactoryTable.setFactory(factory);
-                factory->setSHAKey(sha_key);
-                factory->setDSPCode(expanded_dsp_content);
-                return factory;
-            } else {
-                return nullptr;
+        }
+        
+        // The compilation itself is done without holding the API lock,
+        // so that several factories can be compiled concurrently
+        int         argc1 = 0;
+        const char* argv1[64];
+        argv1[argc1++] = "faust";
+        argv1[argc1++] = "-lang";
+        argv1[argc1++] = "interp";
+        argv1[argc1++] = "-o";
+        argv1[argc1++] = "string";
+        // Copy arguments
+        for (int i = 0; i < argc; i++) {
+            argv1[argc1++] = argv[i];
+        }
+        argv1[argc1] = nullptr;  // NULL terminated argv
+        
+        dsp_factory_base* dsp_factory_aux =
+            compileFaustFactory(argc1, argv1, name_app.c_str(), dsp_content.c_str(), error_msg, true);
+        if (dsp_factory_aux) {
+            LOCK_API
+            // The same factory may have been created by another thread in the meantime
+            if (gInterpreterFactoryTable.getFactory(sha_key, it)) {
+                delete dsp_factory_aux;
+                SDsp_factory sfactory = (*it).first;
+                sfactory->addReference();
+                return sfactory;
             }
+            dsp_factory_aux->setName(name_app);
+            factory = new interpreter_dsp_factory(dsp_factory_aux);
+            gInterpreterFactoryTable.setFactory(factory);
+            factory->setSHAKey(sha_key);
+            factory->setDSPCode(expanded_dsp_content);
+            return factory;
+        } else {
+            return nullptr;
         }
     }
 }
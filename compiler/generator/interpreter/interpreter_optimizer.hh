@@ -34,17 +34,17 @@
 
 // Tables for math optimization
 
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2Heap;
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2Stack;
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2StackValue;
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2Value;
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2ValueInvert;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2Heap;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2Stack;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2StackValue;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2Value;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRMath2ValueInvert;
 
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2Heap;
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2Stack;
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2StackValue;
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2Value;
-static std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2ValueInvert;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2Heap;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2Stack;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2StackValue;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2Value;
+static thread_local std::map<FBCInstruction::Opcode, FBCInstruction::Opcode> gFIRExtendedMath2ValueInvert;
 
 //=======================
 // Optimization
@@ -646,7 +646,7 @@ struct FBCInstructionCastSpecializer : public FBCInstructionOptimizer<REAL> {
         
         if (inst1->fOpcode == FBCInstruction::kInt32Value && inst2->fOpcode == FBCInstruction::kCastReal) {
             end = cur + 2;
-            return new FBCBasicInstruction<REAL>(FBCInstruction::kRealValue, 0, T(inst1->fIntValue));
+            return new FBCBasicInstruction<REAL>(FBCInstruction::kRealValue, 0, REAL(inst1->fIntValue));
         } else if (inst1->fOpcode == FBCInstruction::kRealValue && inst2->fOpcode == FBCInstruction::kCastInt) {
             end = cur + 2;
             return new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, int(inst1->fRealValue), 0);
@@ -789,11 +789,16 @@ struct FBCInstructionMathSpecializer : public FBCInstructionOptimizer<REAL> {
             case FBCInstruction::kMultInt:
                 return new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, inst2->fIntValue * inst1->fIntValue, 0);
                 
+            // Division by zero is kept for execution time
             case FBCInstruction::kDivInt:
-                return new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, inst2->fIntValue / inst1->fIntValue, 0);
+                return (inst1->fIntValue != 0)
+                    ? new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, inst2->fIntValue / inst1->fIntValue, 0)
+                    : nullptr;
                 
             case FBCInstruction::kRemInt:
-                return new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, inst2->fIntValue % inst1->fIntValue, 0);
+                return (inst1->fIntValue != 0)
+                    ? new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, inst2->fIntValue % inst1->fIntValue, 0)
+                    : nullptr;
                 
             case FBCInstruction::kLshInt:
                 return new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, inst2->fIntValue << inst1->fIntValue, 0);
@@ -801,6 +806,10 @@ struct FBCInstructionMathSpecializer : public FBCInstructionOptimizer<REAL> {
             case FBCInstruction::kARshInt:
                 return new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, inst2->fIntValue >> inst1->fIntValue, 0);
                 
+            // Same as the interpreter (which does not implement the logical shift yet)
+            case FBCInstruction::kLRshInt:
+                return new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, inst2->fIntValue >> inst1->fIntValue, 0);
+                
             case FBCInstruction::kGTInt:
                 return new FBCBasicInstruction<REAL>(FBCInstruction::kInt32Value, inst2->fIntValue > inst1->fIntValue, 0);
                 
@@ -1073,8 +1082,14 @@ struct FBCInstructionMathSpecializer : public FBCInstructionOptimizer<REAL> {
             // Int
         } else if (inst1->fOpcode == FBCInstruction::kInt32Value && inst2->fOpcode == FBCInstruction::kInt32Value &&
                    FBCInstruction::isMath(inst3->fOpcode)) {
-            end = cur + 3;
-            return rewriteBinaryIntMath(inst1, inst2, inst3);
+            res = rewriteBinaryIntMath(inst1, inst2, inst3);
+            if (res) {
+                end = cur + 3;
+                return res;
+            } else {
+                end = cur + 1;
+                return (*cur)->copy();
+            }
             
         } else if (inst1->fOpcode == FBCInstruction::kInt32Value && inst2->fOpcode == FBCInstruction::kLoadInt &&
                    FBCInstruction::isMath(inst3->fOpcode)) {
@@ -1168,12 +1183,11 @@ struct FBCInstructionOptimizer {
             
             // Specialization
             if (inst1->fOpcode == FBCInstruction::kInt32Value && FBCInstruction::isChoice(inst2->fOpcode)) {
-                if (inst1->fIntValue == 1) {
+                // Any non-zero condition selects the first branch, like in the interpreter
+                if (inst1->fIntValue != 0) {
                     new_block->merge(optimize_aux(inst2->fBranch1, optimizer));
-                } else if (inst1->fIntValue == 0) {
-                    new_block->merge(optimize_aux(inst2->fBranch2, optimizer));
                 } else {
-                    faustassert(false);
+                    new_block->merge(optimize_aux(inst2->fBranch2, optimizer));
                 }
                 cur += 2;
             } else if (inst1->fOpcode == FBCInstruction::kLoop) {
@@ -1233,9 +1247,10 @@ struct FBCInstructionOptimizer {
         return optimize(cur_block, heap_2_map);
     }
     
-    // Specialize a block
+    // Specialize a block, 'propagate_stores' = false keeps the stores of constant values in the code
+    // (needed when they can be read before being written, like the DSP state in the sample loop)
     static FBCBlockInstruction<REAL>* specialize(FBCBlockInstruction<REAL>* cur_block, std::map<int, int>& int_map,
-                                                 std::map<int, REAL>& real_map)
+                                                 std::map<int, REAL>& real_map, bool propagate_stores = true)
     {
         FBCInstructionConstantValueMap2Heap<REAL> map_2_heap(int_map, real_map);
         FBCInstructionCastSpecializer<REAL>       cast_specializer;
@@ -1260,7 +1275,9 @@ struct FBCInstructionOptimizer {
             cur_block = specialize(cur_block, math_specializer);
             
             // Propagate constant values stored in the code into the heap
-            cur_block = optimize(cur_block, heap_2_map);
+            if (propagate_stores) {
+                cur_block = optimize(cur_block, heap_2_map);
+            }
             
             new_block_size = cur_block->size();
             
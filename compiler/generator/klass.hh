@@ -52,7 +52,7 @@ class Klass
    protected:
     // we make it global because several classes may need
     // power def but we want the code to be generated only once
-    static bool fNeedPowerDef;
+    static thread_local bool fNeedPowerDef;
 
     Klass* fParentKlass;  ///< Klass in which this Klass is embedded, void if toplevel Klass
     string fKlassName;
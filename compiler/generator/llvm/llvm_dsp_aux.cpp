@@ -91,6 +91,9 @@ int llvm_dsp_factory_aux::gInstance = 0;
 
 dsp_factory_table<SDsp_factory> llvm_dsp_factory_aux::gLLVMFactoryTable;
 
+// On-disk machine code cache (disabled when empty)
+string llvm_dsp_factory_aux::gCacheDirectory = "";
+
 uint64_t llvm_dsp_factory_aux::loadOptimize(const string& function)
 {
     uint64_t fun = fJIT->getFunctionAddress(function);
@@ -114,6 +117,7 @@ bool llvm_dsp_factory_aux::crossCompile(const string& target)
 
 void llvm_dsp_factory_aux::startLLVMLibrary()
 {
+    LOCK_API
     if (llvm_dsp_factory_aux::gInstance++ == 0) {
         // Install an LLVM error handler
     #if defined(__APPLE__) && (defined(LLVM_110) || defined(LLVM_120))
@@ -126,6 +130,7 @@ void llvm_dsp_factory_aux::startLLVMLibrary()
 
 void llvm_dsp_factory_aux::stopLLVMLibrary()
 {
+    LOCK_API
     if (--llvm_dsp_factory_aux::gInstance == 0) {
         // Remove the LLVM error handler
 #ifdef __APPLE__
@@ -143,7 +148,7 @@ llvm_dsp_factory_aux::llvm_dsp_factory_aux(const string& sha_key, const string&
 
     init("MachineDSP", "");
     fSHAKey = sha_key;
-    fTarget = (target == "") ? fTarget = (sys::getDefaultTargetTriple() + ":" + GET_CPU_NAME) : target;
+    fTarget = (target == "") ? (sys::getDefaultTargetTriple() + ":" + GET_CPU_NAME) : target;
 
     // Restoring the cache
     fObjectCache = new FaustObjectCache(machine_code);
@@ -154,6 +159,25 @@ llvm_dsp_factory_aux::llvm_dsp_factory_aux(const string& sha_key, const string&
     fDecoder = nullptr;
 }
 
+llvm_dsp_factory_aux::llvm_dsp_factory_aux(const string& sha_key, unique_ptr<MemoryBuffer> machine_code,
+                                           const string& target)
+    : dsp_factory_imp("MachineDSP", sha_key, "")
+{
+    startLLVMLibrary();
+
+    init("MachineDSP", "");
+    fSHAKey = sha_key;
+    fTarget = (target == "") ? (sys::getDefaultTargetTriple() + ":" + GET_CPU_NAME) : target;
+
+    // Restoring the cache without copying the mapped machine code
+    fObjectCache = new FaustObjectCache(std::move(machine_code));
+
+    // Creates module and context
+    fContext = new LLVMContext();
+    fModule  = new Module(string(LLVM_BACKEND_NAME) + ", v" + string(FAUSTVERSION), *fContext);
+    fDecoder = nullptr;
+}
+
 llvm_dsp_factory_aux::llvm_dsp_factory_aux(const string& sha_key, Module* module, LLVMContext* context,
                                            const string& target, int opt_level)
     : dsp_factory_imp("BitcodeDSP", sha_key, "")
@@ -162,7 +186,7 @@ llvm_dsp_factory_aux::llvm_dsp_factory_aux(const string& sha_key, Module* module
 
     init("BitcodeDSP", "");
     fSHAKey = sha_key;
-    fTarget = (target == "") ? fTarget = (sys::getDefaultTargetTriple() + ":" + GET_CPU_NAME) : target;
+    fTarget = (target == "") ? (sys::getDefaultTargetTriple() + ":" + GET_CPU_NAME) : target;
     setOptlevel(opt_level);
 
     fModule  = module;
@@ -495,6 +519,55 @@ llvm_dsp_factory* llvm_dsp_factory_aux::readDSPFactoryFromMachineAux(MEMORY_BUFF
     }
 }
 
+string llvm_dsp_factory_aux::getCachePath(const string& cache_dir, const string& expanded_sha_key,
+                                          const string& target, int opt_level)
+{
+    // The SHA key of the expanded DSP covers the code of the used libraries and the compilation options,
+    // and the compiler version is part of the key, so that a new version never reuses stale machine code
+    opt_level  = ((opt_level == -1) || (opt_level > LLVM_MAX_OPT_LEVEL)) ? LLVM_MAX_OPT_LEVEL : opt_level;
+    string key = expanded_sha_key + ":" + ((target == "") ? getDSPMachineTarget() : target) + ":" +
+                 to_string(opt_level) + ":" + FAUSTVERSION;
+    return cache_dir + "/" + generateSHA1(key) + ".o";
+}
+
+llvm_dsp_factory_aux* llvm_dsp_factory_aux::readDSPFactoryFromCache(const string& cache_path, const string& sha_key,
+                                                                    const string& target, int opt_level)
+{
+    // The file is mapped in memory by LLVM when possible
+    ErrorOr<OwningPtr<MemoryBuffer>> buffer = MemoryBuffer::getFile(cache_path);
+    if (buffer.getError()) return nullptr;
+
+    llvm_dsp_factory_aux* factory_aux = new llvm_dsp_factory_aux(sha_key, std::move(buffer.get()), target);
+    factory_aux->setOptlevel(opt_level);
+    return factory_aux;
+}
+
+bool llvm_dsp_factory_aux::writeDSPFactoryToCache(const string& cache_dir, const string& cache_path)
+{
+    string machine_code = fObjectCache->getMachineCode();
+    if (machine_code == "" || sys::fs::create_directories(cache_dir)) return false;
+
+    // Write in a temporary file and rename it, so that concurrent readers never see a partial file
+    int              fd;
+    SmallString<256> tmp_path;
+    if (sys::fs::createUniqueFile(cache_path + "-%%%%%%", fd, tmp_path)) return false;
+    {
+        raw_fd_ostream out(fd, true);
+        out << machine_code;
+        out.flush();
+        if (out.has_error()) {
+            out.clear_error();
+            sys::fs::remove(tmp_path);
+            return false;
+        }
+    }
+    if (sys::fs::rename(tmp_path, cache_path)) {
+        sys::fs::remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
 string llvm_dsp_factory_aux::getTarget()
 {
     return fTarget;
@@ -525,6 +598,18 @@ EXPORT string getDSPMachineTarget()
     return (sys::getDefaultTargetTriple() + ":" + GET_CPU_NAME);
 }
 
+EXPORT void setDSPFactoryCacheDirectory(const string& cache_dir)
+{
+    LOCK_API
+    llvm_dsp_factory_aux::gCacheDirectory = cache_dir;
+}
+
+EXPORT string getDSPFactoryCacheDirectory()
+{
+    LOCK_API
+    return llvm_dsp_factory_aux::gCacheDirectory;
+}
+
 EXPORT vector<string> getLibraryList(llvm_dsp_factory* factory)
 {
     LOCK_API
@@ -681,6 +766,11 @@ EXPORT char* getCDSPMachineTarget()
     return strdup(dspmachinetarget.c_str());
 }
 
+EXPORT void setCDSPFactoryCacheDirectory(const char* cache_dir)
+{
+    setDSPFactoryCacheDirectory((cache_dir) ? cache_dir : "");
+}
+
 EXPORT const char** getCDSPFactoryLibraryList(llvm_dsp_factory* factory)
 {
     if (factory) {
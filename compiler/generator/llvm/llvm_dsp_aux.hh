@@ -179,24 +179,31 @@ class EXPORT llvm_dsp : public dsp {
 
 class FaustObjectCache : public llvm::ObjectCache {
    private:
-    std::string fMachineCode;
+    std::string                         fMachineCode;
+    std::unique_ptr<llvm::MemoryBuffer> fMappedCode;  // Machine code mapped from the on-disk cache
 
    public:
     FaustObjectCache(const std::string& machine_code = "") : fMachineCode(machine_code) {}
+    FaustObjectCache(std::unique_ptr<llvm::MemoryBuffer> mapped_code) : fMappedCode(std::move(mapped_code)) {}
 
     virtual ~FaustObjectCache() {}
 
     virtual void notifyObjectCompiled(const llvm::Module* M, llvm::MemoryBufferRef Obj)
     {
         fMachineCode = Obj.getBuffer().str();
+        fMappedCode.reset();
     }
 
     virtual std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* M)
     {
-        return (fMachineCode == "") ? nullptr : llvm::MemoryBuffer::getMemBuffer(llvm::StringRef(fMachineCode));
+        if (fMappedCode) {
+            return llvm::MemoryBuffer::getMemBuffer(fMappedCode->getMemBufferRef(), false);
+        } else {
+            return (fMachineCode == "") ? nullptr : llvm::MemoryBuffer::getMemBuffer(llvm::StringRef(fMachineCode));
+        }
     }
 
-    std::string getMachineCode() { return fMachineCode; }
+    std::string getMachineCode() { return (fMappedCode) ? fMappedCode->getBuffer().str() : fMachineCode; }
 };
 
 typedef class faust_smartptr<llvm_dsp_factory> SDsp_factory;
@@ -253,6 +260,9 @@ class llvm_dsp_factory_aux : public dsp_factory_imp {
 
     llvm_dsp_factory_aux(const std::string& sha_key, const std::string& machine_code, const std::string& target);
 
+    llvm_dsp_factory_aux(const std::string& sha_key, std::unique_ptr<llvm::MemoryBuffer> machine_code,
+                         const std::string& target);
+
     virtual ~llvm_dsp_factory_aux();
 
     std::string              getCompileOptions();
@@ -265,6 +275,17 @@ class llvm_dsp_factory_aux : public dsp_factory_imp {
     static llvm_dsp_factory* readDSPFactoryFromMachineAux(MEMORY_BUFFER buffer, const std::string& target,
                                                           std::string& error_msg);
 
+    // On-disk machine code cache, keyed by the SHA key of the expanded DSP, target and optimisation level
+    static std::string gCacheDirectory;
+
+    static std::string getCachePath(const std::string& cache_dir, const std::string& expanded_sha_key,
+                                    const std::string& target, int opt_level);
+
+    static llvm_dsp_factory_aux* readDSPFactoryFromCache(const std::string& cache_path, const std::string& sha_key,
+                                                         const std::string& target, int opt_level);
+
+    bool writeDSPFactoryToCache(const std::string& cache_dir, const std::string& cache_path);
+
     // Bitcode
     virtual std::string writeDSPFactoryToBitcode() { return ""; }
 
@@ -385,6 +406,10 @@ EXPORT bool deleteDSPFactory(llvm_dsp_factory* factory);
 
 EXPORT std::string getDSPMachineTarget();
 
+EXPORT void setDSPFactoryCacheDirectory(const std::string& cache_dir);
+
+EXPORT std::string getDSPFactoryCacheDirectory();
+
 EXPORT std::vector<std::string> getLibraryList(llvm_dsp_factory* factory);
 
 EXPORT std::vector<std::string> getAllDSPFactories();
@@ -424,6 +449,8 @@ EXPORT char* getCDSPCode(llvm_dsp_factory* factory);
 
 EXPORT char* getCDSPMachineTarget();
 
+EXPORT void setCDSPFactoryCacheDirectory(const char* cache_dir);
+
 EXPORT const char** getCDSPFactoryLibraryList(llvm_dsp_factory* factory);
 
 EXPORT const char** getCDSPFactoryIncludePathnames(llvm_dsp_factory* factory);
@@ -589,11 +589,29 @@ EXPORT llvm_dsp_factory* createDSPFactoryFromFile(const string& filename, int ar
     }
 }
 
+// Publish a new factory, unless the same one has been created by another thread in the meantime
+static llvm_dsp_factory* registerDSPFactory(llvm_dsp_factory_aux* factory_aux, const string& sha_key,
+                                           const string& expanded_dsp_content)
+{
+    LOCK_API
+    dsp_factory_table<SDsp_factory>::factory_iterator it;
+    if (llvm_dsp_factory_aux::gLLVMFactoryTable.getFactory(sha_key, it)) {
+        delete factory_aux;
+        SDsp_factory sfactory = (*it).first;
+        sfactory->addReference();
+        return sfactory;
+    }
+    llvm_dsp_factory* factory = new llvm_dsp_factory(factory_aux);
+    llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory);
+    factory->setSHAKey(sha_key);
+    factory->setDSPCode(expanded_dsp_content);
+    return factory;
+}
+
 EXPORT llvm_dsp_factory* createDSPFactoryFromString(const string& name_app, const string& dsp_content, int argc,
                                                     const char* argv[], const string& target, string& error_msg,
                                                     int opt_level)
 {
-    LOCK_API
     string expanded_dsp_content, sha_key;
     
     //if ((expanded_dsp_content = expandDSPFromString(name_app, dsp_content, argc, argv, sha_key, error_msg)) == "") {
@@ -602,53 +620,83 @@ EXPORT llvm_dsp_factory* createDSPFactoryFromString(const string& name_app, cons
     } else {
         
         dsp_factory_table<SDsp_factory>::factory_iterator it;
-        llvm_dsp_factory* factory = nullptr;
+        llvm_dsp_factory_aux* cached_aux = nullptr;
+        string cache_dir, cache_path;
         
-        if (llvm_dsp_factory_aux::gLLVMFactoryTable.getFactory(sha_key, it)) {
-            SDsp_factory sfactory = (*it).first;
-            sfactory->addReference();
-            return sfactory;
-        } else {
-            int         argc1 = 0;
-            const char* argv1[64];
-            argv1[argc1++] = "faust";
-            argv1[argc1++] = "-lang";
-            // argv1[argc1++] = "cllvm";
-            argv1[argc1++] = "llvm";
-            argv1[argc1++] = "-o";
-            argv1[argc1++] = "string";
-            // Copy arguments
-            for (int i = 0; i < argc; i++) {
-                argv1[argc1++] = argv[i];
+        {
+            LOCK_API
+            if (llvm_dsp_factory_aux::gLLVMFactoryTable.getFactory(sha_key, it)) {
+                SDsp_factory sfactory = (*it).first;
+                sfactory->addReference();
+                return sfactory;
             }
-            argv1[argc1] = nullptr;  // NULL terminated argv
-            
-            llvm_dynamic_dsp_factory_aux* factory_aux = nullptr;
+            cache_dir = llvm_dsp_factory_aux::gCacheDirectory;
+        }
+        
+        // The on-disk cache is keyed by the expanded DSP (which contains the used libraries and the compilation options),
+        // and is read without holding the API lock
+        if (cache_dir != "") {
+            string expanded_sha_key, expand_error;
+            if (expandDSPFromString(name_app, dsp_content, argc, argv, expanded_sha_key, expand_error) != "") {
+                cache_path = llvm_dsp_factory_aux::getCachePath(cache_dir, expanded_sha_key, target, opt_level);
+                cached_aux = llvm_dsp_factory_aux::readDSPFactoryFromCache(cache_path, sha_key, target, opt_level);
+            }
+        }
+        
+        // Machine code found in the on-disk cache: no compilation needed
+        if (cached_aux) {
+            cached_aux->setClassName(getParam(argc, argv, "-cn", "mydsp"));
+            cached_aux->setName(name_app);
+            string cache_error;
             try {
-                factory_aux = static_cast<llvm_dynamic_dsp_factory_aux*>(
-                                                                         compileFaustFactory(argc1, argv1, name_app.c_str(), dsp_content.c_str(), error_msg, true));
-                if (factory_aux) {
-                    factory_aux->setTarget(target);
-                    factory_aux->setOptlevel(opt_level);
-                    factory_aux->setClassName(getParam(argc, argv, "-cn", "mydsp"));
-                    factory_aux->setName(name_app);
-                    if (!factory_aux->initJIT(error_msg)) {
-                        goto error;
-                    }
-                    factory = new llvm_dsp_factory(factory_aux);
-                    llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory);
-                    factory->setSHAKey(sha_key);
-                    factory->setDSPCode(expanded_dsp_content);
-                    return factory;
+                if (cached_aux->initJIT(cache_error)) {
+                    return registerDSPFactory(cached_aux, sha_key, expanded_dsp_content);
                 }
-            } catch (faustexception& e) {
-                error_msg = e.what();
-                goto error;
+            } catch (faustexception&) {
             }
-        error:
-            delete factory_aux;
-            return nullptr;
+            // Unusable cache entry, which will be replaced below
+            delete cached_aux;
         }
+        
+        // The compilation and JIT steps are done without holding the API lock,
+        // so that several factories can be compiled concurrently
+        int         argc1 = 0;
+        const char* argv1[64];
+        argv1[argc1++] = "faust";
+        argv1[argc1++] = "-lang";
+        // argv1[argc1++] = "cllvm";
+        argv1[argc1++] = "llvm";
+        argv1[argc1++] = "-o";
+        argv1[argc1++] = "string";
+        // Copy arguments
+        for (int i = 0; i < argc; i++) {
+            argv1[argc1++] = argv[i];
+        }
+        argv1[argc1] = nullptr;  // NULL terminated argv
+        
+        llvm_dynamic_dsp_factory_aux* factory_aux = nullptr;
+        try {
+            factory_aux = static_cast<llvm_dynamic_dsp_factory_aux*>(
+                                                                     compileFaustFactory(argc1, argv1, name_app.c_str(), dsp_content.c_str(), error_msg, true));
+            if (factory_aux) {
+                factory_aux->setTarget(target);
+                factory_aux->setOptlevel(opt_level);
+                factory_aux->setClassName(getParam(argc, argv, "-cn", "mydsp"));
+                factory_aux->setName(name_app);
+                factory_aux->setSHAKey(sha_key);
+                if (!factory_aux->initJIT(error_msg)) {
+                    goto error;
+                }
+                if (cache_path != "") factory_aux->writeDSPFactoryToCache(cache_dir, cache_path);
+                return registerDSPFactory(factory_aux, sha_key, expanded_dsp_content);
+            }
+        } catch (faustexception& e) {
+            error_msg = e.what();
+            goto error;
+        }
+    error:
+        delete factory_aux;
+        return nullptr;
     }
 }
 
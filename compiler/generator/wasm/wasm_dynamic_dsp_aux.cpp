@@ -26,6 +26,7 @@
 #include "wasm_dynamic_dsp_aux.hh"
 #include "Text.hh"
 #include "compatibility.hh"
+#include "lock_api.hh"
 
 #ifdef WIN32
 #define strdup _strdup
@@ -110,6 +111,7 @@ EXPORT wasm_dsp_factory* createWasmDSPFactoryFromString(const string& name_app,
             compileFaustFactory(argc1, argv1, name_app.c_str(), dsp_content.c_str(), error_msg, true);
 
         if (dsp_factory_aux) {
+            LOCK_API
             dsp_factory_aux->setName(name_app);
             wasm_dsp_factory* factory = new wasm_dsp_factory(dsp_factory_aux);
             wasm_dsp_factory::gWasmFactoryTable.setFactory(factory);
@@ -88,8 +88,15 @@ extern FILE*       yyin;
 extern const char* yyfilename;
 
 // CG globals
-list<Garbageable*> global::gObjectTable;
-bool               global::gHeapCleanup = false;
+thread_local vector<Garbageable*> global::gObjectTable;
+thread_local bool                 global::gHeapCleanup    = false;
+thread_local vector<char*>        global::gArenaChunks;
+thread_local char*                global::gArenaCur       = nullptr;
+thread_local char*                global::gArenaEnd       = nullptr;
+thread_local size_t               global::gArenaAllocated = 0;
+thread_local size_t               global::gArenaBytes     = 0;
+thread_local size_t               global::gArenaLarge     = 0;
+thread_local size_t               global::gArenaDeleted   = 0;
 
 /*
 faust1 uses a loop size of 512, but 512 makes faust2 crash (stack allocation error).
@@ -240,10 +247,14 @@ global::global() : TABBER(1), gLoopDetector(1024, 400), gStackOverflowDetector(M
     gCountInferences = 0;
     gCountMaximal    = 0;
 
+    gRecGlobalIterations = 0;
+
     gDummyInput = 10000;
 
     gBoxSlotNumber = 0;
     gMemoryManager = false;
+    gStructLayout  = false;
+    gCommonSubexpressions = false;
 
     gLocalCausalityCheck = false;
     gCausality           = false;
@@ -622,6 +633,8 @@ void global::printCompilationOptions(stringstream& dst, bool backend)
     if (gOneSample) dst << "-os ";
     if (gLightMode) dst << "-light ";
     if (gMemoryManager) dst << "-mem ";
+    if (gStructLayout) dst << "-sl ";
+    if (gCommonSubexpressions) dst << "-cse ";
     if (gComputeMix) dst << "-cm ";
     if (gRangeUI) dst << "-rui ";
     if (gMathApprox) dst << "-mapp ";
@@ -795,59 +808,131 @@ string global::getFreshID(const string& prefix)
     return subst("$0$1", prefix, T(n));
 }
 
-void Garbageable::cleanup()
+/*
+ Garbageable objects are allocated by bumping a pointer in large chunks, each object
+ being preceded by a header keeping its index in gObjectTable. Objects bigger than
+ kArenaLargeSize get their own block. Deleting an object during a compilation only
+ clears its table entry, memory is given back in one shot by Garbageable::cleanup.
+*/
+
+#define kArenaChunkSize (1 << 16)
+#define kArenaLargeSize (kArenaChunkSize / 16)
+
+struct ArenaHeader {
+    size_t fIndex;  // index in gObjectTable
+    size_t fLarge;  // true when allocated outside of the arena
+};
+
+// Keep 16 bytes alignment for the returned objects
+static const size_t kArenaHeaderSize = (sizeof(ArenaHeader) + 15) & ~size_t(15);
+
+static ArenaHeader* getArenaHeader(void* ptr)
+{
+    return reinterpret_cast<ArenaHeader*>(static_cast<char*>(ptr) - kArenaHeaderSize);
+}
+
+static void* arenaAllocate(size_t size)
+{
+    // HACK : add 16 bytes to avoid unsolved memory smashing bug...
+    size_t block = kArenaHeaderSize + ((size + 16 + 15) & ~size_t(15));
+    char*  res;
+
+    if (block > kArenaLargeSize) {
+        res = static_cast<char*>(malloc(block));
+        global::gArenaLarge++;
+    } else {
+        if (global::gArenaCur + block > global::gArenaEnd) {
+            global::gArenaCur = static_cast<char*>(malloc(kArenaChunkSize));
+            global::gArenaEnd = global::gArenaCur + kArenaChunkSize;
+            global::gArenaChunks.push_back(global::gArenaCur);
+        }
+        res = global::gArenaCur;
+        global::gArenaCur += block;
+    }
+    if (!res) throw std::bad_alloc();
+
+    ArenaHeader* header = reinterpret_cast<ArenaHeader*>(res);
+    header->fIndex      = global::gObjectTable.size();
+    header->fLarge      = (block > kArenaLargeSize);
+
+    void* obj = res + kArenaHeaderSize;
+    global::gObjectTable.push_back(static_cast<Garbageable*>(obj));
+    global::gArenaAllocated++;
+    global::gArenaBytes += size;
+    return obj;
+}
+
+static void arenaRelease(void* ptr)
 {
-    std::list<Garbageable*>::iterator it;
+    ArenaHeader* header = getArenaHeader(ptr);
 
-    // Here removing the deleted pointer from the list is pointless
-    // and takes time, thus we don't do it.
+    // We may have cases when a pointer will be deleted during
+    // a compilation, thus the pointer has to be removed from the table.
+    global::gObjectTable[header->fIndex] = nullptr;
+    if (!global::gHeapCleanup) {
+        global::gArenaDeleted++;
+    }
+    // Arena memory is only given back by cleanup
+    if (header->fLarge) {
+        free(header);
+    }
+}
+
+void Garbageable::cleanup()
+{
+    // Objects are deleted in reverse order of allocation
     global::gHeapCleanup = true;
-    for (it = global::gObjectTable.begin(); it != global::gObjectTable.end(); it++) {
+    for (size_t i = global::gObjectTable.size(); i-- > 0;) {
+        Garbageable* obj = global::gObjectTable[i];
+        if (!obj) continue;
 #ifdef _WIN32
         // Hack : "this" and actual pointer are not the same: destructor cannot be called...
-        Garbageable::operator delete(*it);
+        Garbageable::operator delete(obj);
 #else
-        delete (*it);
+        delete obj;
 #endif
     }
 
+    // Release the whole arena
+    for (auto& it : global::gArenaChunks) {
+        free(it);
+    }
+
     // Reset to default state
-    global::gObjectTable.clear();
-    global::gHeapCleanup = false;
+    vector<Garbageable*>().swap(global::gObjectTable);
+    vector<char*>().swap(global::gArenaChunks);
+    global::gArenaCur       = nullptr;
+    global::gArenaEnd       = nullptr;
+    global::gArenaAllocated = 0;
+    global::gArenaBytes     = 0;
+    global::gArenaLarge     = 0;
+    global::gArenaDeleted   = 0;
+    global::gHeapCleanup    = false;
+}
+
+void Garbageable::printStatistics(std::ostream& fout)
+{
+    fout << "Garbageable arena : " << global::gArenaAllocated << " objects (" << global::gArenaLarge
+         << " large), " << global::gArenaBytes << " bytes, " << global::gArenaChunks.size() << " chunks of "
+         << kArenaChunkSize << " bytes, " << global::gArenaDeleted << " deleted before cleanup" << endl;
 }
 
 void* Garbageable::operator new(size_t size)
 {
-    // HACK : add 16 bytes to avoid unsolved memory smashing bug...
-    Garbageable* res = (Garbageable*)malloc(size + 16);
-    global::gObjectTable.push_front(res);
-    return res;
+    return arenaAllocate(size);
 }
 
 void Garbageable::operator delete(void* ptr)
 {
-    // We may have cases when a pointer will be deleted during
-    // a compilation, thus the pointer has to be removed from the list.
-    if (!global::gHeapCleanup) {
-        global::gObjectTable.remove(static_cast<Garbageable*>(ptr));
-    }
-    free(ptr);
+    arenaRelease(ptr);
 }
 
 void* Garbageable::operator new[](size_t size)
 {
-    // HACK : add 16 bytes to avoid unsolved memory smashing bug...
-    Garbageable* res = (Garbageable*)malloc(size + 16);
-    global::gObjectTable.push_front(res);
-    return res;
+    return arenaAllocate(size);
 }
 
 void Garbageable::operator delete[](void* ptr)
 {
-    // We may have cases when a pointer will be deleted during
-    // a compilation, thus the pointer has to be removed from the list.
-    if (!global::gHeapCleanup) {
-        global::gObjectTable.remove(static_cast<Garbageable*>(ptr));
-    }
-    free(ptr);
+    arenaRelease(ptr);
 }
@@ -216,11 +216,17 @@ struct global {
 
     int gCountInferences;
     int gCountMaximal;
+
+    vector<int> gRecComponentSizes;       ///< size of each recursive definitions component of the last typeAnnotation
+    vector<int> gRecComponentIterations;  ///< fixpoint iterations of each component of the last typeAnnotation
+    int         gRecGlobalIterations;     ///< checking iterations on all recursive definitions of the last typeAnnotation
     int gDummyInput;
 
     int gBoxSlotNumber;  ///< counter for unique slot number
 
     bool gMemoryManager;
+    bool gStructLayout;  ///< when true DSP struct fields are reordered by their use in 'compute'
+    bool gCommonSubexpressions;  ///< when true common subexpressions and loop invariants of 'compute' are computed once
 
     bool gLocalCausalityCheck;  ///< when true trigs local causality errors (negative delay)
 
@@ -536,9 +542,16 @@ struct global {
     int    gNumOutputs;
     string gErrorMessage;
 
-    // GC
-    static list<Garbageable*> gObjectTable;
-    static bool               gHeapCleanup;
+    // GC : Garbageable objects are allocated in an arena of chunks released at once by Garbageable::cleanup
+    static thread_local vector<Garbageable*> gObjectTable;
+    static thread_local bool                 gHeapCleanup;
+    static thread_local vector<char*>        gArenaChunks;
+    static thread_local char*                gArenaCur;
+    static thread_local char*                gArenaEnd;
+    static thread_local size_t               gArenaAllocated;  // number of allocated objects
+    static thread_local size_t               gArenaBytes;      // number of requested bytes
+    static thread_local size_t               gArenaLarge;      // number of objects allocated outside of the arena
+    static thread_local size_t               gArenaDeleted;    // number of objects deleted before cleanup
 
     global();
     ~global();
@@ -582,8 +595,8 @@ struct global {
     int audioSampleSize();
 };
 
-// Unique shared global pointer
-extern global* gGlobal;
+// Compilation state, one per thread so that several compilations can run in parallel
+extern thread_local global* gGlobal;
 
 #define FAUST_LIB_PATH "FAUST_LIB_PATH"
 #define MAX_MACHINE_STACK_SIZE 65536
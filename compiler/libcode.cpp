@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <cstdlib>
+#include <functional>
 #include <fstream>
 #include <iostream>
 #include <list>
@@ -116,19 +117,19 @@
 
 using namespace std;
 
-static unique_ptr<ifstream> injcode;
-static unique_ptr<ifstream> enrobage;
+static thread_local unique_ptr<ifstream> injcode;
+static thread_local unique_ptr<ifstream> enrobage;
 
 #ifdef OCPP_BUILD
 // Old CPP compiler
-Compiler* old_comp = nullptr;
+static thread_local Compiler* old_comp = nullptr;
 #endif
 
 // FIR container
-InstructionsCompiler* new_comp  = nullptr;
-CodeContainer*        container = nullptr;
+static thread_local InstructionsCompiler* new_comp  = nullptr;
+static thread_local CodeContainer*        container = nullptr;
 
-typedef void* (*compile_fun)(void* arg);
+typedef function<void()> compile_fun;
 
 string reorganizeCompilationOptions(int argc, const char* argv[]);
 
@@ -180,54 +181,41 @@ static void enumBackends(ostream& out)
 #endif
 }
 
+static void* callFunAux(void* arg)
+{
+    (*static_cast<compile_fun*>(arg))();
+    return nullptr;
+}
+
+// The whole compilation runs in a single thread with more stack size, so that
+// the 'thread_local' compilation state (gGlobal, hash-consing and symbol tables,
+// object arena...) is created, used and released by the same thread.
 static void callFun(compile_fun fun)
 {
 #if defined(EMCC) || defined(_WIN32)
     // No thread support in JS or WIN32
-    fun(NULL);
+    fun();
 #else
     pthread_t      thread;
     pthread_attr_t attr;
     faustassert(pthread_attr_init(&attr) == 0);
     faustassert(pthread_attr_setstacksize(&attr, MAX_STACK_SIZE) == 0);
     faustassert(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE) == 0);
-    faustassert(pthread_create(&thread, &attr, fun, nullptr) == 0);
+    faustassert(pthread_create(&thread, &attr, callFunAux, &fun) == 0);
     pthread_join(thread, nullptr);
 #endif
 }
 
 static Tree evaluateBlockDiagram(Tree expandedDefList, int& numInputs, int& numOutputs);
 
-static void* threadEvaluateBlockDiagram(void* arg)
-{
-    try {
-        gGlobal->gProcessTree =
-            evaluateBlockDiagram(gGlobal->gExpandedDefList, gGlobal->gNumInputs, gGlobal->gNumOutputs);
-    } catch (faustexception& e) {
-        gGlobal->gErrorMessage = e.Message();
-    }
-    return 0;
-}
-
-static void* threadBoxPropagateSig(void* arg)
-{
-    try {
-        gGlobal->gLsignalsTree =
-            boxPropagateSig(gGlobal->nil, gGlobal->gProcessTree, makeSigInputList(gGlobal->gNumInputs));
-    } catch (faustexception& e) {
-        gGlobal->gErrorMessage = e.Message();
-    }
-    return 0;
-}
-
 /****************************************************************
                         Global context variable
 *****************************************************************/
 
-global* gGlobal = nullptr;
+thread_local global* gGlobal = nullptr;
 
 // Timing can be used outside of the scope of 'gGlobal'
-extern bool gTimingSwitch;
+extern thread_local bool gTimingSwitch;
 
 /****************************************************************
                         Parser variables
@@ -378,6 +366,14 @@ static bool processCmdline(int argc, const char* argv[])
             gGlobal->gMemoryManager = true;
             i += 1;
 
+        } else if (isCmd(argv[i], "-sl", "--struct-layout")) {
+            gGlobal->gStructLayout = true;
+            i += 1;
+
+        } else if (isCmd(argv[i], "-cse", "--common-subexpressions")) {
+            gGlobal->gCommonSubexpressions = true;
+            i += 1;
+
         } else if (isCmd(argv[i], "-sd", "--simplify-diagrams")) {
             gGlobal->gSimplifyDiagrams = true;
             i += 1;
@@ -878,6 +874,14 @@ static void printHelp()
     cout << tab
          << "-mem        --memory                    allocate static in global state using a custom memory manager."
          << endl;
+    cout << tab
+         << "-sl         --struct-layout             reorder DSP struct fields by their use in 'compute' (hot state first, "
+            "large buffers last)."
+         << endl;
+    cout << tab
+         << "-cse        --common-subexpressions     compute common subexpressions once and move loop invariants out "
+            "of the scalar 'compute' loop."
+         << endl;
     cout << tab
          << "-ftz <n>    --flush-to-zero <n>         code added to recursive signals [0:no (default), 1:fabs based, "
             "2:mask based (fastest)]."
@@ -1846,10 +1850,8 @@ static string expandDSPInternal(int argc, const char* argv[], const char* name,
     /****************************************************************
      3 - evaluate 'process' definition
     *****************************************************************/
-    callFun(threadEvaluateBlockDiagram);  // In a thread with more stack size...
-    if (!gGlobal->gProcessTree) {
-        throw faustexception(gGlobal->gErrorMessage);
-    }
+    gGlobal->gProcessTree =
+        evaluateBlockDiagram(gGlobal->gExpandedDefList, gGlobal->gNumInputs, gGlobal->gNumOutputs);
 
     // Encode compilation options as a 'declare' : has to be located first in the string
     stringstream out;
@@ -1940,10 +1942,8 @@ static void compileFaustFactoryAux(int argc, const char* argv[], const char* nam
      3 - evaluate 'process' definition
     *****************************************************************/
 
-    callFun(threadEvaluateBlockDiagram);  // In a thread with more stack size...
-    if (!gGlobal->gProcessTree) {
-        throw faustexception(gGlobal->gErrorMessage);
-    }
+    gGlobal->gProcessTree =
+        evaluateBlockDiagram(gGlobal->gExpandedDefList, gGlobal->gNumInputs, gGlobal->gNumOutputs);
     Tree process    = gGlobal->gProcessTree;
     int  numInputs  = gGlobal->gNumInputs;
     int  numOutputs = gGlobal->gNumOutputs;
@@ -1976,10 +1976,8 @@ static void compileFaustFactoryAux(int argc, const char* argv[], const char* nam
     *****************************************************************/
     startTiming("propagation");
 
-    callFun(threadBoxPropagateSig);  // In a thread with more stack size...
-    if (!gGlobal->gLsignalsTree) {
-        throw faustexception(gGlobal->gErrorMessage);
-    }
+    gGlobal->gLsignalsTree =
+        boxPropagateSig(gGlobal->nil, gGlobal->gProcessTree, makeSigInputList(gGlobal->gNumInputs));
     Tree lsignals = gGlobal->gLsignalsTree;
 
     if (gGlobal->gDetailsSwitch) {
@@ -1999,6 +1997,11 @@ static void compileFaustFactoryAux(int argc, const char* argv[], const char* nam
      6 - generate xml description, documentation or dot files
     *****************************************************************/
     generateOutputFiles();
+
+    if (gTimingSwitch) {
+        CTree::printHashTableStatistics(cerr);
+        Garbageable::printStatistics(cerr);
+    }
 }
 
 // ============
@@ -2008,37 +2011,41 @@ static void compileFaustFactoryAux(int argc, const char* argv[], const char* nam
 dsp_factory_base* compileFaustFactory(int argc, const char* argv[], const char* name, const char* dsp_content,
                                       string& error_msg, bool generate)
 {
-    gGlobal                   = nullptr;
     dsp_factory_base* factory = nullptr;
 
-    try {
-        global::allocate();
-        compileFaustFactoryAux(argc, argv, name, dsp_content, generate);
-        error_msg = gGlobal->gErrorMsg;
-        factory   = gGlobal->gDSPFactory;
-    } catch (faustexception& e) {
-        error_msg = e.Message();
-    }
+    callFun([&]() {
+        gGlobal = nullptr;
+        try {
+            global::allocate();
+            compileFaustFactoryAux(argc, argv, name, dsp_content, generate);
+            error_msg = gGlobal->gErrorMsg;
+            factory   = gGlobal->gDSPFactory;
+        } catch (faustexception& e) {
+            error_msg = e.Message();
+        }
+        global::destroy();
+    });
 
-    global::destroy();
     return factory;
 }
 
 string expandDSP(int argc, const char* argv[], const char* name, const char* dsp_content, string& sha_key,
                  string& error_msg)
 {
-    gGlobal    = nullptr;
     string res = "";
 
-    try {
-        global::allocate();
-        res       = expandDSPInternal(argc, argv, name, dsp_content);
-        sha_key   = generateSHA1(res);
-        error_msg = gGlobal->gErrorMsg;
-    } catch (faustexception& e) {
-        error_msg = e.Message();
-    }
+    callFun([&]() {
+        gGlobal = nullptr;
+        try {
+            global::allocate();
+            res       = expandDSPInternal(argc, argv, name, dsp_content);
+            sha_key   = generateSHA1(res);
+            error_msg = gGlobal->gErrorMsg;
+        } catch (faustexception& e) {
+            error_msg = e.Message();
+        }
+        global::destroy();
+    });
 
-    global::destroy();
     return res;
 }
@@ -23,8 +23,13 @@
 #include "export.hh"
 
 extern TLockAble* gDSPFactoriesLock;
+extern TLockAble* gDSPParserLock;
 
 #define LOCK_API TLock lock(gDSPFactoriesLock);
 
+// The flex/bison generated parser uses global state, so parsing is serialized
+// even when several compilations run concurrently
+#define LOCK_PARSER TLock parser_lock(gDSPParserLock);
+
 extern "C" EXPORT bool startMTDSPFactories();
 extern "C" EXPORT void stopMTDSPFactories();
@@ -46,6 +46,7 @@
 #include "ppbox.hh"
 #include "exception.hh"
 #include "global.hh"
+#include "lock_api.hh"
 #include "Text.hh"
 
 using namespace std;
@@ -254,6 +255,7 @@ inline bool isFILE(const char* name) { return strstr(name, "file://") != 0; }
 
 Tree SourceReader::parseFile(const char* fname)
 {
+    LOCK_PARSER
     yyerr = 0;
     yylineno = 1;
     yyfilename = fname;
@@ -337,6 +339,7 @@ Tree SourceReader::parseFile(const char* fname)
 
 Tree SourceReader::parseString(const char* fname)
 {
+    LOCK_PARSER
     yyerr = 0;
     yylineno = 1;
     yyfilename = fname;
@@ -24,6 +24,8 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <vector>
 
 #include "exception.hh"
 #include "global.hh"
@@ -72,8 +74,150 @@ static interval arithmetic(int opcode, const interval& x, const interval& y);
  * The empty type environment (also property key for closed term type)
  */
 
+/**
+ * Compute the recursive definitions each recursive definition depends on,
+ * that is the recursive signals reachable from its body without going through another recursive signal.
+ * @param vrec the recursive signals
+ * @param vdef their definitions
+ * @return the indexes of the recursive signals each definition depends on
+ */
+static vector<vector<int>> recDependencies(const vector<Tree>& vrec, const vector<Tree>& vdef)
+{
+    map<Tree, int> index;
+    for (int i = 0; i < int(vrec.size()); i++) {
+        index[vrec[i]] = i;
+    }
+
+    vector<vector<int>> deps(vdef.size());
+    vector<Tree>        stack;
+    vector<Tree>        subsigs;
+    for (int i = 0; i < int(vdef.size()); i++) {
+        CTree::startNewVisit();
+        stack.push_back(vdef[i]);
+        vdef[i]->setVisited();
+        while (!stack.empty()) {
+            Tree t = stack.back();
+            stack.pop_back();
+            map<Tree, int>::iterator it = index.find(t);
+            if (it != index.end()) {
+                deps[i].push_back(it->second);
+                continue;
+            }
+            subsigs.clear();
+            getSubSignals(t, subsigs, true);
+            for (Tree sub : subsigs) {
+                if (!sub->isAlreadyVisited()) {
+                    sub->setVisited();
+                    stack.push_back(sub);
+                }
+            }
+        }
+    }
+    return deps;
+}
+
+/**
+ * Split the recursive definitions into strongly connected components (Tarjan's algorithm, without recursion).
+ * @param deps the dependencies of each recursive definition
+ * @return the components, a component being listed after the components it depends on
+ */
+static vector<vector<int>> recComponents(const vector<vector<int>>& deps)
+{
+    int                 n = int(deps.size());
+    vector<int>         num(n, -1), low(n, 0);
+    vector<bool>        onstack(n, false);
+    vector<int>         stack;
+    vector<vector<int>> components;
+    int                 count = 0;
+
+    for (int root = 0; root < n; root++) {
+        if (num[root] >= 0) continue;
+        // (node, next dependency to visit)
+        vector<pair<int, int>> calls;
+        calls.push_back(make_pair(root, 0));
+        while (!calls.empty()) {
+            int v = calls.back().first;
+            int d = calls.back().second;
+            if (d == 0) {
+                num[v] = low[v] = count++;
+                stack.push_back(v);
+                onstack[v] = true;
+            }
+            if (d < int(deps[v].size())) {
+                calls.back().second++;
+                int w = deps[v][d];
+                if (num[w] < 0) {
+                    calls.push_back(make_pair(w, 0));
+                } else if (onstack[w]) {
+                    low[v] = min(low[v], num[w]);
+                }
+                continue;
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                int u  = calls.back().first;
+                low[u] = min(low[u], low[v]);
+            }
+            if (low[v] == num[v]) {
+                vector<int> component;
+                int         w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onstack[w] = false;
+                    component.push_back(w);
+                } while (w != v);
+                components.push_back(component);
+            }
+        }
+    }
+    return components;
+}
+
+/**
+ * Compute the types of a set of recursive definitions until they are stable,
+ * the other recursive signals keeping their current type.
+ * @param members the indexes of the recursive definitions to compute
+ * @param fixed the indexes of the other recursive signals the definitions depend on
+ * @return the number of iterations
+ */
+static int recFixpoint(const vector<Tree>& vrec, const vector<Tree>& vdef, vector<Type>& vtype, const vector<int>& members,
+                       const vector<int>& fixed)
+{
+    int iterations = 0;
+    for (bool finished = false; !finished;) {
+        iterations++;
+        // init recursive types
+        CTree::startNewVisit();
+        for (int i : fixed) {
+            setSigType(vrec[i], vtype[i]);
+            vrec[i]->setVisited();
+        }
+        for (int i : members) {
+            setSigType(vrec[i], vtype[i]);
+            vrec[i]->setVisited();
+        }
+
+        // compute recursive types
+        for (int i : members) {
+            vtype[i] = T(vdef[i], gGlobal->NULLTYPEENV);
+        }
+
+        // check finished
+        finished = true;
+        for (int i : members) {
+            // cerr << i << "-" << *vrec[i] << ":" << *getSigType(vrec[i]) << " => " << *vtype[i] << endl;
+            finished = finished && (getSigType(vrec[i]) == vtype[i]);
+        }
+    }
+    return iterations;
+}
+
 /**
  * Fully annotate every subtree of term with type information.
+ * The least fixpoint of the recursive types is computed by strongly connected component of the recursive
+ * definitions dependency graph, each component being computed after the components it depends on,
+ * then checked by one iteration on all recursive definitions.
  * @param sig the signal term tree to annotate
  * @param causality when true check causality issues
  */
@@ -108,26 +252,34 @@ void typeAnnotation(Tree sig, bool causality)
     faustassert(int(vtype.size()) == n);
 
     // cerr << "find least fixpoint" << endl;
-    for (bool finished = false; !finished;) {
-        // init recursive types
-        CTree::startNewVisit();
-        for (int i = 0; i < n; i++) {
-            setSigType(vrec[i], vtype[i]);
-            vrec[i]->setVisited();
+    vector<vector<int>> deps       = recDependencies(vrec, vdef);
+    vector<vector<int>> components = recComponents(deps);
+    gGlobal->gRecComponentSizes.clear();
+    gGlobal->gRecComponentIterations.clear();
+    vector<int> component_of(n);
+    for (int c = 0; c < int(components.size()); c++) {
+        for (int i : components[c]) {
+            component_of[i] = c;
         }
-
-        // compute recursive types
-        for (int i = 0; i < n; i++) {
-            vtype[i] = T(vdef[i], gGlobal->NULLTYPEENV);
+    }
+    for (int c = 0; c < int(components.size()); c++) {
+        // the components it depends on are already computed
+        vector<int> fixed;
+        for (int i : components[c]) {
+            for (int j : deps[i]) {
+                if (component_of[j] != c) fixed.push_back(j);
+            }
         }
+        gGlobal->gRecComponentSizes.push_back(int(components[c].size()));
+        gGlobal->gRecComponentIterations.push_back(recFixpoint(vrec, vdef, vtype, components[c], fixed));
+    }
 
-        // check finished
-        finished = true;
-        for (int i = 0; i < n; i++) {
-            // cerr << i << "-" << *vrec[i] << ":" << *getSigType(vrec[i]) << " => " << *vtype[i] << endl;
-            finished = finished && (getSigType(vrec[i]) == vtype[i]);
-        }
+    // check the solution on all recursive definitions (and complete it if needed)
+    vector<int> all(n);
+    for (int i = 0; i < n; i++) {
+        all[i] = i;
     }
+    gGlobal->gRecGlobalIterations = recFixpoint(vrec, vdef, vtype, all, vector<int>());
 
     // type full term
     T(sig, gGlobal->NULLTYPEENV);
@@ -139,6 +291,18 @@ void annotationStatistics()
          << clock() / CLOCKS_PER_SEC << 's' << endl;
     cerr << gGlobal->TABBER << "COUNT ALLOCATION " << gGlobal->gAllocationCount << endl;
     cerr << gGlobal->TABBER << "COUNT MAXIMAL " << gGlobal->gCountMaximal << endl;
+
+    int components = int(gGlobal->gRecComponentSizes.size());
+    int iterations = 0;
+    for (int c = 0; c < components; c++) {
+        iterations += gGlobal->gRecComponentIterations[c];
+    }
+    cerr << gGlobal->TABBER << "COUNT RECURSIVE COMPONENTS " << components << " ITERATIONS " << iterations
+         << " CHECK ITERATIONS " << gGlobal->gRecGlobalIterations << endl;
+    for (int c = 0; c < components; c++) {
+        cerr << gGlobal->TABBER << "COMPONENT " << c << " SIZE " << gGlobal->gRecComponentSizes[c] << " ITERATIONS "
+             << gGlobal->gRecComponentIterations[c] << endl;
+    }
 }
 
 /**
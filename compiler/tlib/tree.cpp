@@ -77,6 +77,7 @@ storage of trees.
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 
@@ -92,10 +93,16 @@ storage of trees.
         throw faustexception(s); \
     }
 
-Tree         CTree::gHashTable[kHashTableSize];
-bool         CTree::gDetails       = false;
-unsigned int CTree::gVisitTime     = 0;
-size_t       CTree::gSerialCounter = 0;
+// Hash-consing tables are per thread, each compilation being done on a single thread
+thread_local Tree*        CTree::gHashTable        = nullptr;
+thread_local size_t       CTree::gHashTableBits    = 0;
+thread_local size_t       CTree::gHashTableCount   = 0;
+thread_local size_t       CTree::gHashTableResizes = 0;
+thread_local size_t       CTree::gHashTableProbes  = 0;
+thread_local size_t       CTree::gHashTableLookups = 0;
+thread_local bool         CTree::gDetails          = false;
+thread_local unsigned int CTree::gVisitTime        = 0;
+thread_local size_t       CTree::gSerialCounter    = 0;
 
 // Constructor : add the tree to the hash table
 CTree::CTree(size_t hk, const Node& n, const tvec& br)
@@ -107,17 +114,23 @@ CTree::CTree(size_t hk, const Node& n, const tvec& br)
       fVisitTime(0),
       fBranch(br)
 {
+    // Grow the table before linking so that the average chain length stays bounded
+    if (gHashTableCount >= kMaxLoadFactor * hashTableSize()) {
+        resizeHashTable(gHashTableBits + 1);
+    }
+
     // link dans la hash table
-    int j         = hk % kHashTableSize;
+    size_t j      = bucketIndex(hk, gHashTableBits);
     fNext         = gHashTable[j];
     gHashTable[j] = this;
+    gHashTableCount++;
 }
 
 // Destructor : remove the tree from the hash table
 CTree::~CTree()
 {
-    int  i = fHashKey % kHashTableSize;
-    Tree t = gHashTable[i];
+    size_t i = bucketIndex(fHashKey, gHashTableBits);
+    Tree   t = gHashTable[i];
 
     // printf("Delete of "); this->print(); printf("\n");
     if (t == this) {
@@ -131,6 +144,7 @@ CTree::~CTree()
         faustassert(p);
         p->fNext = fNext;
     }
+    gHashTableCount--;
 }
 
 // equivalence
@@ -139,19 +153,78 @@ bool CTree::equiv(const Node& n, const tvec& br) const
     return (fNode == n) && (fBranch == br);
 }
 
+/**
+ * Combine the node content with the hash keys of the branches. Each step is
+ * a multiply-xorshift so that trees with the same node and permuted or
+ * numerically close branches (like int constants) get well separated keys.
+ */
 size_t CTree::calcTreeHash(const Node& n, const tvec& br)
 {
-    size_t               hk = size_t(n.getPointer());
-    tvec::const_iterator b  = br.begin();
-    tvec::const_iterator z  = br.end();
+    const size_t         mul   = size_t(0x9E3779B97F4A7C15ULL);
+    const int            shift = sizeof(size_t) * 4;
+    size_t               hk    = size_t(n.getPointer()) ^ size_t(n.type());
+    tvec::const_iterator b     = br.begin();
+    tvec::const_iterator z     = br.end();
 
     while (b != z) {
-        hk = (hk << 1) ^ (hk >> 20) ^ ((*b)->fHashKey);
+        hk = (hk ^ (*b)->fHashKey) * mul;
+        hk ^= hk >> shift;
         ++b;
     }
     return hk;
 }
 
+/**
+ * The table size is a power of two: the hash key is spread using Fibonacci hashing
+ * and its 'bits' upper bits are used as the bucket index (a one bucket table uses no bit).
+ */
+size_t CTree::bucketIndex(size_t hk, size_t bits)
+{
+    return (bits == 0) ? 0 : size_t((uint64_t(hk) * 11400714819323198485ULL) >> (64 - bits));
+}
+
+Tree CTree::lookup(size_t hk, const Node& n, const tvec& br)
+{
+    // Trees can be made during static initialization, before global::global calls init()
+    if (!gHashTable) init();
+
+    Tree t = gHashTable[bucketIndex(hk, gHashTableBits)];
+    gHashTableLookups++;
+
+    while (t && !((t->fHashKey == hk) && t->equiv(n, br))) {
+        gHashTableProbes++;
+        t = t->fNext;
+    }
+    return t;
+}
+
+/**
+ * Allocate a table of 2^bits entries and move all existing trees in it.
+ * Trees are relinked in place, no tree is reallocated.
+ */
+void CTree::resizeHashTable(size_t bits)
+{
+    Tree*  table = static_cast<Tree*>(calloc(size_t(1) << bits, sizeof(Tree)));
+    size_t size  = hashTableSize();
+    faustassert(table);
+
+    for (size_t i = 0; i < size; i++) {
+        Tree t = gHashTable[i];
+        while (t) {
+            Tree   next = t->fNext;
+            size_t j    = bucketIndex(t->fHashKey, bits);
+            t->fNext    = table[j];
+            table[j]    = t;
+            t           = next;
+        }
+    }
+
+    free(gHashTable);
+    gHashTable     = table;
+    gHashTableBits = bits;
+    gHashTableResizes++;
+}
+
 Tree CTree::make(const Node& n, int ar, Tree* tbl)
 {
     tvec br(ar);
@@ -159,22 +232,14 @@ Tree CTree::make(const Node& n, int ar, Tree* tbl)
     for (int i = 0; i < ar; i++) br[i] = tbl[i];
 
     size_t hk = calcTreeHash(n, br);
-    Tree   t  = gHashTable[hk % kHashTableSize];
-
-    while (t && !t->equiv(n, br)) {
-        t = t->fNext;
-    }
+    Tree   t  = lookup(hk, n, br);
     return (t) ? t : new CTree(hk, n, br);
 }
 
 Tree CTree::make(const Node& n, const tvec& br)
 {
     size_t hk = calcTreeHash(n, br);
-    Tree   t  = gHashTable[hk % kHashTableSize];
-
-    while (t && !t->equiv(n, br)) {
-        t = t->fNext;
-    }
+    Tree   t  = lookup(hk, n, br);
     return (t) ? t : new CTree(hk, n, br);
 }
 
@@ -202,10 +267,10 @@ ostream& CTree::print(ostream& fout) const
 void CTree::control()
 {
     printf("\ngHashTable Content :\n\n");
-    for (int i = 0; i < kHashTableSize; i++) {
+    for (size_t i = 0; i < hashTableSize(); i++) {
         Tree t = gHashTable[i];
         if (t) {
-            printf("%4d = ", i);
+            printf("%4zu = ", i);
             while (t) {
                 /*t->print();*/
                 printf(" => ");
@@ -217,9 +282,38 @@ void CTree::control()
     printf("\nEnd gHashTable\n");
 }
 
+void CTree::printHashTableStatistics(ostream& fout)
+{
+    size_t size    = hashTableSize();
+    size_t used    = 0;
+    size_t longest = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        size_t len = 0;
+        for (Tree t = gHashTable[i]; t; t = t->fNext) len++;
+        if (len > 0) used++;
+        if (len > longest) longest = len;
+    }
+
+    fout << "Tree hash table : " << gHashTableCount << " trees in " << size << " buckets ("
+         << gHashTableResizes << " resizes)" << endl;
+    fout << "Tree hash table : load factor " << double(gHashTableCount) / double(size) << ", used buckets "
+         << used << ", average chain " << ((used) ? double(gHashTableCount) / double(used) : 0.)
+         << ", longest chain " << longest << endl;
+    fout << "Tree hash table : " << gHashTableLookups << " lookups, average probes "
+         << ((gHashTableLookups) ? double(gHashTableProbes) / double(gHashTableLookups) : 0.) << endl;
+}
+
 void CTree::init()
 {
-    memset(gHashTable, 0, sizeof(Tree) * kHashTableSize);
+    free(gHashTable);
+    gHashTableBits    = kInitHashTableBits;
+    gHashTable        = static_cast<Tree*>(calloc(size_t(1) << kInitHashTableBits, sizeof(Tree)));
+    gHashTableCount   = 0;
+    gHashTableResizes = 0;
+    gHashTableProbes  = 0;
+    gHashTableLookups = 0;
+    faustassert(gHashTable);
 }
 
 // if t has a node of type int, return it otherwise error
@@ -402,8 +496,8 @@ void* getUserData(Tree t)
 
 void CTree::exportProperties(vector<Tree>& keys, vector<Tree>& values)
 {
-    for (plist::const_iterator p = fProperties.begin(); p != fProperties.end(); p++) {
-        keys.push_back(p->first);
-        values.push_back(p->second);
-    }
+    fProperties.forEach([&](Tree key, Tree value) {
+        keys.push_back(key);
+        values.push_back(value);
+    });
 }
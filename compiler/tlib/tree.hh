@@ -72,6 +72,8 @@
 #ifndef __TREE__
 #define __TREE__
 
+#include <stdint.h>
+#include <stdlib.h>
 #include <map>
 #include <vector>
 
@@ -85,8 +87,139 @@
 class CTree;
 typedef CTree* Tree;
 
-typedef map<Tree, Tree> plist;
-typedef vector<Tree>    tvec;
+typedef vector<Tree> tvec;
+
+/**
+ * The property list attached to each CTree. Properties are stored in a flat
+ * open-addressed table (linear probing, power-of-two capacity) allocated on the
+ * first setProperty. Most trees have no or very few properties, so this is
+ * much more compact than a node-based map and lookups stay in one cache line.
+ **/
+
+class PropertyList {
+   private:
+    struct Entry {
+        Tree fKey;
+        Tree fValue;
+    };
+
+    static const unsigned int kMinBits = 2;  ///< log2 of the capacity of the first allocated table
+
+    Entry*       fEntries;  ///< the table, nullptr when no property has been set yet
+    unsigned int fBits;     ///< log2 of the capacity of the table
+    unsigned int fSize;     ///< number of properties
+    unsigned int fUsed;     ///< number of properties and deleted entries
+
+    static Tree tombstone()
+    {
+        static char gTombstone;
+        return reinterpret_cast<Tree>(&gTombstone);
+    }
+
+    unsigned int capacity() const { return (fEntries) ? (1u << fBits) : 0; }
+
+    unsigned int index(Tree key) const
+    {
+        return (unsigned int)((uint64_t(size_t(key)) * 11400714819323198485ULL) >> (64 - fBits));
+    }
+
+    // Returns the entry of key or the first free entry where it can be inserted
+    Entry* find(Tree key) const
+    {
+        unsigned int mask = capacity() - 1;
+        Entry*       slot = nullptr;
+        for (unsigned int i = index(key);; i = (i + 1) & mask) {
+            Entry* e = &fEntries[i];
+            if (e->fKey == key) {
+                return e;
+            } else if (e->fKey == nullptr) {
+                return (slot) ? slot : e;
+            } else if (e->fKey == tombstone() && !slot) {
+                slot = e;
+            }
+        }
+    }
+
+    void rehash(unsigned int bits)
+    {
+        Entry*       old  = fEntries;
+        unsigned int size = capacity();
+        fEntries          = static_cast<Entry*>(calloc(size_t(1) << bits, sizeof(Entry)));
+        fBits             = bits;
+        fUsed             = fSize;
+        faustassert(fEntries);
+        for (unsigned int i = 0; i < size; i++) {
+            if (old[i].fKey && old[i].fKey != tombstone()) {
+                *find(old[i].fKey) = old[i];
+            }
+        }
+        free(old);
+    }
+
+   public:
+    PropertyList() : fEntries(nullptr), fBits(0), fSize(0), fUsed(0) {}
+    ~PropertyList() { free(fEntries); }
+
+    PropertyList(const PropertyList&) = delete;
+    PropertyList& operator=(const PropertyList&) = delete;
+
+    unsigned int size() const { return fSize; }
+
+    Tree get(Tree key) const
+    {
+        if (fSize == 0) return nullptr;
+        Entry* e = find(key);
+        return (e->fKey == key) ? e->fValue : nullptr;
+    }
+
+    void set(Tree key, Tree value)
+    {
+        // Keep at least one quarter of the table free (deleted entries included) so that probing stays short
+        if (4 * (fUsed + 1) > 3 * capacity()) {
+            unsigned int bits = kMinBits;
+            while (2 * (fSize + 1) > (1u << bits)) bits++;
+            rehash(bits);
+        }
+        Entry* e = find(key);
+        if (e->fKey != key) {
+            if (e->fKey == nullptr) fUsed++;
+            e->fKey = key;
+            fSize++;
+        }
+        e->fValue = value;
+    }
+
+    void erase(Tree key)
+    {
+        if (fSize == 0) return;
+        Entry* e = find(key);
+        if (e->fKey == key) {
+            e->fKey   = tombstone();
+            e->fValue = nullptr;
+            fSize--;
+        }
+    }
+
+    void clear()
+    {
+        free(fEntries);
+        fEntries = nullptr;
+        fBits    = 0;
+        fSize    = 0;
+        fUsed    = 0;
+    }
+
+    template <typename F>
+    void forEach(F fun) const
+    {
+        unsigned int size = capacity();
+        for (unsigned int i = 0; i < size; i++) {
+            if (fEntries[i].fKey && fEntries[i].fKey != tombstone()) {
+                fun(fEntries[i].fKey, fEntries[i].fValue);
+            }
+        }
+    }
+};
 
 /**
  * A CTree = (Node x [CTree]) is a Node associated with a list of subtrees called branches.
@@ -107,20 +240,26 @@ typedef vector<Tree>    tvec;
 
 class CTree : public virtual Garbageable {
    private:
-    static const int kHashTableSize = 400009;     ///< size of the hash table (prime number)
-    static size_t    gSerialCounter;              ///< the serial number counter
-    static Tree      gHashTable[kHashTableSize];  ///< hash table used for "hash consing"
+    static const size_t kInitHashTableBits = 16;  ///< log2 of the initial size of the hash table
+    static const size_t kMaxLoadFactor     = 2;   ///< average chain length that triggers a resize
+    static thread_local size_t gSerialCounter;     ///< the serial number counter
+    static thread_local Tree*  gHashTable;         ///< hash table used for "hash consing"
+    static thread_local size_t gHashTableBits;     ///< log2 of the current size of the hash table
+    static thread_local size_t gHashTableCount;    ///< number of trees currently in the hash table
+    static thread_local size_t gHashTableResizes;  ///< number of resizes done since init()
+    static thread_local size_t gHashTableProbes;   ///< number of chain links followed by make()
+    static thread_local size_t gHashTableLookups;  ///< number of calls to make()
 
    public:
-    static bool         gDetails;    ///< Ctree::print() print with more details when true
-    static unsigned int gVisitTime;  ///< Should be incremented for each new visit to keep track of visited tree.
+    static thread_local bool         gDetails;    ///< Ctree::print() print with more details when true
+    static thread_local unsigned int gVisitTime;  ///< Should be incremented for each new visit to keep track of visited tree.
 
    private:
     // fields
     Tree         fNext;        ///< next tree in the same hashtable entry
     Node         fNode;        ///< the node content of the tree
     void*        fType;        ///< the type of a tree
-    plist        fProperties;  ///< the properties list attached to the tree
+    PropertyList fProperties;  ///< the properties list attached to the tree
     size_t       fHashKey;     ///< the hashtable key
     size_t       fSerial;      ///< the increasing serial number
     int          fAperture;    ///< how "open" is a tree (synthezised field)
@@ -134,6 +273,11 @@ class CTree : public virtual Garbageable {
                                const tvec& br);  ///< compute the hash key of a tree according to its node and branches
     static int    calcTreeAperture(const Node& n, const tvec& br);  ///< compute how open is a tree
 
+    static size_t hashTableSize() { return (gHashTable) ? (size_t(1) << gHashTableBits) : 0; }
+    static size_t bucketIndex(size_t hk, size_t bits);  ///< spread the hash key on the current bucket range
+    static Tree   lookup(size_t hk, const Node& n, const tvec& br);  ///< search an equivalent tree in the hash table
+    static void   resizeHashTable(size_t bits);  ///< relink all trees in a new table of 2^bits entries
+
    public:
     virtual ~CTree();
 
@@ -153,6 +297,7 @@ class CTree : public virtual Garbageable {
     // Print a tree and the hash table (for debugging purposes)
     ostream&    print(ostream& fout) const;  ///< print recursively the content of a tree on a stream
     static void control();                   ///< print the hash table content (for debug purpose)
+    static void printHashTableStatistics(ostream& fout);  ///< print load factor and chain length statistics
 
     static void init();
 
@@ -169,21 +314,13 @@ class CTree : public virtual Garbageable {
     }
 
     // Property list of a tree
-    void setProperty(Tree key, Tree value) { fProperties[key] = value; }
+    void setProperty(Tree key, Tree value) { fProperties.set(key, value); }
     void clearProperty(Tree key) { fProperties.erase(key); }
-    void clearProperties() { fProperties = plist(); }
+    void clearProperties() { fProperties.clear(); }
 
     void exportProperties(vector<Tree>& keys, vector<Tree>& values);
 
-    Tree getProperty(Tree key)
-    {
-        plist::iterator i = fProperties.find(key);
-        if (i == fProperties.end()) {
-            return 0;
-        } else {
-            return i->second;
-        }
-    }
+    Tree getProperty(Tree key) { return fProperties.get(key); }
 };
 
 //---------------------------------API---------------------------------------
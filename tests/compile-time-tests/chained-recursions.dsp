@@ -0,0 +1,7 @@
+// Long chain of recursive groups, each one depending on the previous one:
+// the recursive types have to be computed by strongly connected component,
+// otherwise the type inference fixpoint takes as many iterations as groups.
+
+N = 300;
+
+process = seq(i, N, (+ ~ (*(0.5) : @(i%5+1))) : *(0.5));
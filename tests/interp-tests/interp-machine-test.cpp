@@ -25,6 +25,10 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
 
 #include "faust/dsp/interpreter-machine-dsp.h"
 #include "faust/audio/dummy-audio.h"
@@ -41,6 +45,46 @@ static void printList(const vector<string>& list)
     }
 }
 
+// Render 'nb_blocks' blocks, waiting between the blocks to let the compilation thread run if 'tiered' is set
+static vector<FAUSTFLOAT> render(const string& fbcFile, int nb_blocks, bool tiered,
+                                 int& interpreted, int& swaps)
+{
+    string error_msg;
+    vector<FAUSTFLOAT> res;
+    interpreter_dsp_factory* factory = readInterpreterDSPFactoryFromBitcodeFile(fbcFile, error_msg);
+    if (!factory) {
+        cerr << "Cannot create factory : " << error_msg;
+        exit(EXIT_FAILURE);
+    }
+    
+    factory->setTieredExecution(tiered);
+    dsp* DSP = factory->createDSPInstance();
+    DSP->init(44100);
+    
+    int buffer_size = 64;
+    vector<vector<FAUSTFLOAT> > inputs(DSP->getNumInputs(), vector<FAUSTFLOAT>(buffer_size));
+    vector<vector<FAUSTFLOAT> > outputs(DSP->getNumOutputs(), vector<FAUSTFLOAT>(buffer_size));
+    vector<FAUSTFLOAT*> inputs_ptr, outputs_ptr;
+    for (auto& it : inputs) inputs_ptr.push_back(it.data());
+    for (auto& it : outputs) outputs_ptr.push_back(it.data());
+    
+    for (int block = 0; block < nb_blocks; block++) {
+        for (auto& it : inputs) {
+            for (int i = 0; i < buffer_size; i++) it[i] = FAUSTFLOAT((block * buffer_size + i) % 100) / 100;
+        }
+        DSP->compute(buffer_size, inputs_ptr.data(), outputs_ptr.data());
+        for (auto& it : outputs) res.insert(res.end(), it.begin(), it.end());
+        if (tiered) this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    
+    interpreted = factory->getInterpretedComputeCount();
+    swaps = factory->getCompiledSwapCount();
+    
+    delete DSP;
+    deleteInterpreterDSPFactory(factory);
+    return res;
+}
+
 int main(int argc, const char** argv)
 {
     if (isopt((char**)argv, "-h") || isopt((char**)argv, "-help") || argc < 2) {
@@ -90,6 +134,30 @@ int main(int argc, const char** argv)
         delete DSP;
         deleteInterpreterDSPFactory(factory);
     }
+    
+    cout << "=============================\n";
+    cout << "Test tiered execution\n";
+    {
+        int interpreted, swaps;
+        
+        // Compiled before the first instance is created
+        vector<FAUSTFLOAT> compiled = render(fbcFile, 1000, false, interpreted, swaps);
+        cout << "compiled : interpreted " << interpreted << " swaps " << swaps << endl;
+        
+        // Interpreted, then compiled by the background thread
+        vector<FAUSTFLOAT> tiered = render(fbcFile, 1000, true, interpreted, swaps);
+        cout << "tiered : interpreted " << interpreted << " swaps " << swaps << endl;
+        
+        int failures = 0;
+        for (size_t i = 0; i < compiled.size(); i++) {
+            if (compiled[i] != tiered[i]) failures++;
+        }
+        cout << "tiered : " << failures << " failures" << endl;
+        if (failures != 0 || swaps != 1) {
+            cerr << "Tiered execution failed" << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
 
     return 0;
 }
@@ -0,0 +1,130 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "faust/dsp/interpreter-dsp.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+// Compiles several DSP programs concurrently, then the same DSP program in all threads,
+// and checks that each one produces the same impulse response as when compiled alone.
+
+#define BLOCK_SIZE 64
+
+static string dspCode(int i)
+{
+    stringstream code;
+    code << "process = *(" << (i % 8) + 1 << ") : + ~ *(0." << (i % 5) + 1 << ") : @(" << i << ");";
+    return code.str();
+}
+
+static bool impulseResponse(int i, vector<FAUSTFLOAT>& res, string& error_msg)
+{
+    stringstream name;
+    name << "mt" << i;
+    interpreter_dsp_factory* factory = createInterpreterDSPFactoryFromString(name.str(), dspCode(i), 0, NULL, error_msg);
+    if (!factory) return false;
+
+    dsp* DSP = factory->createDSPInstance();
+    if (!DSP) {
+        deleteInterpreterDSPFactory(factory);
+        return false;
+    }
+    DSP->init(44100);
+
+    FAUSTFLOAT in[BLOCK_SIZE] = { 1 };
+    FAUSTFLOAT out[BLOCK_SIZE];
+    FAUSTFLOAT* inputs[] = { in };
+    FAUSTFLOAT* outputs[] = { out };
+    DSP->compute(BLOCK_SIZE, inputs, outputs);
+    res.assign(out, out + BLOCK_SIZE);
+
+    delete DSP;
+    deleteInterpreterDSPFactory(factory);
+    return true;
+}
+
+// Compiles the DSP programs in 'nthreads' threads (program 0 in all threads if 'same' is set),
+// return the number of wrong impulse responses
+static int concurrentCompilations(int nthreads, bool same, const vector<vector<FAUSTFLOAT> >& reference)
+{
+    vector<vector<FAUSTFLOAT> > results(nthreads);
+    vector<string> errors(nthreads);
+    vector<thread> threads;
+    for (int i = 0; i < nthreads; i++) {
+        threads.push_back(thread([&, i]() { impulseResponse((same) ? 0 : i, results[i], errors[i]); }));
+    }
+    for (auto& it : threads) it.join();
+
+    int failures = 0;
+    for (int i = 0; i < nthreads; i++) {
+        if (results[i] != reference[(same) ? 0 : i]) {
+            cerr << "Thread " << i << " : wrong result " << errors[i] << endl;
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main(int argc, const char** argv)
+{
+    if (isopt((char**)argv, "-h") || isopt((char**)argv, "-help")) {
+        cout << "interp-mt-test [-n <threads>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int nthreads = lopt((char**)argv, "-n", 8);
+
+    // Reference responses, computed sequentially
+    vector<vector<FAUSTFLOAT> > reference(nthreads);
+    for (int i = 0; i < nthreads; i++) {
+        string error_msg;
+        if (!impulseResponse(i, reference[i], error_msg)) {
+            cerr << "Cannot create factory : " << error_msg;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (!startMTDSPFactories()) {
+        cerr << "Cannot start multi-thread access mode" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int failures = concurrentCompilations(nthreads, false, reference);
+    cout << nthreads << " concurrent compilations, " << failures << " failures" << endl;
+
+    // All threads compile the same source (and share the same factory in the cache)
+    int same_failures = concurrentCompilations(nthreads, true, reference);
+    cout << nthreads << " concurrent compilations of the same source, " << same_failures << " failures" << endl;
+
+    stopMTDSPFactories();
+
+    return (failures == 0 && same_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,137 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "faust/dsp/interpreter-dsp.h"
+#include "faust/dsp/dsp-combiner.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+// Checks that dsp_recursiver computed by sub-blocks of 'latency + 1' samples gives the same impulse response
+// as the sample by sample computation, and as the equivalent Faust recursive program.
+
+#define LENGTH 4096
+
+static const string gForward = "\\(fb, x).(x + 0.6 * fb, sin(fb) * 0.5 + x)";
+static const string gFeedback = "_ <: *(0.7), (mem : *(0.2)) :> _";
+
+static interpreter_dsp_factory* createFactory(const string& name, const string& code)
+{
+    string error_msg;
+    interpreter_dsp_factory* factory = createInterpreterDSPFactoryFromString(name, code, 0, nullptr, error_msg);
+    if (!factory) {
+        cerr << "Cannot create factory : " << error_msg;
+        exit(EXIT_FAILURE);
+    }
+    return factory;
+}
+
+static string delayCode(int latency)
+{
+    stringstream code;
+    code << "process = @(" << latency << ");";
+    return code.str();
+}
+
+// Impulse response computed with buffers of 'buffer_size' frames, all output channels
+static vector<FAUSTFLOAT> impulseResponse(dsp* DSP, int buffer_size)
+{
+    DSP->init(44100);
+    vector<FAUSTFLOAT> input(LENGTH, FAUSTFLOAT(0));
+    input[0] = FAUSTFLOAT(1);
+    vector<vector<FAUSTFLOAT>> outputs(DSP->getNumOutputs(), vector<FAUSTFLOAT>(LENGTH));
+
+    for (int frame = 0; frame < LENGTH; frame += buffer_size) {
+        FAUSTFLOAT* inputs_ptr[] = { &input[frame] };
+        vector<FAUSTFLOAT*> outputs_ptr;
+        for (auto& it : outputs) outputs_ptr.push_back(&it[frame]);
+        DSP->compute(min<int>(buffer_size, LENGTH - frame), inputs_ptr, outputs_ptr.data());
+    }
+
+    vector<FAUSTFLOAT> res;
+    for (auto& it : outputs) res.insert(res.end(), it.begin(), it.end());
+    delete DSP;
+    return res;
+}
+
+int main(int argc, const char** argv)
+{
+    if (isopt((char**)argv, "-h") || isopt((char**)argv, "-help")) {
+        cout << "interp-recursiver-test" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    interpreter_dsp_factory* forward = createFactory("forward", "process = " + gForward + ";");
+    interpreter_dsp_factory* feedback = createFactory("feedback", "process = " + gFeedback + ";");
+    int failures = 0;
+
+    for (int latency : { 0, 1, 3, 16, 63, 100 }) {
+
+        interpreter_dsp_factory* delay = createFactory("delay", delayCode(latency));
+        stringstream code;
+        code << "process = (" << gForward << ") ~ (" << gFeedback << " : @(" << latency << "));";
+        interpreter_dsp_factory* recursive = createFactory("recursive", code.str());
+
+        // Sample by sample computation, with the delay in the feedback DSP
+        string error;
+        dsp* feedback_delay = createDSPSequencer(feedback->createDSPInstance(), delay->createDSPInstance(), error);
+        vector<FAUSTFLOAT> reference = impulseResponse(createDSPRecursiver(forward->createDSPInstance(), feedback_delay, error), 64);
+
+        // Faust compiled version
+        vector<FAUSTFLOAT> faust = impulseResponse(recursive->createDSPInstance(), 64);
+        double max_diff = 0.;
+        for (size_t i = 0; i < reference.size(); i++) {
+            max_diff = max<double>(max_diff, fabs(reference[i] - faust[i]));
+        }
+        if (max_diff > 1e-5) {
+            cerr << "latency " << latency << " : differs from the Faust program (" << max_diff << ")" << endl;
+            failures++;
+        }
+
+        // Sub-block computation, with buffers sizes around the sub-block size
+        for (int buffer_size : { 1, 7, 64, latency + 1, latency + 2, 2 * latency + 1, LENGTH }) {
+            dsp* block = createDSPRecursiver(forward->createDSPInstance(), feedback->createDSPInstance(),
+                                             error, Layout::kTabGroup, "Recursiver", latency);
+            if (impulseResponse(block, buffer_size) != reference) {
+                cerr << "latency " << latency << " buffer size " << buffer_size << " : wrong impulse response" << endl;
+                failures++;
+            }
+        }
+
+        deleteInterpreterDSPFactory(delay);
+        deleteInterpreterDSPFactory(recursive);
+    }
+
+    deleteInterpreterDSPFactory(forward);
+    deleteInterpreterDSPFactory(feedback);
+
+    cout << "dsp_recursiver : " << failures << " failures" << endl;
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "faust/dsp/interpreter-dsp.h"
+#include "faust/gui/MapUI.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+// Checks that instances specialized on their [specialize:1] controls (see setSpecialization) give the same
+// output as the generic ones while the controls change, whatever the time taken by the respecialization.
+// Several instances of the same factory share its specialization thread.
+
+#define BLOCK_SIZE 64
+#define BLOCKS 400
+#define INSTANCES 3
+
+static const string gCode =
+    "bypass = checkbox(\"bypass[specialize:1]\");"
+    "mode = nentry(\"mode[style:menu{'lp':0;'hp':1;'delay':2}][specialize:1]\", 0, 0, 2, 1);"
+    "gain = hslider(\"gain\", 0.5, 0, 1, 0.01);"
+    "fx = _ <: (+ ~ *(0.9)), (- ~ *(0.5)), @(8) : select3(int(mode)) : *(gain);"
+    "process = _ <: fx, _ : select2(bypass);";
+
+// Output of a control change script for each instance, the specialization thread being possibly given time to catch up
+static vector<vector<FAUSTFLOAT>> render(int period, bool wait)
+{
+    string error_msg;
+    interpreter_dsp_factory* factory = createInterpreterDSPFactoryFromString("specialize", gCode, 0, nullptr, error_msg);
+    if (!factory) {
+        cerr << "Cannot create factory : " << error_msg;
+        exit(EXIT_FAILURE);
+    }
+    factory->setSpecialization(period);
+
+    vector<dsp*> dsps;
+    vector<MapUI> uis(INSTANCES);
+    for (int i = 0; i < INSTANCES; i++) {
+        dsps.push_back(factory->createDSPInstance());
+        dsps[i]->buildUserInterface(&uis[i]);
+        dsps[i]->init(44100);
+    }
+
+    vector<vector<FAUSTFLOAT>> res(INSTANCES);
+    FAUSTFLOAT in[BLOCK_SIZE];
+    FAUSTFLOAT out[BLOCK_SIZE];
+    FAUSTFLOAT* inputs[] = { in };
+    FAUSTFLOAT* outputs[] = { out };
+
+    for (int block = 0; block < BLOCKS; block++) {
+        for (int i = 0; i < INSTANCES; i++) {
+            // Each instance has its own control changes
+            if ((block + 7 * i) % 20 == 0) {
+                uis[i].setParamValue("mode", ((block + 7 * i) / 20) % 3);
+                uis[i].setParamValue("bypass", ((block + 7 * i) / 60) % 2);
+            }
+            uis[i].setParamValue("gain", 0.5 + 0.4 * ((block % 7) / 7.));
+            for (int j = 0; j < BLOCK_SIZE; j++) {
+                in[j] = FAUSTFLOAT(((block * BLOCK_SIZE + j) % 100) / 50. - 1.);
+            }
+            dsps[i]->compute(BLOCK_SIZE, inputs, outputs);
+            res[i].insert(res[i].end(), out, out + BLOCK_SIZE);
+        }
+        if (wait && block % 20 == 10) this_thread::sleep_for(chrono::milliseconds(20));
+    }
+
+    for (auto& it : dsps) delete it;
+    deleteInterpreterDSPFactory(factory);
+    return res;
+}
+
+int main(int argc, const char** argv)
+{
+    if (isopt((char**)argv, "-h") || isopt((char**)argv, "-help")) {
+        cout << "interp-specialize-test" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    vector<vector<FAUSTFLOAT>> reference = render(0, false);
+    int failures = 0;
+
+    if (render(1, false) != reference) {
+        cerr << "Wrong output without waiting for the specialization" << endl;
+        failures++;
+    }
+    if (render(1, true) != reference) {
+        cerr << "Wrong output with the specialization" << endl;
+        failures++;
+    }
+
+    cout << "specialization : " << failures << " failures" << endl;
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
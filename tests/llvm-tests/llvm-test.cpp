@@ -25,6 +25,9 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "faust/dsp/llvm-dsp.h"
 #include "faust/dsp/libfaust.h"
@@ -42,6 +45,22 @@ static void printList(const vector<string>& list)
     }
 }
 
+// Return the files of the on-disk machine code cache
+static vector<string> listCacheFiles(const string& cache_dir)
+{
+    vector<string> files;
+    DIR* dir = opendir(cache_dir.c_str());
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir))) {
+            string name = entry->d_name;
+            if (name != "." && name != "..") files.push_back(cache_dir + "/" + name);
+        }
+        closedir(dir);
+    }
+    return files;
+}
+
 struct testUI : public GenericUI {
     
     FAUSTFLOAT fInit;
@@ -158,6 +177,65 @@ int main(int argc, const char** argv)
         deleteDSPFactory(static_cast<llvm_dsp_factory*>(factory));
     }
     
+    cout << "=============================\n";
+    cout << "Test setDSPFactoryCacheDirectory\n";
+    {
+        char cache_dir[] = "/tmp/faust-llvm-cache-XXXXXX";
+        if (!mkdtemp(cache_dir)) {
+            cerr << "Cannot create cache directory" << endl;
+            exit(EXIT_FAILURE);
+        }
+        setDSPFactoryCacheDirectory(cache_dir);
+        
+        // The first factory fills the on-disk cache, the second one is restored from it
+        ino_t cache_file[2] = { 0, 0 };
+        string compile_options[2];
+        vector<string> include_pathnames[2];
+        for (int i = 0; i < 2; i++) {
+            dsp_factory* factory = createDSPFactoryFromString("FaustDSP", "import(\"stdfaust.lib\"); process = *(0.5) : si.smoo;", 0, NULL, "", error_msg, -1);
+            if (!factory) {
+                cerr << "Cannot create factory : " << error_msg;
+                exit(EXIT_FAILURE);
+            }
+            
+            dsp* DSP = factory->createDSPInstance();
+            if (!DSP) {
+                cerr << "Cannot create instance "<< endl;
+                exit(EXIT_FAILURE);
+            }
+            
+            cout << "getSHAKey " << factory->getSHAKey() << endl;
+            compile_options[i] = factory->getCompileOptions();
+            include_pathnames[i] = factory->getIncludePathnames();
+            
+            delete DSP;
+            deleteDSPFactory(static_cast<llvm_dsp_factory*>(factory));
+            
+            // A cache miss writes a new file (renamed over the previous one): the file has to be unchanged after a hit
+            vector<string> files = listCacheFiles(cache_dir);
+            struct stat file_stat;
+            if (files.size() != 1 || stat(files[0].c_str(), &file_stat) != 0) {
+                cerr << "Machine code not stored in the cache" << endl;
+                exit(EXIT_FAILURE);
+            }
+            cache_file[i] = file_stat.st_ino;
+        }
+        
+        if (cache_file[0] != cache_file[1]) {
+            cerr << "Factory not restored from the cache" << endl;
+            exit(EXIT_FAILURE);
+        }
+        if (compile_options[0] != compile_options[1] || include_pathnames[0] != include_pathnames[1]) {
+            cerr << "Compile options or include pathnames not restored from the cache" << endl;
+            exit(EXIT_FAILURE);
+        }
+        cout << "Factory restored from the cache" << endl;
+        
+        setDSPFactoryCacheDirectory("");
+        for (auto& it : listCacheFiles(cache_dir)) remove(it.c_str());
+        rmdir(cache_dir);
+    }
+    
     cout << "=============================\n";
     cout << "Test of UI element encoding\n";
     {
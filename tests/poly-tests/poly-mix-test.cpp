@@ -0,0 +1,132 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "faust/dsp/poly-mix.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+// Checks that the vectorized mixing kernels give bit-for-bit the same result as the scalar ones,
+// or measures them with '-bench'.
+
+#define MAX_FRAMES 4096
+
+static bool sameBits(const FAUSTFLOAT* a, const FAUSTFLOAT* b, int size)
+{
+    return memcmp(a, b, size * sizeof(FAUSTFLOAT)) == 0;
+}
+
+static int checkKernel(const poly_mix::kernels& ref, const poly_mix::kernels& test)
+{
+    mt19937 gen(1234);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    int failures = 0;
+
+    // All sizes around the vector widths, and unaligned buffers
+    vector<int> sizes;
+    for (int size = 0; size < 40; size++) sizes.push_back(size);
+    sizes.push_back(MAX_FRAMES - 1);
+
+    for (int offset = 0; offset < 4; offset++) {
+        for (int size : sizes) {
+            vector<FAUSTFLOAT> mix(MAX_FRAMES + 4), out_ref(MAX_FRAMES + 4), out_test(MAX_FRAMES + 4);
+            for (size_t i = 0; i < mix.size(); i++) {
+                mix[i] = FAUSTFLOAT(dist(gen));
+                out_ref[i] = out_test[i] = FAUSTFLOAT(dist(gen));
+            }
+            // Special values
+            if (size > 3) {
+                mix[offset + size/2] = numeric_limits<FAUSTFLOAT>::quiet_NaN();
+                mix[offset + size/3] = FAUSTFLOAT(-0.0);
+                mix[offset + size - 1] = FAUSTFLOAT(-2.0);
+            }
+            FAUSTFLOAT start_level = FAUSTFLOAT(dist(gen) + 1.0) / 4;
+
+            FAUSTFLOAT level_ref = ref.fMixCheck(size, &mix[offset], &out_ref[offset], start_level);
+            FAUSTFLOAT level_test = test.fMixCheck(size, &mix[offset], &out_test[offset], start_level);
+            if (!sameBits(&level_ref, &level_test, 1) || !sameBits(out_ref.data(), out_test.data(), int(out_ref.size()))) {
+                cerr << test.fName << " : mixCheck differs for size " << size << " offset " << offset << endl;
+                failures++;
+            }
+
+            ref.fMix(size, &mix[offset], &out_ref[offset]);
+            test.fMix(size, &mix[offset], &out_test[offset]);
+            if (!sameBits(out_ref.data(), out_test.data(), int(out_ref.size()))) {
+                cerr << test.fName << " : mix differs for size " << size << " offset " << offset << endl;
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+// Mix 64 stereo voices of 512 frames, as mydsp_poly does
+static void benchKernel(const poly_mix::kernels& kernel)
+{
+    const int voices = 64, channels = 2, frames = 512, cycles = 2000;
+    vector<FAUSTFLOAT> mix(frames, FAUSTFLOAT(0.25)), out(frames, FAUSTFLOAT(0));
+    FAUSTFLOAT level = 0;
+
+    auto start = chrono::high_resolution_clock::now();
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        for (int voice = 0; voice < voices * channels; voice++) {
+            level = kernel.fMixCheck(frames, mix.data(), out.data(), level);
+        }
+    }
+    auto end = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double>(end - start).count();
+    double samples = double(cycles) * voices * channels * frames;
+    cout << kernel.fName << " : " << (samples / duration) / 1e6 << " Msamples/sec (level " << level << ")" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "poly-mix-test [-bench]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    vector<poly_mix::kernels> all = poly_mix::getAllKernels();
+    cout << "sizeof(FAUSTFLOAT) = " << sizeof(FAUSTFLOAT) << ", selected kernel : " << poly_mix::getKernels().fName << endl;
+
+    if (isopt(argv, "-bench")) {
+        for (const auto& kernel : all) benchKernel(kernel);
+        return EXIT_SUCCESS;
+    }
+
+    int failures = 0;
+    for (size_t i = 1; i < all.size(); i++) {
+        int res = checkKernel(all[0], all[i]);
+        cout << all[i].fName << " : " << ((res == 0) ? "OK" : "FAILED") << endl;
+        failures += res;
+    }
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
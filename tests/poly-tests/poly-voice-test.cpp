@@ -0,0 +1,207 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "faust/dsp/poly-dsp.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+// Plays random MIDI events on mydsp_poly and checks that voices are allocated, stolen
+// and released as with the original scan of the voices table (oldest date policy).
+
+#define BUFFER_SIZE 512
+#define SAMPLE_RATE 4000
+
+// A voice that outputs its gate, so that it can be freed as soon as its release time is over
+class gate_dsp : public dsp {
+
+    private:
+
+        FAUSTFLOAT fGate;
+        int fSampleRate;
+
+    public:
+
+        gate_dsp():fGate(0), fSampleRate(SAMPLE_RATE) {}
+
+        int getNumInputs() { return 0; }
+        int getNumOutputs() { return 1; }
+
+        void buildUserInterface(UI* ui_interface)
+        {
+            ui_interface->openVerticalBox("voice");
+            ui_interface->addButton("gate", &fGate);
+            ui_interface->closeBox();
+        }
+
+        int getSampleRate() { return fSampleRate; }
+
+        void init(int sample_rate) { instanceInit(sample_rate); }
+        void instanceInit(int sample_rate)
+        {
+            instanceConstants(sample_rate);
+            instanceResetUserInterface();
+            instanceClear();
+        }
+        void instanceConstants(int sample_rate) { fSampleRate = sample_rate; }
+        void instanceResetUserInterface() { fGate = 0; }
+        void instanceClear() {}
+
+        dsp* clone() { return new gate_dsp(); }
+        void metadata(Meta* m) {}
+
+        void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (int frame = 0; frame < count; frame++) {
+                outputs[0][frame] = fGate * FAUSTFLOAT(0.5);
+            }
+        }
+};
+
+// Reference allocation policy, scanning all voices
+static int refPlayingVoice(mydsp_poly* poly, int pitch)
+{
+    int voice_playing = kNoVoice;
+    int oldest_date_playing = INT_MAX;
+    for (size_t i = 0; i < poly->fVoiceTable.size(); i++) {
+        if (poly->fVoiceTable[i]->fNote == pitch && poly->fVoiceTable[i]->fDate < oldest_date_playing) {
+            oldest_date_playing = poly->fVoiceTable[i]->fDate;
+            voice_playing = int(i);
+        }
+    }
+    return voice_playing;
+}
+
+static int refFreeVoice(mydsp_poly* poly)
+{
+    int voice_release = kNoVoice;
+    int voice_playing = kNoVoice;
+    int oldest_date_release = INT_MAX;
+    int oldest_date_playing = INT_MAX;
+    for (size_t i = 0; i < poly->fVoiceTable.size(); i++) {
+        dsp_voice* voice = poly->fVoiceTable[i];
+        if (voice->fNote == kFreeVoice) {
+            return int(i);
+        } else if (voice->fNote == kReleaseVoice) {
+            if (voice->fDate < oldest_date_release) {
+                oldest_date_release = voice->fDate;
+                voice_release = int(i);
+            }
+        } else if (voice->fDate < oldest_date_playing) {
+            oldest_date_playing = voice->fDate;
+            voice_playing = int(i);
+        }
+    }
+    return (voice_release != kNoVoice) ? voice_release : voice_playing;
+}
+
+static int voiceIndex(mydsp_poly* poly, MapUI* voice)
+{
+    for (size_t i = 0; i < poly->fVoiceTable.size(); i++) {
+        if (poly->fVoiceTable[i] == voice) return int(i);
+    }
+    return kNoVoice;
+}
+
+static int checkEvents(int nvoices, int nevents, int seed)
+{
+    mydsp_poly* poly = new mydsp_poly(new gate_dsp(), nvoices, true, true);
+    poly->init(SAMPLE_RATE);
+
+    FAUSTFLOAT buffer[BUFFER_SIZE];
+    FAUSTFLOAT* outputs[] = { buffer };
+
+    mt19937 gen(seed);
+    uniform_int_distribution<int> event(0, 99);
+    // Few pitches, so that the same pitch is often played by several voices
+    uniform_int_distribution<int> pitch(60, 60 + nvoices);
+    vector<MapUI*> allocated;
+    int failures = 0;
+
+    for (int i = 0; i < nevents; i++) {
+        int type = event(gen);
+        if (type < 40) {
+            int note = pitch(gen);
+            int ref = refFreeVoice(poly);
+            int voice = voiceIndex(poly, poly->keyOn(0, note, 100));
+            if (voice != ref) {
+                cerr << "keyOn " << note << " : voice " << voice << " instead of " << ref << endl;
+                failures++;
+            }
+        } else if (type < 75) {
+            int note = pitch(gen);
+            int ref = refPlayingVoice(poly, note);
+            if (ref == kNoVoice) continue;
+            poly->keyOff(0, note, 100);
+            if (poly->fVoiceTable[ref]->fNote != kReleaseVoice) {
+                cerr << "keyOff " << note << " : voice " << ref << " not released" << endl;
+                failures++;
+            }
+        } else if (type < 95) {
+            poly->compute(BUFFER_SIZE, nullptr, outputs);
+        } else if (type < 97) {
+            int ref = refFreeVoice(poly);
+            MapUI* voice = poly->newVoice();
+            if (voiceIndex(poly, voice) != ref) {
+                cerr << "newVoice : voice " << voiceIndex(poly, voice) << " instead of " << ref << endl;
+                failures++;
+            }
+            allocated.push_back(voice);
+        } else if (type < 98 && allocated.size() > 0) {
+            poly->deleteVoice(allocated.back());
+            allocated.pop_back();
+        } else if (type < 99) {
+            poly->allNotesOff(event(gen) < 50);
+        } else {
+            poly->ctrlChange(0, midi::ALL_NOTES_OFF, 0);
+        }
+    }
+
+    delete poly;
+    return failures;
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "poly-voice-test [-events <num>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int nevents = lopt(argv, "-events", 100000);
+    int failures = 0;
+    for (int nvoices : { 1, 2, 8, 63, 64, 65, 200 }) {
+        int res = checkEvents(nvoices, nevents, nvoices);
+        cout << nvoices << " voices : " << ((res == 0) ? "OK" : "FAILED") << endl;
+        failures += res;
+    }
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,260 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "faust/gui/spsc-queue.h"
+#include "faust/gui/ring-buffer.h"
+#include "faust/gui/GUI.h"
+#include "faust/dsp/timed-dsp.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+std::list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+// Checks spsc_queue with a producer and a consumer thread, and its use by timed_dsp,
+// or measures its throughput compared to ringbuffer_t with '-bench'.
+
+struct item {
+    uint64_t fSeq;
+    uint64_t fCheck;
+};
+
+// The producer and the consumer randomly use single and batch operations on a small queue, so that it is often full or empty
+static int stressTest(size_t capacity, uint64_t count)
+{
+    spsc_queue<item> queue(capacity);
+    int failures = 0;
+
+    thread producer([&]() {
+        uint64_t seq = 0;
+        uint64_t rand = 1;
+        item items[16];
+        while (seq < count) {
+            rand = rand * 6364136223846793005ULL + 1442695040888963407ULL;
+            size_t pushed = 0;
+            if (rand & (1ULL << 40)) {
+                pushed = queue.push({ seq, ~seq }) ? 1 : 0;
+            } else {
+                size_t size = std::min<uint64_t>((rand >> 50) % 16 + 1, count - seq);
+                for (size_t i = 0; i < size; i++) items[i] = { seq + i, ~(seq + i) };
+                pushed = queue.push(items, size);
+            }
+            // Let the consumer run when the queue is full (needed on a single core machine)
+            if (pushed == 0) this_thread::yield();
+            seq += pushed;
+        }
+    });
+
+    uint64_t seq = 0;
+    uint64_t rand = 7;
+    item items[16];
+    while (seq < count) {
+        rand = rand * 6364136223846793005ULL + 1442695040888963407ULL;
+        int mode = (rand >> 40) % 3;
+        size_t size = 0;
+        if (mode == 0) {
+            size = queue.pop(items[0]) ? 1 : 0;
+        } else if (mode == 1) {
+            item* first = queue.front();
+            if (first) {
+                items[0] = *first;
+                queue.pop();
+                size = 1;
+            }
+        } else {
+            size = queue.pop(items, (rand >> 50) % 16 + 1);
+        }
+        if (size == 0) this_thread::yield();
+        for (size_t i = 0; i < size; i++, seq++) {
+            if (items[i].fSeq != seq || items[i].fCheck != ~seq) {
+                if (failures++ < 10) cerr << "capacity " << capacity << " : item " << items[i].fSeq << " instead of " << seq << endl;
+            }
+        }
+    }
+
+    producer.join();
+    if (queue.front()) {
+        cerr << "capacity " << capacity << " : queue not empty" << endl;
+        failures++;
+    }
+    return failures;
+}
+
+// A DSP which outputs its control value
+class control_dsp : public dsp {
+
+    private:
+
+        FAUSTFLOAT fControl;
+
+    public:
+
+        control_dsp():fControl(0) {}
+
+        int getNumInputs() { return 0; }
+        int getNumOutputs() { return 1; }
+        void buildUserInterface(UI* ui_interface) { ui_interface->addHorizontalSlider("control", &fControl, 0, 0, 100, 1); }
+        int getSampleRate() { return 44100; }
+        void init(int sample_rate) {}
+        void instanceInit(int sample_rate) {}
+        void instanceConstants(int sample_rate) {}
+        void instanceResetUserInterface() {}
+        void instanceClear() {}
+        dsp* clone() { return new control_dsp(); }
+        void metadata(Meta* m) {}
+        void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (int frame = 0; frame < count; frame++) outputs[0][frame] = fControl;
+        }
+};
+
+struct timed_item : public uiTimedItem {
+    timed_item(GUI* ui, FAUSTFLOAT* zone):uiTimedItem(ui, zone) {}
+    void reflectZone() {}
+};
+
+struct zone_getter : public GenericUI {
+    FAUSTFLOAT* fZone = nullptr;
+    void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT fmin, FAUSTFLOAT fmax, FAUSTFLOAT step)
+    {
+        fZone = zone;
+    }
+};
+
+// Dated controls (in frames) have to be applied at the exact frame
+static int timedTest()
+{
+    GUI gui;
+    timed_dsp timed(new control_dsp());
+    zone_getter getter;
+    timed.buildUserInterface(&getter);
+    timed_item* item = new timed_item(&gui, getter.fZone);
+    // timed_dsp only keeps zones that are in GUI::gTimedZoneMap
+    timed.buildUserInterface(&gui);
+
+    const int frames = 256;
+    FAUSTFLOAT output[frames];
+    FAUSTFLOAT* outputs[] = { output };
+    for (int date = 0; date < frames; date += 17) {
+        item->modifyZone(double(date), FAUSTFLOAT(date));
+    }
+    timed.compute(-1, frames, nullptr, outputs);
+
+    int failures = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        if (output[frame] != FAUSTFLOAT((frame / 17) * 17)) {
+            if (failures++ < 10) cerr << "timed_dsp : frame " << frame << " value " << output[frame] << endl;
+        }
+    }
+    return failures;
+}
+
+static void benchQueue(uint64_t count)
+{
+    spsc_queue<DatedControl> queue(512);
+    auto start = chrono::high_resolution_clock::now();
+    thread producer([&]() {
+        for (uint64_t i = 0; i < count;) {
+            if (queue.push(DatedControl(double(i), FAUSTFLOAT(1)))) {
+                i++;
+            } else {
+                this_thread::yield();
+            }
+        }
+    });
+    DatedControl items[64];
+    double sum = 0;
+    for (uint64_t i = 0; i < count;) {
+        size_t size = queue.pop(items, 64);
+        if (size == 0) this_thread::yield();
+        for (size_t j = 0; j < size; j++) sum += items[j].fDate;
+        i += size;
+    }
+    producer.join();
+    double duration = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cout << "spsc_queue : " << (count / duration) / 1e6 << " Mitems/sec (" << sum << ")" << endl;
+}
+
+static void benchRingBuffer(uint64_t count)
+{
+    ringbuffer_t* queue = ringbuffer_create(8192);
+    auto start = chrono::high_resolution_clock::now();
+    thread producer([&]() {
+        for (uint64_t i = 0; i < count;) {
+            DatedControl item(double(i), FAUSTFLOAT(1));
+            if (ringbuffer_write(queue, (const char*)&item, sizeof(DatedControl)) == sizeof(DatedControl)) {
+                i++;
+            } else {
+                this_thread::yield();
+            }
+        }
+    });
+    DatedControl item;
+    double sum = 0;
+    for (uint64_t i = 0; i < count;) {
+        if (ringbuffer_read(queue, (char*)&item, sizeof(DatedControl)) == sizeof(DatedControl)) {
+            sum += item.fDate;
+            i++;
+        } else {
+            this_thread::yield();
+        }
+    }
+    producer.join();
+    double duration = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cout << "ringbuffer_t : " << (count / duration) / 1e6 << " Mitems/sec (" << sum << ")" << endl;
+    ringbuffer_free(queue);
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "spsc-queue-test [-bench] [-count <num>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (isopt(argv, "-bench")) {
+        uint64_t count = lopt(argv, "-count", 20000000);
+        benchRingBuffer(count);
+        benchQueue(count);
+        return EXIT_SUCCESS;
+    }
+
+    uint64_t count = lopt(argv, "-count", 2000000);
+    int failures = 0;
+    for (size_t capacity : { 1, 2, 7, 64, 512 }) {
+        int res = stressTest(capacity, count);
+        cout << "capacity " << capacity << " : " << ((res == 0) ? "OK" : "FAILED") << endl;
+        failures += res;
+    }
+    int res = timedTest();
+    cout << "timed_dsp : " << ((res == 0) ? "OK" : "FAILED") << endl;
+    failures += res;
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
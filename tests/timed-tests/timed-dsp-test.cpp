@@ -0,0 +1,271 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "faust/gui/GUI.h"
+#include "faust/dsp/timed-dsp.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+std::list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+// Checks that timed_dsp applies dated controls of many zones at the same frames as the previous
+// algorithm (scanning all zones to find each slice), or compares their speed with '-bench'.
+
+#define BUFFER_SIZE 256
+
+// A DSP with 'zones' controls, each output channel is the value of a control
+class controls_dsp : public dsp {
+
+    private:
+
+        vector<FAUSTFLOAT> fControls;
+
+    public:
+
+        controls_dsp(int zones):fControls(zones, FAUSTFLOAT(0)) {}
+
+        int getNumInputs() { return 0; }
+        int getNumOutputs() { return int(fControls.size()); }
+        void buildUserInterface(UI* ui_interface)
+        {
+            for (size_t i = 0; i < fControls.size(); i++) {
+                ui_interface->addHorizontalSlider("control", &fControls[i], 0, 0, 1000, 1);
+            }
+        }
+        int getSampleRate() { return 44100; }
+        void init(int sample_rate) {}
+        void instanceInit(int sample_rate) {}
+        void instanceConstants(int sample_rate) {}
+        void instanceResetUserInterface() {}
+        void instanceClear() {}
+        dsp* clone() { return new controls_dsp(int(fControls.size())); }
+        void metadata(Meta* m) {}
+        void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (size_t i = 0; i < fControls.size(); i++) {
+                for (int frame = 0; frame < count; frame++) outputs[i][frame] = fControls[i];
+            }
+        }
+};
+
+// Previous algorithm: the next slice is found by looking at the first control of all zones
+class scan_timed_dsp : public timed_dsp {
+
+    protected:
+
+        ztimedmap::iterator getNextControl(DatedControl& res)
+        {
+            DatedControl date1(DBL_MAX, 0);
+            ztimedmap::iterator it2 = GUI::gTimedZoneMap.end();
+            for (auto& it : fZoneUI.fZoneSet) {
+                ztimedmap::iterator it1 = GUI::gTimedZoneMap.find(it);
+                if (it1 != GUI::gTimedZoneMap.end()) {
+                    DatedControl* date2 = (*it1).second->fControls.front();
+                    if (date2 && date2->fDate < date1.fDate) {
+                        it2 = it1;
+                        date1 = *date2;
+                    }
+                }
+            }
+            res = date1;
+            return it2;
+        }
+
+        void computeAux(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs, bool convert_ts)
+        {
+            int slice, offset = 0;
+            ztimedmap::iterator it;
+            DatedControl next_control;
+            while ((it = getNextControl(next_control)) != GUI::gTimedZoneMap.end()) {
+                slice = int(next_control.fDate) - offset;
+                computeSlice(offset, slice, inputs, outputs);
+                offset += slice;
+                *((*it).first) = next_control.fValue;
+                (*it).second->fControls.pop();
+            }
+            slice = count - offset;
+            computeSlice(offset, slice, inputs, outputs);
+        }
+
+    public:
+
+        scan_timed_dsp(dsp* dsp):timed_dsp(dsp) {}
+
+};
+
+struct timed_item : public uiTimedItem {
+    timed_item(GUI* ui, FAUSTFLOAT* zone):uiTimedItem(ui, zone) {}
+    void reflectZone() {}
+};
+
+// Creates a timed item on each zone of the DSP
+struct timed_items_builder : public GenericUI {
+
+    GUI* fGUI;
+    vector<timed_item*> fItems;
+
+    timed_items_builder(GUI* gui):fGUI(gui) {}
+
+    void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT fmin, FAUSTFLOAT fmax, FAUSTFLOAT step)
+    {
+        fItems.push_back(new timed_item(fGUI, zone));
+    }
+};
+
+/*
+ Render 'cycles' buffers, sending 'controls' dated controls in random zones before each buffer.
+ Returns the duration of the compute calls in sec, and all output channels in 'res'.
+ */
+static double render(timed_dsp* DSP, int zones, int cycles, int controls, vector<FAUSTFLOAT>& res)
+{
+    GUI gui;
+    timed_items_builder builder(&gui);
+    DSP->buildUserInterface(&builder);
+    // timed_dsp only keeps zones that are in GUI::gTimedZoneMap
+    DSP->buildUserInterface(&gui);
+
+    vector<vector<FAUSTFLOAT>> outputs(zones, vector<FAUSTFLOAT>(BUFFER_SIZE));
+    vector<FAUSTFLOAT*> outputs_ptr;
+    for (auto& it : outputs) outputs_ptr.push_back(it.data());
+
+    mt19937 gen(1234);
+    uniform_int_distribution<int> zone_dist(0, zones - 1);
+    uniform_int_distribution<int> date_dist(0, BUFFER_SIZE - 1);
+
+    res.clear();
+    double duration = 0.;
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        // Dates have to be increasing in each zone
+        vector<int> last_date(zones, 0);
+        for (int control = 0; control < controls; control++) {
+            int zone = zone_dist(gen);
+            int date = max<int>(last_date[zone], date_dist(gen));
+            last_date[zone] = date;
+            builder.fItems[zone]->modifyZone(double(date), FAUSTFLOAT(cycle * controls + control));
+        }
+        auto start = chrono::high_resolution_clock::now();
+        DSP->compute(-1, BUFFER_SIZE, nullptr, outputs_ptr.data());
+        auto end = chrono::high_resolution_clock::now();
+        duration += chrono::duration<double>(end - start).count();
+        if (cycles <= 100) {
+            for (auto& it : outputs) res.insert(res.end(), it.begin(), it.end());
+        }
+    }
+
+    delete DSP;
+    return duration;
+}
+
+/*
+ A control thread sends controls while the zones are bound again and again by 'buildUserInterface',
+ then all zones must have their last value. Returns false otherwise.
+ */
+static bool concurrentBinding(int zones, int cycles)
+{
+    controls_dsp* controls = new controls_dsp(zones);
+    timed_dsp* DSP = new timed_dsp(controls);
+    GUI* gui = new GUI();
+    timed_items_builder builder(gui);
+    DSP->buildUserInterface(&builder);
+    DSP->buildUserInterface(gui);
+
+    vector<vector<FAUSTFLOAT>> outputs(zones, vector<FAUSTFLOAT>(BUFFER_SIZE));
+    vector<FAUSTFLOAT*> outputs_ptr;
+    for (auto& it : outputs) outputs_ptr.push_back(it.data());
+
+    // The control thread waits for each buffer, so that the queues are never full
+    atomic<int> computed(0);
+    thread control_thread([&]() {
+        for (int cycle = 0; cycle < cycles; cycle++) {
+            for (int zone = 0; zone < zones; zone++) {
+                builder.fItems[zone]->modifyZone(0., FAUSTFLOAT(cycle));
+            }
+            while (computed.load() <= cycle) this_thread::yield();
+        }
+    });
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        DSP->buildUserInterface(gui);
+        DSP->compute(-1, BUFFER_SIZE, nullptr, outputs_ptr.data());
+        computed++;
+    }
+    control_thread.join();
+    DSP->compute(-1, BUFFER_SIZE, nullptr, outputs_ptr.data());
+
+    bool res = true;
+    for (int zone = 0; zone < zones; zone++) {
+        res &= (outputs[zone][BUFFER_SIZE - 1] == FAUSTFLOAT(cycles - 1));
+    }
+    delete DSP;
+    delete gui;
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "timed-dsp-test [-bench] [-zones <num>] [-controls <num>] [-cycles <num>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (isopt(argv, "-bench")) {
+        int zones = lopt(argv, "-zones", 300);
+        int controls = lopt(argv, "-controls", 16);
+        int cycles = lopt(argv, "-cycles", 10000);
+        vector<FAUSTFLOAT> res;
+        double scan = render(new scan_timed_dsp(new controls_dsp(zones)), zones, cycles, controls, res);
+        double merge = render(new timed_dsp(new controls_dsp(zones)), zones, cycles, controls, res);
+        cout << zones << " zones, " << controls << " controls per buffer" << endl;
+        cout << "scan all zones : " << scan << " sec" << endl;
+        cout << "merge updated zones : " << merge << " sec (speedup " << scan/merge << ")" << endl;
+        return EXIT_SUCCESS;
+    }
+
+    int failures = 0;
+    for (int zones : { 1, 3, 64, 65, 300 }) {
+        for (int controls : { 0, 1, 10, 200 }) {
+            vector<FAUSTFLOAT> reference, res;
+            render(new scan_timed_dsp(new controls_dsp(zones)), zones, 50, controls, reference);
+            render(new timed_dsp(new controls_dsp(zones)), zones, 50, controls, res);
+            if (res != reference) {
+                cerr << zones << " zones, " << controls << " controls : wrong rendering" << endl;
+                failures++;
+            }
+        }
+    }
+    if (!concurrentBinding(65, 2000)) {
+        cerr << "concurrent binding : controls lost" << endl;
+        failures++;
+    }
+    cout << "timed_dsp : " << failures << " failures" << endl;
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
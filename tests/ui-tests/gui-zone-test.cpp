@@ -0,0 +1,178 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "faust/gui/GUI.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+std::list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+// Checks which items are reflected when refreshing GUIs sharing zones, or compares
+// the refresh time with the previous map of lists scanning with '-bench'.
+
+// Item counting its reflectZone calls
+struct counting_item : public uiItem {
+
+    int fReflected;
+
+    counting_item(GUI* ui, FAUSTFLOAT* zone):uiItem(ui, zone), fReflected(0) {}
+
+    void reflectZone()
+    {
+        fCache = *fZone;
+        fReflected++;
+    }
+};
+
+static int gFailures = 0;
+
+static void check(bool test, const char* message)
+{
+    if (!test) {
+        cerr << message << endl;
+        gFailures++;
+    }
+}
+
+static void checkRefresh()
+{
+    const int zones = 100;
+    vector<FAUSTFLOAT> values(zones, FAUSTFLOAT(0));
+    GUI* gui1 = new GUI();
+    GUI* gui2 = new GUI();
+    vector<counting_item*> items1, items2, items3;
+    for (int i = 0; i < zones; i++) {
+        items1.push_back(new counting_item(gui1, &values[i]));
+        items2.push_back(new counting_item(gui2, &values[i]));
+        items3.push_back(new counting_item(gui2, &values[i]));
+    }
+
+    // New items are reflected once
+    GUI::updateAllGuis();
+    GUI::updateAllGuis();
+    for (int i = 0; i < zones; i++) {
+        check(items1[i]->fReflected == 1 && items2[i]->fReflected == 1 && items3[i]->fReflected == 1, "new items not reflected once");
+    }
+
+    // modifyZone reflects the other items of the same GUI immediately, and the other GUIs at refresh
+    items2[10]->modifyZone(FAUSTFLOAT(1));
+    check(items2[10]->fReflected == 1 && items3[10]->fReflected == 2 && items1[10]->fReflected == 1, "wrong modifyZone reflection");
+    GUI::updateAllGuis();
+    check(items2[10]->fReflected == 1 && items3[10]->fReflected == 2 && items1[10]->fReflected == 2, "wrong modifyZone refresh");
+
+    // Zones directly written (like bargraphs by the DSP) are reflected at refresh
+    values[20] = FAUSTFLOAT(2);
+    GUI::updateAllGuis();
+    check(items1[20]->fReflected == 2 && items2[20]->fReflected == 2 && items3[20]->fReflected == 2, "direct write not reflected");
+
+    // An item added on an already registered zone is reflected
+    counting_item* item4 = new counting_item(gui1, &values[30]);
+    GUI::updateAllGuis();
+    check(item4->fReflected == 1 && items1[30]->fReflected == 1, "item added later not reflected");
+
+    // Unchanged zones are not reflected
+    for (int i = 0; i < zones; i++) {
+        if (i == 10 || i == 20) continue;
+        check(items1[i]->fReflected == 1 && items2[i]->fReflected == 1 && items3[i]->fReflected == 1, "unchanged zone reflected");
+    }
+
+    delete gui1;
+    delete gui2;
+}
+
+// Previous refresh: every item of every zone, through a map of lists
+struct legacy_refresh {
+
+    std::map<FAUSTFLOAT*, std::list<uiItemBase*>> fZoneMap;
+
+    void updateAllZones()
+    {
+        for (auto& m : fZoneMap) {
+            FAUSTFLOAT v = *m.first;
+            for (auto& c : m.second) {
+                if (c->cache() != v) c->reflectZone();
+            }
+        }
+    }
+};
+
+static void bench(int zones, int changes, int cycles)
+{
+    vector<FAUSTFLOAT> values(zones, FAUSTFLOAT(0));
+    GUI* gui1 = new GUI();
+    GUI* gui2 = new GUI();
+    legacy_refresh legacy1, legacy2;
+    for (int i = 0; i < zones; i++) {
+        legacy1.fZoneMap[&values[i]].push_back(new counting_item(gui1, &values[i]));
+        legacy2.fZoneMap[&values[i]].push_back(new counting_item(gui2, &values[i]));
+    }
+    GUI::updateAllGuis();
+
+    auto start = chrono::high_resolution_clock::now();
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        for (int i = 0; i < changes; i++) values[(cycle * 7919 + i * 104729) % zones] += FAUSTFLOAT(1);
+        legacy1.updateAllZones();
+        legacy2.updateAllZones();
+    }
+    double legacy = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+    start = chrono::high_resolution_clock::now();
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        for (int i = 0; i < changes; i++) values[(cycle * 7919 + i * 104729) % zones] += FAUSTFLOAT(1);
+        GUI::updateAllGuis();
+    }
+    double flat = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+    cout << zones << " zones, " << changes << " changes per refresh, 2 GUIs" << endl;
+    cout << "map of lists : " << (legacy / cycles) * 1e6 << " usec per refresh" << endl;
+    cout << "flat arrays  : " << (flat / cycles) * 1e6 << " usec per refresh (speedup " << legacy/flat << ")" << endl;
+
+    delete gui1;
+    delete gui2;
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "gui-zone-test [-bench] [-zones <num>] [-changes <num>] [-cycles <num>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (isopt(argv, "-bench")) {
+        bench(lopt(argv, "-zones", 1000), lopt(argv, "-changes", 8), lopt(argv, "-cycles", 20000));
+        return EXIT_SUCCESS;
+    }
+
+    checkRefresh();
+    cout << "GUI refresh : " << gFailures << " failures" << endl;
+    return (gFailures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
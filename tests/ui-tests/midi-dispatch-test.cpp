@@ -0,0 +1,300 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/MidiUI.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+std::list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+// Checks that MIDI messages received by MidiUI modify the zones of the items mapped on their type, number and channel,
+// or measures the dispatch throughput by replaying a MIDI file (or a generated dense MIDI stream) with '-bench'.
+
+enum { kCtrl = 0, kKeyOn, kKeyOff, kKey, kKeyPress, kPgm, kChanPress, kTypes };
+static const char* gTypes[] = { "ctrl", "keyon", "keyoff", "key", "keypress", "pgm", "chanpress" };
+
+struct mapping {
+    int fType;
+    int fNum;
+    int fChan;     // [1..16], or 0 for all channels
+    FAUSTFLOAT fMin, fMax;
+};
+
+struct message {
+    int fType;
+    int fChan;     // [0..15]
+    int fNum;
+    int fValue;
+};
+
+// A DSP with a control for each mapping, declared with the corresponding 'midi' metadata
+class midi_dsp : public dsp {
+
+    private:
+
+        vector<mapping> fMappings;
+        vector<FAUSTFLOAT> fControls;
+
+    public:
+
+        midi_dsp(const vector<mapping>& mappings):fMappings(mappings), fControls(mappings.size(), FAUSTFLOAT(0)) {}
+
+        int getNumInputs() { return 0; }
+        int getNumOutputs() { return 0; }
+        void buildUserInterface(UI* ui_interface)
+        {
+            ui_interface->openVerticalBox("midi");
+            for (size_t i = 0; i < fMappings.size(); i++) {
+                const mapping& map = fMappings[i];
+                stringstream meta;
+                meta << gTypes[map.fType];
+                if (map.fType == kPgm || map.fType == kChanPress) {
+                    if (map.fChan > 0) meta << " " << map.fChan;
+                } else {
+                    meta << " " << map.fNum;
+                    if (map.fChan > 0) meta << " " << map.fChan;
+                }
+                ui_interface->declare(&fControls[i], "midi", meta.str().c_str());
+                ui_interface->addHorizontalSlider("control", &fControls[i], 0, map.fMin, map.fMax, 0.01);
+            }
+            ui_interface->closeBox();
+        }
+        int getSampleRate() { return 44100; }
+        void init(int sample_rate) {}
+        void instanceInit(int sample_rate) {}
+        void instanceConstants(int sample_rate) {}
+        void instanceResetUserInterface() {}
+        void instanceClear() {}
+        dsp* clone() { return new midi_dsp(fMappings); }
+        void metadata(Meta* m) {}
+        void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) {}
+
+        FAUSTFLOAT getControl(int i) { return fControls[i]; }
+};
+
+static void send(MidiUI& midi_ui, const message& msg)
+{
+    switch (msg.fType) {
+        case kCtrl: midi_ui.ctrlChange(0., msg.fChan, msg.fNum, msg.fValue); break;
+        case kKeyOn: midi_ui.keyOn(0., msg.fChan, msg.fNum, msg.fValue); break;
+        case kKeyOff: midi_ui.keyOff(0., msg.fChan, msg.fNum, msg.fValue); break;
+        case kKeyPress: midi_ui.keyPress(0., msg.fChan, msg.fNum, msg.fValue); break;
+        case kPgm: midi_ui.progChange(0., msg.fChan, msg.fValue); break;
+        case kChanPress: midi_ui.chanPress(0., msg.fChan, msg.fValue); break;
+    }
+}
+
+// Value given to a mapping by a message, or false if the mapping does not receive the message
+static bool receive(const mapping& map, const message& msg, FAUSTFLOAT& value)
+{
+    if (map.fChan != 0 && map.fChan - 1 != msg.fChan) return false;
+    int type = msg.fType;
+    int num = msg.fNum;
+    int val = msg.fValue;
+    if (map.fType == kKey && (type == kKeyOn || type == kKeyOff)) {
+        // 'key' items receive keyOn, and keyOff with a 0 velocity
+        if (type == kKeyOff) val = 0;
+        type = kKey;
+    }
+    if (map.fType != type) return false;
+    if (type != kPgm && type != kChanPress && map.fNum != num) return false;
+    if (type == kPgm) {
+        // Program numbers are directly used, when in the control range
+        value = FAUSTFLOAT(val);
+        return (map.fMin <= value && value <= map.fMax);
+    }
+    value = FAUSTFLOAT(LinearValueConverter(0., 127., map.fMin, map.fMax).ui2faust(val));
+    return true;
+}
+
+static int checkDispatch()
+{
+    mt19937 gen(1234);
+    vector<mapping> mappings;
+    for (int i = 0; i < 400; i++) {
+        mapping map;
+        map.fType = gen() % kTypes;
+        map.fNum = gen() % 16;
+        map.fChan = gen() % 18;     // 17 is out of range
+        map.fMin = FAUSTFLOAT(gen() % 10);
+        map.fMax = map.fMin + FAUSTFLOAT(1 + gen() % 100);
+        mappings.push_back(map);
+    }
+
+    midi_handler handler;
+    midi_dsp DSP(mappings);
+    MidiUI* midi_ui = new MidiUI(&handler);
+    DSP.buildUserInterface(midi_ui);
+
+    vector<FAUSTFLOAT> expected(mappings.size(), FAUSTFLOAT(0));
+    int failures = 0;
+    for (int i = 0; i < 20000; i++) {
+        message msg;
+        msg.fType = gen() % kTypes;
+        if (msg.fType == kKey) msg.fType = kKeyOn;
+        msg.fChan = gen() % 16;
+        msg.fNum = gen() % 20;
+        msg.fValue = gen() % 128;
+        send(*midi_ui, msg);
+        for (size_t j = 0; j < mappings.size(); j++) {
+            FAUSTFLOAT value;
+            if (receive(mappings[j], msg, value)) expected[j] = value;
+        }
+        for (size_t j = 0; j < mappings.size(); j++) {
+            if (DSP.getControl(int(j)) != expected[j]) {
+                if (failures++ < 10) cerr << "message " << i << " : wrong value for control " << j << " (" << gTypes[mappings[j].fType] << ")" << endl;
+            }
+        }
+    }
+
+    delete midi_ui;
+    return failures;
+}
+
+// Minimal Standard MIDI File reader: channel messages of all tracks, one track after the other
+static bool readMidiFile(const char* filename, vector<message>& messages)
+{
+    ifstream file(filename, ios::binary);
+    vector<unsigned char> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    size_t pos = 0;
+    auto read32 = [&]() { uint32_t v = 0; for (int i = 0; i < 4 && pos < data.size(); i++) v = (v << 8) | data[pos++]; return v; };
+    auto readVar = [&]() { uint32_t v = 0; unsigned char c; do { c = (pos < data.size()) ? data[pos++] : 0; v = (v << 7) | (c & 0x7F); } while (c & 0x80); return v; };
+
+    if (data.size() < 14 || memcmp(data.data(), "MThd", 4) != 0) return false;
+    while (pos + 8 <= data.size()) {
+        bool track = memcmp(&data[pos], "MTrk", 4) == 0;
+        pos += 4;
+        uint32_t size = read32();
+        size_t end = std::min<size_t>(data.size(), pos + size);
+        if (!track) { pos = end; continue; }
+        unsigned char status = 0;
+        while (pos < end) {
+            readVar();
+            if (pos >= end) break;
+            if (data[pos] & 0x80) status = data[pos++];
+            if (status == 0xFF) {
+                pos++;
+                pos += readVar();
+            } else if (status == 0xF0 || status == 0xF7) {
+                pos += readVar();
+            } else {
+                message msg = { -1, status & 0x0F, 0, 0 };
+                int data1 = (pos < end) ? data[pos++] : 0;
+                int data2 = ((status & 0xF0) != 0xC0 && (status & 0xF0) != 0xD0 && pos < end) ? data[pos++] : 0;
+                switch (status & 0xF0) {
+                    case 0x80: msg = { kKeyOff, status & 0x0F, data1, data2 }; break;
+                    case 0x90: msg = { (data2 == 0) ? kKeyOff : kKeyOn, status & 0x0F, data1, data2 }; break;
+                    case 0xA0: msg = { kKeyPress, status & 0x0F, data1, data2 }; break;
+                    case 0xB0: msg = { kCtrl, status & 0x0F, data1, data2 }; break;
+                    case 0xC0: msg = { kPgm, status & 0x0F, 0, data1 }; break;
+                    case 0xD0: msg = { kChanPress, status & 0x0F, 0, data1 }; break;
+                }
+                if (msg.fType >= 0) messages.push_back(msg);
+            }
+        }
+        pos = end;
+    }
+    return true;
+}
+
+// Dense stream: notes and controllers on all channels
+static void generateMessages(int count, vector<message>& messages)
+{
+    mt19937 gen(5678);
+    for (int i = 0; i < count; i++) {
+        int chan = gen() % 16;
+        int note = 36 + gen() % 60;
+        switch (gen() % 4) {
+            case 0: messages.push_back({ kKeyOn, chan, note, 1 + int(gen() % 127) }); break;
+            case 1: messages.push_back({ kKeyOff, chan, note, 0 }); break;
+            default: messages.push_back({ kCtrl, chan, int(gen() % 128), int(gen() % 128) }); break;
+        }
+    }
+}
+
+static void bench(const vector<message>& messages, int loops)
+{
+    // A synth like mapping: a control for each ctrl number (on all channels and on channel 1),
+    // a 'key' control for each note, and a few global controls
+    vector<mapping> mappings;
+    for (int num = 0; num < 128; num++) {
+        mappings.push_back({ kCtrl, num, 0, 0, 1 });
+        mappings.push_back({ kCtrl, num, 1, 0, 1 });
+        mappings.push_back({ kKey, num, 0, 0, 1 });
+    }
+    mappings.push_back({ kPgm, 0, 0, 0, 127 });
+    mappings.push_back({ kChanPress, 0, 0, 0, 1 });
+
+    midi_handler handler;
+    midi_dsp DSP(mappings);
+    MidiUI* midi_ui = new MidiUI(&handler);
+    DSP.buildUserInterface(midi_ui);
+
+    auto start = chrono::high_resolution_clock::now();
+    for (int loop = 0; loop < loops; loop++) {
+        for (auto& it : messages) send(*midi_ui, it);
+    }
+    double duration = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cout << messages.size() << " messages, " << mappings.size() << " MIDI controls" << endl;
+    cout << "MidiUI dispatch : " << (double(messages.size()) * loops / duration) / 1e6 << " Mmessages/sec" << endl;
+    delete midi_ui;
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "midi-dispatch-test [-bench] [-file foo.mid] [-messages <num>] [-loops <num>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (isopt(argv, "-bench")) {
+        vector<message> messages;
+        const char* filename = lopts(argv, "-file", nullptr);
+        if (filename) {
+            if (!readMidiFile(filename, messages)) {
+                cerr << "Cannot read MIDI file " << filename << endl;
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            generateMessages(lopt(argv, "-messages", 100000), messages);
+        }
+        bench(messages, lopt(argv, "-loops", 100));
+        return EXIT_SUCCESS;
+    }
+
+    int failures = checkDispatch();
+    cout << "MidiUI dispatch : " << failures << " failures" << endl;
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,166 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <math.h>
+#include <iostream>
+#include <thread>
+
+#include "faust/gui/ParallelReader.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+// Checks that ParallelReader loads the same soundfile as its sequential reader,
+// or measures the load time of many parts with '-bench'.
+
+// A reader of synthetic sound resources named "<channels>:<length>", with a computation and a latency (like a disk access) per part
+struct synth_reader : public SoundfileReader {
+
+    int fLatency;   // in ms
+
+    synth_reader():fLatency(0) {}
+
+    static void parse(const string& path_name, int& channels, int& length)
+    {
+        channels = stoi(path_name.substr(0, path_name.find(':')));
+        length = stoi(path_name.substr(path_name.find(':') + 1));
+    }
+
+    bool checkFile(const string& path_name) { return path_name.find(':') != string::npos; }
+
+    void getParamsFile(const string& path_name, int& channels, int& length)
+    {
+        parse(path_name, channels, length);
+    }
+
+    void readFile(Soundfile* soundfile, const string& path_name, int part, int& offset, int max_chan)
+    {
+        int channels, length;
+        parse(path_name, channels, length);
+        if (length == 666) throw -1;
+        if (fLatency > 0) this_thread::sleep_for(chrono::milliseconds(fLatency));
+        soundfile->fLength[part] = length;
+        soundfile->fSR[part] = 44100 + part;
+        soundfile->fOffset[part] = offset;
+        for (int chan = 0; chan < min<int>(channels, max_chan); chan++) {
+            for (int sample = 0; sample < length; sample++) {
+                soundfile->fBuffers[chan][offset + sample] = FAUSTFLOAT(sin(0.001 * (part + 1) * sample + chan));
+            }
+        }
+        offset += length;
+    }
+
+};
+
+static int failures = 0;
+
+static void check(bool res, const string& msg)
+{
+    if (!res) {
+        cerr << "ERROR : " << msg << endl;
+        failures++;
+    }
+}
+
+static vector<string> makeParts(int parts, int length)
+{
+    vector<string> path_name_list;
+    for (int part = 0; part < parts; part++) {
+        // Various channels and lengths, and some missing files
+        path_name_list.push_back((part % 7 == 3) ? "__empty_sound__" : to_string(1 + part % 3) + ":" + to_string(length + part * 13));
+    }
+    return path_name_list;
+}
+
+static bool sameSoundfile(Soundfile* sf1, Soundfile* sf2, int max_chan)
+{
+    if (sf1->fChannels != sf2->fChannels) return false;
+    int length = sf1->fOffset[MAX_SOUNDFILE_PARTS - 1] + sf1->fLength[MAX_SOUNDFILE_PARTS - 1];
+    for (int part = 0; part < MAX_SOUNDFILE_PARTS; part++) {
+        if (sf1->fLength[part] != sf2->fLength[part] || sf1->fSR[part] != sf2->fSR[part] || sf1->fOffset[part] != sf2->fOffset[part]) return false;
+    }
+    for (int chan = 0; chan < max_chan; chan++) {
+        for (int sample = 0; sample < length; sample++) {
+            if (sf1->fBuffers[chan][sample] != sf2->fBuffers[chan][sample]) return false;
+        }
+    }
+    return true;
+}
+
+static void loadTest()
+{
+    synth_reader reader;
+    for (int parts : { 0, 1, 5, 64, MAX_SOUNDFILE_PARTS }) {
+        vector<string> path_name_list = makeParts(parts, 1000);
+        Soundfile* reference = reader.createSoundfile(path_name_list, MAX_CHAN);
+        for (int threads : { 1, 2, 3, 8 }) {
+            ParallelReader<synth_reader> parallel_reader(threads);
+            Soundfile* soundfile = parallel_reader.createSoundfile(path_name_list, MAX_CHAN);
+            string name = to_string(parts) + " parts, " + to_string(threads) + " threads";
+            check(soundfile && sameSoundfile(reference, soundfile, MAX_CHAN), "different soundfile with " + name);
+            const SoundfileLoadStats& stats = parallel_reader.getLoadStats();
+            long frames = 0;
+            for (int part = 0; part < parts; part++) frames += soundfile->fLength[part];
+            check(stats.fParts == parts && stats.fFrames == frames
+                  && stats.fThreads == max<int>(1, min<int>(threads, parts)), "wrong statistics with " + name);
+            delete soundfile;
+        }
+        delete reference;
+    }
+
+    // A part which cannot be read makes the load fail
+    vector<string> path_name_list = makeParts(32, 1000);
+    path_name_list[20] = "2:666";
+    ParallelReader<synth_reader> parallel_reader(4);
+    check(parallel_reader.createSoundfile(path_name_list, MAX_CHAN) == nullptr, "failure not reported");
+}
+
+static void bench(int parts, int length, int latency)
+{
+    vector<string> path_name_list = makeParts(parts, length);
+    for (int threads : { 1, 2, 4, 8, 16 }) {
+        ParallelReader<synth_reader> parallel_reader(threads);
+        parallel_reader.fLatency = latency;
+        Soundfile* soundfile = parallel_reader.createSoundfile(path_name_list, MAX_CHAN);
+        parallel_reader.getLoadStats().print(cout);
+        delete soundfile;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "parallel-reader-test [-bench] [-parts <num>] [-length <frames>] [-latency <ms>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (isopt(argv, "-bench")) {
+        bench(lopt(argv, "-parts", MAX_SOUNDFILE_PARTS), lopt(argv, "-length", 44100), lopt(argv, "-latency", 10));
+    } else {
+        loadTest();
+    }
+
+    cout << "parallel-reader-test : " << failures << " failures" << endl;
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,227 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/MapUI.h"
+#include "faust/gui/APIUI.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+// Checks that MapUI and APIUI find parameters by path, label and index as with the previous map based lookup,
+// or measures the parameters update throughput with '-bench'.
+
+// A DSP with 'groups' groups of 'params' controls, with the same labels in all groups
+class params_dsp : public dsp {
+
+    private:
+
+        int fGroups;
+        int fParams;
+        vector<FAUSTFLOAT> fControls;
+
+    public:
+
+        params_dsp(int groups, int params):fGroups(groups), fParams(params), fControls(groups * params, FAUSTFLOAT(0)) {}
+
+        int getNumInputs() { return 0; }
+        int getNumOutputs() { return 0; }
+        void buildUserInterface(UI* ui_interface)
+        {
+            ui_interface->openVerticalBox("params");
+            for (int group = 0; group < fGroups; group++) {
+                stringstream group_label;
+                group_label << "group " << group;
+                ui_interface->openHorizontalBox(group_label.str().c_str());
+                for (int param = 0; param < fParams; param++) {
+                    stringstream label;
+                    label << "param " << param;
+                    ui_interface->addVerticalSlider(label.str().c_str(), &fControls[group * fParams + param], 0, 0, 1, 0.01);
+                }
+                ui_interface->closeBox();
+            }
+            ui_interface->addButton("gate", &fControls[0]);
+            ui_interface->closeBox();
+        }
+        int getSampleRate() { return 44100; }
+        void init(int sample_rate) {}
+        void instanceInit(int sample_rate) {}
+        void instanceConstants(int sample_rate) {}
+        void instanceResetUserInterface() {}
+        void instanceClear() {}
+        dsp* clone() { return new params_dsp(fGroups, fParams); }
+        void metadata(Meta* m) {}
+        void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) {}
+};
+
+// Keeps the paths and labels maps, as used by MapUI and APIUI to find parameters before
+struct reference_ui : public MapUI {
+
+    std::map<std::string, FAUSTFLOAT*>& getLabelMap() { return fLabelZoneMap; }
+
+    FAUSTFLOAT* findZone(const std::string& path)
+    {
+        if (fPathZoneMap.find(path) != fPathZoneMap.end()) {
+            return fPathZoneMap[path];
+        } else if (fLabelZoneMap.find(path) != fLabelZoneMap.end()) {
+            return fLabelZoneMap[path];
+        } else {
+            return nullptr;
+        }
+    }
+};
+
+static int checkMapUI(dsp* DSP, reference_ui& reference)
+{
+    int failures = 0;
+    MapUI map_ui;
+    DSP->buildUserInterface(&map_ui);
+
+    // Indexes are in path order
+    int index = 0;
+    for (auto& it : reference.getMap()) {
+        if (map_ui.getParamIndex(it.first) != index
+            || map_ui.getParamAddress(index) != it.first
+            || map_ui.getParamZone(index) != it.second) {
+            if (failures++ < 10) cerr << "MapUI : wrong index for " << it.first << endl;
+        }
+        index++;
+    }
+    if (map_ui.getParamsCount() != index || map_ui.getParamZone(index) || map_ui.getParamAddress(index) != "") {
+        cerr << "MapUI : wrong parameters count" << endl;
+        failures++;
+    }
+
+    // Labels (the last parameter with a label wins) and unknown paths
+    for (auto& it : reference.getLabelMap()) {
+        if (map_ui.getParamZone(it.first) != reference.findZone(it.first)) {
+            if (failures++ < 10) cerr << "MapUI : wrong zone for label " << it.first << endl;
+        }
+    }
+    if (map_ui.getParamIndex("/params/unknown") != -1 || map_ui.getParamZone("unknown")) {
+        cerr << "MapUI : unknown path found" << endl;
+        failures++;
+    }
+
+    // Set/get by path and index
+    for (auto& it : reference.getMap()) {
+        map_ui.setParamValue(it.first, FAUSTFLOAT(0.5));
+        int index = map_ui.getParamIndex(it.first);
+        if (*it.second != FAUSTFLOAT(0.5) || map_ui.getParamValue(index) != FAUSTFLOAT(0.5)) {
+            if (failures++ < 10) cerr << "MapUI : set/get error for " << it.first << endl;
+        }
+        map_ui.setParamValue(index, FAUSTFLOAT(0.25));
+        if (map_ui.getParamValue(it.first) != FAUSTFLOAT(0.25)) {
+            if (failures++ < 10) cerr << "MapUI : set/get error for " << it.first << endl;
+        }
+    }
+    return failures;
+}
+
+static int checkAPIUI(dsp* DSP, reference_ui& reference)
+{
+    int failures = 0;
+    APIUI api_ui;
+    DSP->buildUserInterface(&api_ui);
+
+    for (int p = 0; p < api_ui.getParamsCount(); p++) {
+        if (api_ui.getParamIndex(api_ui.getParamAddress(p)) != p) {
+            if (failures++ < 10) cerr << "APIUI : wrong index for " << api_ui.getParamAddress(p) << endl;
+        }
+    }
+    for (auto& it : reference.getLabelMap()) {
+        int index = api_ui.getParamIndex(it.first.c_str());
+        if (index < 0 || api_ui.getParamZone(index) != reference.findZone(it.first)) {
+            if (failures++ < 10) cerr << "APIUI : wrong index for label " << it.first << endl;
+        }
+    }
+    if (api_ui.getParamIndex("/params/unknown") != -1 || api_ui.getParamIndex("") != -1) {
+        cerr << "APIUI : unknown path found" << endl;
+        failures++;
+    }
+    return failures;
+}
+
+template <typename SET>
+static void bench(const string& name, const vector<string>& paths, int count, SET set)
+{
+    auto start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < count; i++) {
+        set(paths[i % paths.size()], FAUSTFLOAT(i));
+    }
+    double duration = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cout << name << " : " << (count / duration) / 1e6 << " Mupdates/sec" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "param-index-test [-bench] [-groups <num>] [-params <num>] [-count <num>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int groups = lopt(argv, "-groups", 10);
+    int params = lopt(argv, "-params", 30);
+    params_dsp DSP(groups, params);
+    reference_ui reference;
+    DSP.buildUserInterface(&reference);
+
+    if (isopt(argv, "-bench")) {
+        int count = lopt(argv, "-count", 10000000);
+        vector<string> paths;
+        for (auto& it : reference.getMap()) paths.push_back(it.first);
+        MapUI map_ui;
+        DSP.buildUserInterface(&map_ui);
+        APIUI api_ui;
+        DSP.buildUserInterface(&api_ui);
+        vector<int> indexes;
+        for (auto& it : paths) indexes.push_back(api_ui.getParamIndex(it.c_str()));
+
+        cout << paths.size() << " parameters" << endl;
+        bench("std::map lookups (previous MapUI)", paths, count,
+              [&](const string& path, FAUSTFLOAT value) { *reference.findZone(path) = value; });
+        std::map<std::string, int> path_map;
+        for (size_t i = 0; i < paths.size(); i++) path_map[paths[i]] = int(i);
+        bench("std::map lookup from const char* (previous APIUI)", paths, count,
+              [&](const string& path, FAUSTFLOAT value) { api_ui.setParamValue(path_map.find(path.c_str())->second, value); });
+        bench("MapUI::setParamValue(path)", paths, count,
+              [&](const string& path, FAUSTFLOAT value) { map_ui.setParamValue(path, value); });
+        bench("APIUI::setParamValue(const char*)", paths, count,
+              [&](const string& path, FAUSTFLOAT value) { api_ui.setParamValue(path.c_str(), value); });
+        int i = 0;
+        bench("APIUI::setParamValue(index)", paths, count,
+              [&](const string& path, FAUSTFLOAT value) { api_ui.setParamValue(indexes[i++ % indexes.size()], value); });
+        return EXIT_SUCCESS;
+    }
+
+    int failures = checkMapUI(&DSP, reference) + checkAPIUI(&DSP, reference);
+    cout << "param index : " << failures << " failures" << endl;
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
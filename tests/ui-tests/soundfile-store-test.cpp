@@ -0,0 +1,271 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <chrono>
+#include <iostream>
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MEMORY_READER
+#include "faust/gui/SoundUI.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+// Checks that soundfiles are shared by SoundUI instances and reloaded from the memory-mapped cache files,
+// or measures the load time with and without cache file with '-bench'.
+
+// A reader which counts decoded files and fills each sample with a value depending on the file, channel and frame
+struct counting_reader : public MemoryReader {
+
+    int fDecoded;
+    int fLength;
+
+    counting_reader(int length = SOUND_LENGTH):fDecoded(0), fLength(length) {}
+
+    void getParamsFile(const std::string& path_name, int& channels, int& length)
+    {
+        channels = SOUND_CHAN;
+        length = fLength;
+    }
+
+    void readFile(Soundfile* soundfile, const std::string& path_name, int part, int& offset, int max_chan)
+    {
+        fDecoded++;
+        soundfile->fLength[part] = fLength;
+        soundfile->fSR[part] = SOUND_SR;
+        soundfile->fOffset[part] = offset;
+        for (int chan = 0; chan < SOUND_CHAN; chan++) {
+            for (int sample = 0; sample < fLength; sample++) {
+                soundfile->fBuffers[chan][offset + sample] = sampleValue(path_name, chan, sample);
+            }
+        }
+        offset += fLength;
+    }
+
+    static FAUSTFLOAT sampleValue(const std::string& path_name, int chan, int sample)
+    {
+        return FAUSTFLOAT(path_name.size() * 1000 + chan * 100 + (sample % 97));
+    }
+
+};
+
+static const char* gURL = "{'a.wav';'bb.wav'}";
+
+static int failures = 0;
+
+static void check(bool res, const string& msg)
+{
+    if (!res) {
+        cerr << "ERROR : " << msg << endl;
+        failures++;
+    }
+}
+
+static Soundfile* addSoundfile(SoundUI* ui, const char* url)
+{
+    Soundfile* soundfile = nullptr;
+    ui->addSoundfile("sound", url, &soundfile);
+    return soundfile;
+}
+
+static bool checkContent(Soundfile* soundfile, int length)
+{
+    const char* parts[] = { "a.wav", "bb.wav" };
+    for (int part = 0; part < 2; part++) {
+        if (soundfile->fLength[part] != length || soundfile->fOffset[part] != part * length || soundfile->fSR[part] != SOUND_SR) return false;
+        for (int chan = 0; chan < MAX_CHAN; chan++) {
+            for (int sample = 0; sample < length; sample++) {
+                if (soundfile->fBuffers[chan][soundfile->fOffset[part] + sample]
+                    != counting_reader::sampleValue(parts[part], chan % SOUND_CHAN, sample)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Positions of some CacheHeader fields in the cache files (see SoundfileStore.h)
+#define OFFSET_POS(part) (24 + 8 * MAX_SOUNDFILE_PARTS + 4 * (part))
+#define DATA_OFFSET_POS (24 + 12 * MAX_SOUNDFILE_PARTS + 4)
+
+// Write 'value' at 'pos' in all cache files of 'dir', keeping their size
+static bool patchCache(const string& dir, size_t pos, int32_t value)
+{
+    bool res = false;
+    DIR* cache_dir = opendir(dir.c_str());
+    if (!cache_dir) return false;
+    struct dirent* entry;
+    while ((entry = readdir(cache_dir))) {
+        string name = entry->d_name;
+        if (name.size() < 6 || name.substr(name.size() - 6) != ".cache") continue;
+        FILE* file = fopen((dir + "/" + name).c_str(), "r+b");
+        if (!file) continue;
+        res = fseek(file, long(pos), SEEK_SET) == 0 && fwrite(&value, sizeof(int32_t), 1, file) == 1;
+        fclose(file);
+    }
+    closedir(cache_dir);
+    return res;
+}
+
+static void sharingTest()
+{
+    counting_reader reader;
+    SoundfileStore& store = SoundfileStore::getStore();
+
+    SoundUI* ui1 = new SoundUI("", 44100, &reader);
+    SoundUI* ui2 = new SoundUI("", 44100, &reader);
+    Soundfile* sf1 = addSoundfile(ui1, gURL);
+    Soundfile* sf2 = addSoundfile(ui2, gURL);
+    check(sf1 && sf1 == sf2, "soundfile not shared");
+    check(reader.fDecoded == 2, "files decoded more than once");
+    check(store.getRefCount(sf1) == 2, "refcount is not 2");
+    check(checkContent(sf1, SOUND_LENGTH), "wrong decoded content");
+
+    // Same resources resampled at another rate are another soundfile
+    SoundUI* ui3 = new SoundUI("", 48000, &reader);
+    Soundfile* sf3 = addSoundfile(ui3, gURL);
+    check(sf3 != sf1, "soundfile shared with another sample rate");
+    delete ui3;
+
+    delete ui1;
+    check(store.getRefCount(sf2) == 1, "refcount is not 1");
+    check(checkContent(sf2, SOUND_LENGTH), "content changed after release");
+    delete ui2;
+    check(store.getRefCount(sf2) == 0, "soundfile not deleted");
+}
+
+static void cacheTest(const string& dir)
+{
+    counting_reader reader;
+    SoundfileStore& store = SoundfileStore::getStore();
+    store.setCacheDirectory(dir);
+
+    // First load decodes and writes the cache file
+    SoundUI* ui1 = new SoundUI("", 44100, &reader);
+    Soundfile* sf1 = addSoundfile(ui1, gURL);
+    check(reader.fDecoded == 2 && !store.isMapped(sf1), "first load not decoded");
+    delete ui1;
+
+    // Next loads map the cache file
+    SoundUI* ui2 = new SoundUI("", 44100, &reader);
+    Soundfile* sf2 = addSoundfile(ui2, gURL);
+    check(reader.fDecoded == 2, "cached files decoded");
+    check(store.isMapped(sf2), "soundfile not mapped");
+    check(sf2->fChannels == SOUND_CHAN, "wrong mapped channels");
+    check(checkContent(sf2, SOUND_LENGTH), "wrong mapped content");
+    delete ui2;
+
+    // Other resources do not use this cache file
+    counting_reader reader2(SOUND_LENGTH / 2);
+    SoundUI* ui3 = new SoundUI("", 44100, &reader2);
+    Soundfile* sf3 = addSoundfile(ui3, "{'c.wav';'dd.wav'}");
+    delete ui3;
+    check(reader2.fDecoded == 2 && sf3, "other resources not decoded");
+
+    // Truncated cache files are ignored and rewritten
+    string cmd = "for f in " + dir + "/*.cache; do truncate -s 4000 $f; done";
+    check(system(cmd.c_str()) == 0, "cannot truncate cache files");
+    SoundUI* ui4 = new SoundUI("", 44100, &reader);
+    Soundfile* sf4 = addSoundfile(ui4, gURL);
+    check(reader.fDecoded == 4 && !store.isMapped(sf4), "truncated cache file used");
+    check(checkContent(sf4, SOUND_LENGTH), "wrong content after truncated cache file");
+    delete ui4;
+
+    SoundUI* ui5 = new SoundUI("", 44100, &reader);
+    Soundfile* sf5 = addSoundfile(ui5, gURL);
+    check(reader.fDecoded == 4 && store.isMapped(sf5), "cache file not rewritten");
+    delete ui5;
+
+    // Cache files with a part outside the samples, or samples overlapping the header, are ignored and rewritten
+    int decoded = reader.fDecoded;
+    size_t header_offsets[] = { OFFSET_POS(1), DATA_OFFSET_POS };
+    int32_t header_values[] = { INT32_MAX, 0 };
+    for (int test = 0; test < 2; test++) {
+        check(patchCache(dir, header_offsets[test], header_values[test]), "cannot patch cache files");
+        SoundUI* ui6 = new SoundUI("", 44100, &reader);
+        Soundfile* sf6 = addSoundfile(ui6, gURL);
+        decoded += 2;
+        check(reader.fDecoded == decoded && !store.isMapped(sf6), "corrupted cache file used");
+        check(checkContent(sf6, SOUND_LENGTH), "wrong content after corrupted cache file");
+        delete ui6;
+    }
+
+    store.setCacheDirectory("");
+}
+
+static void bench(const string& dir, int length, int runs)
+{
+    counting_reader reader(length);
+    SoundfileStore& store = SoundfileStore::getStore();
+    for (int cache = 0; cache < 2; cache++) {
+        store.setCacheDirectory(cache ? dir : "");
+        // Write the cache file
+        if (cache) {
+            SoundUI* ui = new SoundUI("", 44100, &reader);
+            addSoundfile(ui, gURL);
+            delete ui;
+        }
+        double duration = 0;
+        for (int run = 0; run < runs; run++) {
+            auto start = chrono::high_resolution_clock::now();
+            SoundUI* ui = new SoundUI("", 44100, &reader);
+            Soundfile* soundfile = addSoundfile(ui, gURL);
+            duration += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+            check(soundfile != nullptr, "soundfile not loaded");
+            delete ui;
+        }
+        cout << (cache ? "memory-mapped cache : " : "decoding : ") << (duration / runs) * 1e3 << " ms per load" << endl;
+    }
+    store.setCacheDirectory("");
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "soundfile-store-test [-bench] [-length <frames>] [-runs <num>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    char dir[] = "/tmp/faust-soundfile-XXXXXX";
+    if (!mkdtemp(dir)) {
+        cerr << "cannot create temporary directory" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (isopt(argv, "-bench")) {
+        bench(dir, lopt(argv, "-length", 1 << 20), lopt(argv, "-runs", 10));
+    } else {
+        sharingTest();
+        cacheTest(dir);
+    }
+
+    string cmd = string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0) cerr << "cannot remove " << dir << endl;
+
+    cout << "soundfile-store-test : " << failures << " failures" << endl;
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,293 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#define MEMORY_READER
+#include "faust/gui/SoundfileStreamer.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+// Replays read patterns of streamed soundfiles (sequential playback, seek, loop, late I/O thread) against local files,
+// or measures the underruns of the I/O thread with '-bench'.
+
+#define RAW_CHAN 2
+#define RAW_SR 44100
+
+// Local files of raw interleaved FAUSTFLOAT frames
+static FAUSTFLOAT sampleValue(int file, int chan, int frame)
+{
+    return FAUSTFLOAT(file * 100000 + chan * 10000 + (frame % 9973));
+}
+
+static void writeFile(const string& path_name, int file, int length)
+{
+    FILE* file_out = fopen(path_name.c_str(), "wb");
+    vector<FAUSTFLOAT> frames(RAW_CHAN * BUFFER_SIZE);
+    for (int frame = 0; frame < length; frame += BUFFER_SIZE) {
+        int size = min<int>(BUFFER_SIZE, length - frame);
+        for (int i = 0; i < size; i++) {
+            for (int chan = 0; chan < RAW_CHAN; chan++) frames[i * RAW_CHAN + chan] = sampleValue(file, chan, frame + i);
+        }
+        fwrite(frames.data(), sizeof(FAUSTFLOAT) * RAW_CHAN, size, file_out);
+    }
+    fclose(file_out);
+}
+
+struct raw_decoder : public SoundfileDecoder {
+
+    FILE* fFile;
+    vector<FAUSTFLOAT> fFrames;
+
+    raw_decoder(FILE* file, int length):fFile(file), fFrames(RAW_CHAN * BUFFER_SIZE)
+    {
+        fChannels = RAW_CHAN;
+        fLength = length;
+        fSR = RAW_SR;
+    }
+
+    virtual ~raw_decoder() { fclose(fFile); }
+
+    int decode(FAUSTFLOAT** buffers, int frames, int max_chan)
+    {
+        int size = int(fread(fFrames.data(), sizeof(FAUSTFLOAT) * RAW_CHAN, min<int>(frames, BUFFER_SIZE), fFile));
+        for (int i = 0; i < size; i++) {
+            for (int chan = 0; chan < min<int>(max_chan, RAW_CHAN); chan++) buffers[chan][i] = fFrames[i * RAW_CHAN + chan];
+        }
+        return size;
+    }
+
+    bool seek(int frame)
+    {
+        return fseek(fFile, long(frame) * sizeof(FAUSTFLOAT) * RAW_CHAN, SEEK_SET) == 0;
+    }
+
+};
+
+struct raw_reader : public SoundfileReader {
+
+    int fDecoders;
+
+    raw_reader():fDecoders(0) {}
+
+    static int fileLength(const string& path_name)
+    {
+        FILE* file = fopen(path_name.c_str(), "rb");
+        if (!file) return 0;
+        fseek(file, 0, SEEK_END);
+        int length = int(ftell(file) / (sizeof(FAUSTFLOAT) * RAW_CHAN));
+        fclose(file);
+        return length;
+    }
+
+    bool checkFile(const string& path_name) { return access(path_name.c_str(), R_OK) == 0; }
+
+    void getParamsFile(const string& path_name, int& channels, int& length)
+    {
+        channels = RAW_CHAN;
+        length = fileLength(path_name);
+    }
+
+    void readFile(Soundfile* soundfile, const string& path_name, int part, int& offset, int max_chan)
+    {
+        raw_decoder* decoder = static_cast<raw_decoder*>(createDecoder(path_name));
+        soundfile->fLength[part] = decoder->fLength;
+        soundfile->fSR[part] = decoder->fSR;
+        soundfile->fOffset[part] = offset;
+        FAUSTFLOAT* buffers[MAX_CHAN];
+        int frames;
+        do {
+            getBuffersOffset(soundfile, buffers, offset);
+            frames = decoder->decode(buffers, BUFFER_SIZE, max_chan);
+            offset += frames;
+        } while (frames > 0);
+        delete decoder;
+    }
+
+    SoundfileDecoder* createDecoder(const string& path_name)
+    {
+        FILE* file = fopen(path_name.c_str(), "rb");
+        if (!file) return nullptr;
+        fDecoders++;
+        return new raw_decoder(file, fileLength(path_name));
+    }
+
+};
+
+static int failures = 0;
+
+static void check(bool res, const string& msg)
+{
+    if (!res) {
+        if (failures < 10) cerr << "ERROR : " << msg << endl;
+        failures++;
+    }
+}
+
+// Checks the frames read by the DSP
+static bool checkFrames(Soundfile* soundfile, int part, int frame, int frames)
+{
+    for (int i = frame; i < min<int>(frame + frames, soundfile->fLength[part]); i++) {
+        for (int chan = 0; chan < MAX_CHAN; chan++) {
+            if (soundfile->fBuffers[chan][soundfile->fOffset[part] + i] != sampleValue(part, chan % RAW_CHAN, i)) return false;
+        }
+    }
+    return true;
+}
+
+// Plays 'frames' frames of a part by blocks, the prefetch being done between blocks
+static void play(SoundfileStreamer& streamer, StreamingSoundfile* soundfile, int part, int frames, int block)
+{
+    for (int frame = 0; frame < frames; frame += block) {
+        int pos = soundfile->getReadPosition(part);
+        check(checkFrames(soundfile, part, pos, block), "wrong frames at " + to_string(pos));
+        soundfile->advance(part, block);
+        streamer.prefetch();
+    }
+}
+
+static void patternTest(const vector<string>& path_name_list, const vector<int>& lengths)
+{
+    raw_reader reader;
+    const int ahead = 8192;
+    const int behind = 4096;
+    SoundfileStreamer streamer(ahead, behind, 0);
+    StreamingSoundfile* soundfile = streamer.createSoundfile(&reader, path_name_list, MAX_CHAN);
+    check(soundfile != nullptr, "soundfile not created");
+    if (!soundfile) return;
+    check(reader.fDecoders == int(path_name_list.size()), "no decoder per part");
+    check(soundfile->fChannels == RAW_CHAN && soundfile->fLength[1] == lengths[1] && soundfile->fOffset[1] == lengths[0], "wrong layout");
+
+    // The beginning of each part is decoded when created
+    check(soundfile->isDecoded(0, 0, ahead) && soundfile->isDecoded(1, 0, ahead), "beginning not decoded");
+    check(!soundfile->isDecoded(0, 0, ahead + 1), "too much decoded");
+
+    // Sequential playback of the whole part, with a block size which does not divide the length
+    play(streamer, soundfile, 0, lengths[0], 300);
+    check(soundfile->getUnderruns() == 0, "underruns during sequential playback");
+
+    // Frames far enough behind the read position are released
+    check(!soundfile->isDecoded(0, 0, 1), "frames behind not released");
+#ifdef __linux__
+    check(soundfile->fBuffers[0][soundfile->fOffset[0] + 1024] == 0, "memory behind not given back");
+#endif
+
+    // Loop to the beginning, then seek in the middle
+    soundfile->setReadPosition(0, 0);
+    streamer.prefetch();
+    play(streamer, soundfile, 0, 5000, 256);
+    soundfile->setReadPosition(0, lengths[0] / 2 + 17);
+    streamer.prefetch();
+    play(streamer, soundfile, 0, 20000, 128);
+    check(soundfile->getUnderruns() == 0, "underruns after seek");
+
+    // Another part is streamed independently
+    play(streamer, soundfile, 1, 30000, 512);
+    check(soundfile->getUnderruns() == 0, "underruns in part 1");
+
+    // Reading without prefetch (a late I/O thread) gives underruns, then the I/O thread catches up
+    int pos = soundfile->getReadPosition(1);
+    for (int i = 0; i < 20; i++) soundfile->advance(1, 1024);
+    check(soundfile->getUnderruns() > 0, "underruns not counted");
+    int underruns = soundfile->getUnderruns();
+    streamer.prefetch();
+    check(soundfile->isDecoded(1, pos + 20 * 1024, ahead), "I/O thread not caught up");
+    play(streamer, soundfile, 1, 10000, 512);
+    check(soundfile->getUnderruns() == underruns, "underruns after catching up");
+
+    streamer.release(soundfile);
+}
+
+// The I/O thread decodes ahead of an audio thread which plays the parts faster than real time
+static void threadTest(const vector<string>& path_name_list, const vector<int>& lengths, int block, int speed, bool verbose)
+{
+    raw_reader reader;
+    SoundfileStreamer streamer(2 * RAW_SR, RAW_SR / 2, 5);
+    StreamingSoundUI ui(&streamer, "", RAW_SR, &reader);
+    Soundfile* soundfile = nullptr;
+    string url = "{'" + path_name_list[0] + "';'" + path_name_list[1] + "'}";
+    ui.addSoundfile("sound", url.c_str(), &soundfile);
+    check(soundfile && reader.fDecoders == 2, "soundfile not streamed");
+    if (!soundfile) return;
+
+    auto period = chrono::microseconds(int64_t(1e6 * block / RAW_SR / speed));
+    auto next = chrono::steady_clock::now();
+    for (int part = 0; part < 2; part++) {
+        for (int frame = 0; frame < lengths[part]; frame += block) {
+            next += period;
+            this_thread::sleep_until(next);
+            if (static_cast<StreamingSoundfile*>(soundfile)->isDecoded(part, frame, block)) {
+                check(checkFrames(soundfile, part, frame, block), "wrong frames at " + to_string(frame));
+            }
+            ui.advance(part, block);
+        }
+    }
+    if (verbose) {
+        cout << "speed x" << speed << " : " << ui.getUnderruns() << " underruns" << endl;
+    } else {
+        check(ui.getUnderruns() == 0, "underruns with the I/O thread");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "soundfile-streamer-test [-bench] [-length <frames>]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    char dir[] = "/tmp/faust-streamer-XXXXXX";
+    if (!mkdtemp(dir)) {
+        cerr << "cannot create temporary directory" << endl;
+        exit(EXIT_FAILURE);
+    }
+    int length = lopt(argv, "-length", 10 * RAW_SR);
+    vector<int> lengths = { length, length / 2 + 333 };
+    vector<string> path_name_list;
+    for (int part = 0; part < 2; part++) {
+        path_name_list.push_back(string(dir) + "/part" + to_string(part) + ".raw");
+        writeFile(path_name_list[part], part, lengths[part]);
+    }
+
+    if (isopt(argv, "-bench")) {
+        for (int speed : { 10, 50, 200 }) {
+            threadTest(path_name_list, lengths, 256, speed, true);
+        }
+    } else {
+        patternTest(path_name_list, lengths);
+        threadTest(path_name_list, lengths, 256, 4, false);
+    }
+
+    string cmd = string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0) cerr << "cannot remove " << dir << endl;
+
+    cout << "soundfile-streamer-test : " << failures << " failures" << endl;
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -112,11 +112,12 @@ int main(int argc, char* argv[])
     bool is_generic = isopt(argv, "-generic");
     bool is_httpd = isopt(argv, "-httpd");
     bool is_resample = isopt(argv, "-resample");
+    int specialize = lopt(argv, "-specialize", 0);
     
     malloc_memory_manager manager;
     
     if (isopt(argv, "-h") || isopt(argv, "-help") || (!is_llvm && !is_interp)) {
-        cout << "dynamic-jack-gtk [-llvm|interp] [-generic] [-nvoices <num>] [-all] [-midi] [-osc] [-httpd] [-resample] [additional Faust options (-vec -vs 8...)] foo.dsp/foo.fbc/foo.ll/foo.bc/foo.mc" << endl;
+        cout << "dynamic-jack-gtk [-llvm|interp] [-generic] [-nvoices <num>] [-all] [-midi] [-osc] [-httpd] [-resample] [-specialize <ms>] [additional Faust options (-vec -vs 8...)] foo.dsp/foo.fbc/foo.ll/foo.bc/foo.mc" << endl;
         cout << "Use '-llvm' to use LLVM backend\n";
         cout << "Use '-interp' to use Interpreter backend (using either .dsp or .fbc (Faust Byte Code) files\n";
         cout << "Use '-generic' to JIT for a generic CPU (otherwise 'native' mode is used)\n";
@@ -126,6 +127,7 @@ int main(int argc, char* argv[])
         cout << "Use '-osc' to activate OSC control\n";
         cout << "Use '-httpd' to activate HTTP control\n";
         cout << "Use '-resample' to resample soundfiles to the audio driver sample rate\n";
+        cout << "Use '-specialize <ms>' to specialize the Interpreter code on the controls declared with [specialize:1], checked every <ms> milliseconds\n";
         exit(EXIT_FAILURE);
     }
     
@@ -154,7 +156,7 @@ int main(int argc, char* argv[])
             || (string(argv[i]) == "-httpd")
             || (string(argv[i]) == "-resample")) {
             continue;
-        } else if (string(argv[i]) == "-nvoices") {
+        } else if (string(argv[i]) == "-nvoices" || string(argv[i]) == "-specialize") {
             i++;
             continue;
         }
@@ -223,6 +225,10 @@ int main(int argc, char* argv[])
             cout << "Trying to use createInterpreterDSPFactoryFromFile..." << endl;
             factory = readInterpreterDSPFactoryFromBitcodeFile(argv[argc-1], error_msg);
         }
+        
+        if (factory && specialize > 0) {
+            static_cast<interpreter_dsp_factory*>(factory)->setSpecialization(specialize);
+        }
     }
     
     if (!factory) {
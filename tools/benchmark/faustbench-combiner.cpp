@@ -0,0 +1,143 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "faust/dsp/interpreter-dsp.h"
+#include "faust/dsp/dsp-combiner-graph.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+#define BUFFER_SIZE 512
+#define SAMPLE_RATE 44100
+
+/*
+ Build an effect rack with the DSP: 'branches' parallel chains of 'depth' DSPs,
+ fed by a splitter and summed by a merger when the DSP channels allow it.
+ */
+static dsp* createRack(interpreter_dsp_factory* factory, int branches, int depth)
+{
+    string error;
+    dsp* rack = nullptr;
+    for (int branch = 0; branch < branches; branch++) {
+        dsp* chain = factory->createDSPInstance();
+        for (int i = 1; i < depth && chain->getNumInputs() == chain->getNumOutputs(); i++) {
+            chain = createDSPSequencer(chain, factory->createDSPInstance(), error);
+        }
+        rack = (rack) ? createDSPParallelizer(rack, chain, error) : chain;
+    }
+    dsp* front = factory->createDSPInstance();
+    if (front->getNumOutputs() > 0 && rack->getNumInputs() > 0 && rack->getNumInputs() % front->getNumOutputs() == 0) {
+        rack = createDSPSplitter(front, rack, error);
+    } else {
+        delete front;
+    }
+    dsp* back = factory->createDSPInstance();
+    if (back->getNumInputs() > 0 && rack->getNumOutputs() % back->getNumInputs() == 0) {
+        rack = createDSPMerger(rack, back, error);
+    } else {
+        delete back;
+    }
+    return rack;
+}
+
+// Render 'cycles' buffers of noise, keep all output channels, return the duration in sec
+static double render(dsp* DSP, int cycles, vector<FAUSTFLOAT>& res)
+{
+    DSP->init(SAMPLE_RATE);
+
+    vector<vector<FAUSTFLOAT>> inputs(DSP->getNumInputs(), vector<FAUSTFLOAT>(BUFFER_SIZE));
+    vector<vector<FAUSTFLOAT>> outputs(DSP->getNumOutputs(), vector<FAUSTFLOAT>(BUFFER_SIZE));
+    vector<FAUSTFLOAT*> inputs_ptr, outputs_ptr;
+    for (auto& it : inputs) inputs_ptr.push_back(it.data());
+    for (auto& it : outputs) outputs_ptr.push_back(it.data());
+
+    mt19937 gen(1234);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    res.clear();
+    double duration = 0.;
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        for (auto& it : inputs) {
+            for (auto& sample : it) sample = FAUSTFLOAT(dist(gen));
+        }
+        auto start = chrono::high_resolution_clock::now();
+        DSP->compute(BUFFER_SIZE, inputs_ptr.data(), outputs_ptr.data());
+        auto end = chrono::high_resolution_clock::now();
+        duration += chrono::duration<double>(end - start).count();
+        for (auto& it : outputs) res.insert(res.end(), it.begin(), it.end());
+    }
+    return duration;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "faustbench-combiner [-branches <num>] [-depth <num>] [-threads <num>] [-cycles <num>] foo.dsp" << endl;
+        cout << "Compares the serial and graph executor rendering of a rack of combined DSPs" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int branches = lopt(argv, "-branches", 8);
+    int depth = lopt(argv, "-depth", 4);
+    int threads = lopt(argv, "-threads", max<int>(1, int(thread::hardware_concurrency()) - 1));
+    int cycles = lopt(argv, "-cycles", 1000);
+
+    string error_msg;
+    interpreter_dsp_factory* factory = createInterpreterDSPFactoryFromFile(argv[argc-1], 0, nullptr, error_msg);
+    if (!factory) {
+        cerr << error_msg;
+        exit(EXIT_FAILURE);
+    }
+
+    vector<FAUSTFLOAT> serial_res, sequential_res, parallel_res;
+
+    dsp* serial = createRack(factory, branches, depth);
+    double serial_time = render(serial, cycles, serial_res);
+    delete serial;
+
+    dsp_graph_executor* sequential = new dsp_graph_executor(createRack(factory, branches, depth), 0);
+    double sequential_time = render(sequential, cycles, sequential_res);
+    delete sequential;
+
+    dsp_graph_executor* parallel = new dsp_graph_executor(createRack(factory, branches, depth), threads);
+    double parallel_time = render(parallel, cycles, parallel_res);
+    cout << argv[argc-1] << " : " << branches << " branches of " << depth << " DSPs" << endl;
+    cout << "graph : " << parallel->getNumNodes() << " nodes, " << parallel->getNumLevels() << " levels, "
+         << parallel->getNumBuffers() << " buffers" << endl;
+    delete parallel;
+
+    cout << "serial combiners : " << serial_time << " sec" << endl;
+    cout << "graph executor   : " << sequential_time << " sec without worker" << endl;
+    cout << "graph executor   : " << parallel_time << " sec with " << threads << " workers (speedup " << serial_time/parallel_time << ")" << endl;
+    bool same = (serial_res == sequential_res) && (serial_res == parallel_res);
+    cout << "same result as serial combiners : " << (same ? "yes" : "no") << endl;
+
+    deleteInterpreterDSPFactory(factory);
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,125 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2021 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "faust/dsp/interpreter-dsp.h"
+// Voice threads are only compiled on demand
+#define POLY_THREADS
+#include "faust/dsp/poly-dsp.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+#define BUFFER_SIZE 512
+#define SAMPLE_RATE 44100
+
+// Render 'cycles' buffers with all voices playing, keep the first output channel, return the duration in sec
+static double render(mydsp_poly* poly, int nvoices, int cycles, vector<FAUSTFLOAT>& res)
+{
+    poly->init(SAMPLE_RATE);
+
+    vector<vector<FAUSTFLOAT>> inputs(poly->getNumInputs(), vector<FAUSTFLOAT>(BUFFER_SIZE, FAUSTFLOAT(0)));
+    vector<vector<FAUSTFLOAT>> outputs(poly->getNumOutputs(), vector<FAUSTFLOAT>(BUFFER_SIZE));
+    vector<FAUSTFLOAT*> inputs_ptr, outputs_ptr;
+    for (auto& it : inputs) inputs_ptr.push_back(it.data());
+    for (auto& it : outputs) outputs_ptr.push_back(it.data());
+
+    for (int voice = 0; voice < nvoices; voice++) {
+        poly->keyOn(0, 36 + voice, 100);
+    }
+
+    res.clear();
+    auto start = chrono::high_resolution_clock::now();
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        // Release half of the voices halfway, to check the release logic
+        if (cycle == cycles/2) {
+            for (int voice = 0; voice < nvoices; voice += 2) {
+                poly->keyOff(0, 36 + voice, 100);
+            }
+        }
+        poly->compute(BUFFER_SIZE, inputs_ptr.data(), outputs_ptr.data());
+        if (poly->getNumOutputs() > 0) res.insert(res.end(), outputs[0].begin(), outputs[0].end());
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "faustbench-poly [-nvoices <num>] [-threads <num>] [-cycles <num>] foo.dsp" << endl;
+        cout << "Compares the serial and multi-threaded rendering of polyphonic voices" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int nvoices = lopt(argv, "-nvoices", 64);
+    int threads = lopt(argv, "-threads", max<int>(2, thread::hardware_concurrency()));
+    int cycles = lopt(argv, "-cycles", 1000);
+
+    string error_msg;
+    interpreter_dsp_factory* factory = createInterpreterDSPFactoryFromFile(argv[argc-1], 0, nullptr, error_msg);
+    if (!factory) {
+        cerr << error_msg;
+        exit(EXIT_FAILURE);
+    }
+
+    vector<FAUSTFLOAT> serial_res, threaded_res1, threaded_res2;
+
+    mydsp_poly* serial = new mydsp_poly(factory->createDSPInstance(), nvoices, true, true);
+    double serial_time = render(serial, nvoices, cycles, serial_res);
+    delete serial;
+
+    mydsp_poly* threaded = new mydsp_poly(factory->createDSPInstance(), nvoices, true, true);
+    threaded->setVoiceThreads(threads);
+    double threaded_time = render(threaded, nvoices, cycles, threaded_res1);
+    delete threaded;
+
+    // A second threaded rendering has to give the exact same result
+    threaded = new mydsp_poly(factory->createDSPInstance(), nvoices, true, true);
+    threaded->setVoiceThreads(threads);
+    render(threaded, nvoices, cycles, threaded_res2);
+    delete threaded;
+
+    // Serial and threaded voices are summed in a different order
+    double max_diff = 0.;
+    for (size_t i = 0; i < serial_res.size(); i++) {
+        max_diff = max<double>(max_diff, fabs(serial_res[i] - threaded_res1[i]));
+    }
+
+    cout << argv[argc-1] << " : " << nvoices << " voices" << endl;
+    cout << "serial   : " << serial_time << " sec" << endl;
+    cout << "threaded : " << threaded_time << " sec with " << threads << " threads (speedup " << serial_time/threaded_time << ")" << endl;
+    cout << "max difference with serial rendering : " << max_diff << endl;
+    cout << "deterministic threaded rendering : " << ((threaded_res1 == threaded_res2) ? "yes" : "no") << endl;
+
+    deleteInterpreterDSPFactory(factory);
+    return (threaded_res1 == threaded_res2 && max_diff < 1e-3) ? EXIT_SUCCESS : EXIT_FAILURE;
+}